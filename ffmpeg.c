@@ -463,6 +463,38 @@ static int decode_interrupt_cb(void *ctx)
 
 const AVIOInterruptCB int_cb = { decode_interrupt_cb, NULL };
 
+static void dump_filter_stats(void)
+{
+    FILE *f = fopen(filter_stats_filename, "w");
+    int i, nb_dumped = 0;
+
+    if (!f) {
+        av_log(NULL, AV_LOG_ERROR, "Cannot open filter statistics file %s: %s\n",
+               filter_stats_filename, strerror(errno));
+        return;
+    }
+
+    fprintf(f, "[");
+    for (i = 0; i < nb_filtergraphs; i++) {
+        char *dump;
+
+        if (!filtergraphs[i]->graph)
+            continue;
+        dump = avfilter_graph_dump_stats(filtergraphs[i]->graph);
+        if (!dump) {
+            av_log(NULL, AV_LOG_ERROR, "Error dumping filter statistics\n");
+            break;
+        }
+        fprintf(f, "%s\n%s", nb_dumped++ ? "," : "", dump);
+        av_free(dump);
+    }
+    fprintf(f, "]\n");
+
+    if (fclose(f))
+        av_log(NULL, AV_LOG_ERROR, "Error closing filter statistics file %s: %s\n",
+               filter_stats_filename, strerror(errno));
+}
+
 static void ffmpeg_cleanup(int ret)
 {
     int i, j;
@@ -472,6 +504,9 @@ static void ffmpeg_cleanup(int ret)
         av_log(NULL, AV_LOG_INFO, "bench: maxrss=%ikB\n", maxrss);
     }
 
+    if (filter_stats_filename)
+        dump_filter_stats();
+
     for (i = 0; i < nb_filtergraphs; i++) {
         FilterGraph *fg = filtergraphs[i];
         avfilter_graph_free(&fg->graph);
@@ -599,6 +634,7 @@ static void ffmpeg_cleanup(int ret)
                    av_err2str(AVERROR(errno)));
     }
     av_freep(&vstats_filename);
+    av_freep(&filter_stats_filename);
 
     av_freep(&input_streams);
     av_freep(&input_files);
@@ -618,6 +618,7 @@ extern char *videotoolbox_pixfmt;
 
 extern int filter_nbthreads;
 extern int filter_complex_nbthreads;
+extern char *filter_stats_filename;
 extern int vstats_version;
 
 extern const AVIOInterruptCB int_cb;
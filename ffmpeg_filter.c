@@ -1002,6 +1002,7 @@ int configure_filtergraph(FilterGraph *fg)
     cleanup_filtergraph(fg);
     if (!(fg->graph = avfilter_graph_alloc()))
         return AVERROR(ENOMEM);
+    fg->graph->instrument = !!filter_stats_filename;
 
     if (simple) {
         OutputStream *ost = fg->outputs[0]->ost;
@@ -62,6 +62,9 @@
 #include <time.h>
 #include <sys/wait.h>
 #include <signal.h>
+#if HAVE_PTHREADS
+#include <pthread.h>
+#endif
 
 #include "cmdutils.h"
 #include "ffserver_config.h"
@@ -125,6 +128,7 @@ typedef struct {
 /* context associated with one connection */
 typedef struct HTTPContext {
     enum HTTPState state;
+    struct FFServerWorker *worker; /* event loop the connection belongs to */
     int fd; /* socket file descriptor */
     struct sockaddr_in from_addr; /* origin */
     struct pollfd *poll_entry; /* used when polling */
@@ -139,6 +143,7 @@ typedef struct HTTPContext {
     int64_t data_count;
     /* feed input */
     int feed_fd;
+    unsigned feed_closed_seen; /* nb_feed_closed of the feed when it was opened */
     /* input format handling */
     AVFormatContext *fmt_in;
     int64_t start_time;            /* In milliseconds - this wraps fairly often */
@@ -188,16 +193,44 @@ typedef struct HTTPContext {
     uint8_t *packet_buffer, *packet_buffer_ptr, *packet_buffer_end;
 } HTTPContext;
 
-static HTTPContext *first_http_ctx;
+/* event loop handling a share of the connections. Worker 0 runs in the main
+ * thread and is the only one handling RTSP and RTP sessions; HTTP clients
+ * are spread over all workers, each of them accepting on the HTTP socket. */
+typedef struct FFServerWorker {
+    int index;
+    HTTPContext *first_http_ctx;
+    struct pollfd *poll_table;
+    int server_fd, rtsp_server_fd;
+    int wakeup_fds[2]; /* pipe used to interrupt poll() on new feed data */
+    int64_t cur_time;
+#if HAVE_PTHREADS
+    pthread_t thread;
+    /* held while handling events; protects the connection list and the
+     * statistics below from concurrent status page requests */
+    pthread_mutex_t lock;
+#endif
+
+    /* statistics */
+    unsigned int nb_connections;
+    uint64_t nb_accepted;
+    int64_t bytes_sent;
+    int64_t bytes_received;
+    int64_t start_time;            /* In microseconds */
+    int64_t busy_time;             /* time spent handling events, in us */
+} FFServerWorker;
+
+static FFServerWorker *workers;
+static int nb_workers;
 
 static FFServerConfig config = {
     .nb_max_http_connections = 2000,
     .nb_max_connections = 5,
     .max_bandwidth = 1000,
+    .nb_workers = 1,
     .use_defaults = 1,
 };
 
-static void new_connection(int server_fd, int is_rtsp);
+static void new_connection(FFServerWorker *w, int server_fd, int is_rtsp);
 static void close_connection(HTTPContext *c);
 
 /* HTTP handling */
@@ -226,7 +259,8 @@ static int prepare_sdp_description(FFServerStream *stream, uint8_t **pbuffer,
                                    struct in_addr my_ip);
 
 /* RTP handling */
-static HTTPContext *rtp_new_connection(struct sockaddr_in *from_addr,
+static HTTPContext *rtp_new_connection(FFServerWorker *w,
+                                       struct sockaddr_in *from_addr,
                                        FFServerStream *stream,
                                        const char *session_id,
                                        enum RTSPLowerTransport rtp_protocol);
@@ -248,13 +282,45 @@ static unsigned int nb_connections;
 
 static uint64_t current_bandwidth;
 
-/* Making this global saves on passing it around everywhere */
-static int64_t cur_time;
-
 static AVLFG random_state;
 
 static FILE *logfile = NULL;
 
+#if HAVE_PTHREADS
+/* protects the connection count, the bandwidth in use, the random state
+ * and the shared parts of feeds and streams */
+static pthread_mutex_t server_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void lock_server(void)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&server_mutex);
+#endif
+}
+
+static void unlock_server(void)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&server_mutex);
+#endif
+}
+
+static void lock_worker(FFServerWorker *w)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&w->lock);
+#endif
+}
+
+static void unlock_worker(FFServerWorker *w)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&w->lock);
+#endif
+}
+
 static void unlayer_stream(AVStream *st, LayeredAVStream *lst)
 {
     avcodec_free_context(&st->codec);
@@ -400,7 +466,8 @@ static char *ctime1(char *buf2, size_t buf_size)
     return buf2;
 }
 
-static void http_vlog(const char *fmt, va_list vargs)
+/* must be called with log_mutex held */
+static void http_vlog_unlocked(const char *fmt, va_list vargs)
 {
     static int print_prefix = 1;
     char buf[32];
@@ -417,6 +484,17 @@ static void http_vlog(const char *fmt, va_list vargs)
     fflush(logfile);
 }
 
+static void http_vlog(const char *fmt, va_list vargs)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&log_mutex);
+#endif
+    http_vlog_unlocked(fmt, vargs);
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&log_mutex);
+#endif
+}
+
 #ifdef __GNUC__
 __attribute__ ((format (printf, 1, 2)))
 #endif
@@ -428,16 +506,33 @@ static void http_log(const char *fmt, ...)
     va_end(vargs);
 }
 
+#ifdef __GNUC__
+__attribute__ ((format (printf, 1, 2)))
+#endif
+static void http_log_unlocked(const char *fmt, ...)
+{
+    va_list vargs;
+    va_start(vargs, fmt);
+    http_vlog_unlocked(fmt, vargs);
+    va_end(vargs);
+}
+
 static void http_av_log(void *ptr, int level, const char *fmt, va_list vargs)
 {
     static int print_prefix = 1;
     AVClass *avc = ptr ? *(AVClass**)ptr : NULL;
     if (level > av_log_get_level())
         return;
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&log_mutex);
+#endif
     if (print_prefix && avc)
-        http_log("[%s @ %p]", avc->item_name(ptr), ptr);
+        http_log_unlocked("[%s @ %p]", avc->item_name(ptr), ptr);
     print_prefix = strstr(fmt, "\n") != NULL;
-    http_vlog(fmt, vargs);
+    http_vlog_unlocked(fmt, vargs);
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&log_mutex);
+#endif
 }
 
 static void log_connection(HTTPContext *c)
@@ -450,7 +545,8 @@ static void log_connection(HTTPContext *c)
              c->protocol, (c->http_error ? c->http_error : 200), c->data_count);
 }
 
-static void update_datarate(DataRateData *drd, int64_t count)
+static void update_datarate(DataRateData *drd, int64_t count,
+                            int64_t cur_time)
 {
     if (!drd->time1 && !drd->count1) {
         drd->time1 = drd->time2 = cur_time;
@@ -464,7 +560,8 @@ static void update_datarate(DataRateData *drd, int64_t count)
 }
 
 /* In bytes per second */
-static int compute_datarate(DataRateData *drd, int64_t count)
+static int compute_datarate(DataRateData *drd, int64_t count,
+                            int64_t cur_time)
 {
     if (cur_time == drd->time1)
         return 0;
@@ -613,8 +710,10 @@ static void start_multicast(void)
         if (!stream->is_multicast)
             continue;
 
+        lock_server();
         random0 = av_lfg_get(&random_state);
         random1 = av_lfg_get(&random_state);
+        unlock_server();
 
         /* open the RTP connection */
         snprintf(session_id, sizeof(session_id), "%08x%08x", random0, random1);
@@ -629,7 +728,7 @@ static void start_multicast(void)
         dest_addr.sin_addr = stream->multicast_ip;
         dest_addr.sin_port = htons(stream->multicast_port);
 
-        rtp_c = rtp_new_connection(&dest_addr, stream, session_id,
+        rtp_c = rtp_new_connection(&workers[0], &dest_addr, stream, session_id,
                                    RTSP_LOWER_TRANSPORT_UDP_MULTICAST);
         if (!rtp_c)
             continue;
@@ -657,62 +756,73 @@ static void start_multicast(void)
     }
 }
 
-/* main loop of the HTTP server */
-static int http_server(void)
+/* wake up the connections of w waiting for a feed, see wake_up_workers() */
+static void wake_up_feed_waiters(FFServerWorker *w)
 {
-    int server_fd = 0, rtsp_server_fd = 0;
-    int ret, delay;
-    struct pollfd *poll_table, *poll_entry;
-    HTTPContext *c, *c_next;
+    HTTPContext *c;
 
-    poll_table = av_mallocz_array(config.nb_max_http_connections + 2,
-                                  sizeof(*poll_table));
-    if(!poll_table) {
-        http_log("Impossible to allocate a poll table handling %d "
-                 "connections.\n", config.nb_max_http_connections);
-        return -1;
-    }
+    for (c = w->first_http_ctx; c; c = c->next) {
+        int feed_closed;
 
-    if (config.http_addr.sin_port) {
-        server_fd = socket_open_listen(&config.http_addr);
-        if (server_fd < 0)
-            goto quit;
-    }
+        if (c->state != HTTPSTATE_WAIT_FEED)
+            continue;
 
-    if (config.rtsp_addr.sin_port) {
-        rtsp_server_fd = socket_open_listen(&config.rtsp_addr);
-        if (rtsp_server_fd < 0) {
-            closesocket(server_fd);
-            goto quit;
-        }
+        lock_server();
+        feed_closed = c->stream->feed->nb_feed_closed != c->feed_closed_seen;
+        unlock_server();
+        c->state = feed_closed ? HTTPSTATE_SEND_DATA_TRAILER
+                               : HTTPSTATE_SEND_DATA;
     }
+}
 
-    if (!rtsp_server_fd && !server_fd) {
-        http_log("HTTP and RTSP disabled.\n");
-        goto quit;
-    }
+/* tell the other workers that a feed received data or was closed; their
+ * waiting connections cannot be reached directly from this thread */
+static void wake_up_workers(FFServerWorker *self)
+{
+    int i;
 
-    http_log("FFserver started.\n");
+    for (i = 0; i < nb_workers; i++) {
+        ssize_t ret;
 
-    start_children(config.first_feed);
+        if (&workers[i] == self)
+            continue;
+        /* this only fails if the pipe is full, in which case the worker
+         * is already going to wake up */
+        ret = write(workers[i].wakeup_fds[1], "w", 1);
+        (void)ret;
+    }
+}
 
-    start_multicast();
+/* event loop of one worker */
+static int worker_loop(FFServerWorker *w)
+{
+    int ret, delay;
+    struct pollfd *poll_entry, *wakeup_entry;
+    HTTPContext *c, *c_next;
+    int64_t busy_start;
 
     for(;;) {
-        poll_entry = poll_table;
-        if (server_fd) {
-            poll_entry->fd = server_fd;
+        poll_entry = w->poll_table;
+        if (w->server_fd) {
+            poll_entry->fd = w->server_fd;
+            poll_entry->events = POLLIN;
+            poll_entry++;
+        }
+        if (w->rtsp_server_fd) {
+            poll_entry->fd = w->rtsp_server_fd;
             poll_entry->events = POLLIN;
             poll_entry++;
         }
-        if (rtsp_server_fd) {
-            poll_entry->fd = rtsp_server_fd;
+        wakeup_entry = NULL;
+        if (w->wakeup_fds[0] >= 0) {
+            wakeup_entry = poll_entry;
+            poll_entry->fd = w->wakeup_fds[0];
             poll_entry->events = POLLIN;
             poll_entry++;
         }
 
         /* wait for events on each HTTP handle */
-        c = first_http_ctx;
+        c = w->first_http_ctx;
         delay = 1000;
         while (c) {
             int fd;
@@ -764,22 +874,31 @@ static int http_server(void)
         /* wait for an event on one connection. We poll at least every
          * second to handle timeouts */
         do {
-            ret = poll(poll_table, poll_entry - poll_table, delay);
+            ret = poll(w->poll_table, poll_entry - w->poll_table, delay);
             if (ret < 0 && ff_neterrno() != AVERROR(EAGAIN) &&
                 ff_neterrno() != AVERROR(EINTR)) {
                 goto quit;
             }
         } while (ret < 0);
 
-        cur_time = av_gettime() / 1000;
+        lock_worker(w);
+        busy_start = av_gettime_relative();
+        w->cur_time = av_gettime() / 1000;
 
-        if (need_to_start_children) {
+        if (w->index == 0 && need_to_start_children) {
             need_to_start_children = 0;
             start_children(config.first_feed);
         }
 
+        if (wakeup_entry && (wakeup_entry->revents & POLLIN)) {
+            char buf[64];
+            while (read(w->wakeup_fds[0], buf, sizeof(buf)) > 0)
+                ;
+            wake_up_feed_waiters(w);
+        }
+
         /* now handle the events */
-        for(c = first_http_ctx; c; c = c_next) {
+        for(c = w->first_http_ctx; c; c = c_next) {
             c_next = c->next;
             if (handle_connection(c) < 0) {
                 log_connection(c);
@@ -788,22 +907,142 @@ static int http_server(void)
             }
         }
 
-        poll_entry = poll_table;
-        if (server_fd) {
+        poll_entry = w->poll_table;
+        if (w->server_fd) {
             /* new HTTP connection request ? */
             if (poll_entry->revents & POLLIN)
-                new_connection(server_fd, 0);
+                new_connection(w, w->server_fd, 0);
             poll_entry++;
         }
-        if (rtsp_server_fd) {
+        if (w->rtsp_server_fd) {
             /* new RTSP connection request ? */
             if (poll_entry->revents & POLLIN)
-                new_connection(rtsp_server_fd, 1);
+                new_connection(w, w->rtsp_server_fd, 1);
+        }
+
+        w->busy_time += av_gettime_relative() - busy_start;
+        unlock_worker(w);
+    }
+
+quit:
+    return -1;
+}
+
+#if HAVE_PTHREADS
+static void *worker_thread(void *arg)
+{
+    FFServerWorker *w = arg;
+
+    worker_loop(w);
+    http_log("Worker %d stopped, exiting\n", w->index);
+    exit(1);
+    return NULL;
+}
+#endif
+
+static int init_workers(int server_fd, int rtsp_server_fd)
+{
+    int i;
+
+    nb_workers = config.nb_workers;
+#if !HAVE_PTHREADS
+    if (nb_workers > 1) {
+        http_log("Threads are not supported, using a single worker.\n");
+        nb_workers = 1;
+    }
+#endif
+
+    workers = av_mallocz_array(nb_workers, sizeof(*workers));
+    if (!workers)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < nb_workers; i++) {
+        FFServerWorker *w = &workers[i];
+
+        w->index = i;
+        w->server_fd = server_fd;
+        /* RTSP sessions and the RTP connections they create all stay in
+         * the first worker, so that they can refer to each other */
+        w->rtsp_server_fd = i ? 0 : rtsp_server_fd;
+        w->wakeup_fds[0] = w->wakeup_fds[1] = -1;
+        w->start_time = av_gettime_relative();
+
+        w->poll_table = av_mallocz_array(config.nb_max_http_connections + 3,
+                                         sizeof(*w->poll_table));
+        if (!w->poll_table) {
+            http_log("Impossible to allocate a poll table handling %d "
+                     "connections.\n", config.nb_max_http_connections);
+            return AVERROR(ENOMEM);
+        }
+
+#if HAVE_PTHREADS
+        pthread_mutex_init(&w->lock, NULL);
+        if (nb_workers > 1) {
+            if (pipe(w->wakeup_fds) < 0) {
+                int ret = AVERROR(errno);
+                http_log("Could not create pipe: %s\n", strerror(errno));
+                return ret;
+            }
+            fcntl(w->wakeup_fds[0], F_SETFL, O_NONBLOCK);
+            fcntl(w->wakeup_fds[1], F_SETFL, O_NONBLOCK);
+        }
+#endif
+    }
+    return 0;
+}
+
+/* main loop of the HTTP server */
+static int http_server(void)
+{
+    int server_fd = 0, rtsp_server_fd = 0;
+    int i;
+
+    if (config.http_addr.sin_port) {
+        server_fd = socket_open_listen(&config.http_addr);
+        if (server_fd < 0)
+            goto quit;
+    }
+
+    if (config.rtsp_addr.sin_port) {
+        rtsp_server_fd = socket_open_listen(&config.rtsp_addr);
+        if (rtsp_server_fd < 0) {
+            closesocket(server_fd);
+            goto quit;
+        }
+    }
+
+    if (!rtsp_server_fd && !server_fd) {
+        http_log("HTTP and RTSP disabled.\n");
+        goto quit;
+    }
+
+    if (init_workers(server_fd, rtsp_server_fd) < 0)
+        goto quit;
+
+    http_log("FFserver started.\n");
+
+    start_children(config.first_feed);
+
+    start_multicast();
+
+#if HAVE_PTHREADS
+    for (i = 1; i < nb_workers; i++) {
+        int ret = pthread_create(&workers[i].thread, NULL, worker_thread,
+                                 &workers[i]);
+        if (ret) {
+            http_log("Could not start worker %d: %s\n", i, strerror(ret));
+            return -1;
         }
     }
+#endif
+
+    worker_loop(&workers[0]);
 
 quit:
-    av_free(poll_table);
+    if (workers) {
+        for (i = 0; i < nb_workers; i++)
+            av_freep(&workers[i].poll_table);
+    }
     return -1;
 }
 
@@ -814,11 +1053,11 @@ static void start_wait_request(HTTPContext *c, int is_rtsp)
     c->buffer_end = c->buffer + c->buffer_size - 1; /* leave room for '\0' */
 
     c->state = is_rtsp ? RTSPSTATE_WAIT_REQUEST : HTTPSTATE_WAIT_REQUEST;
-    c->timeout = cur_time +
+    c->timeout = c->worker->cur_time +
                  (is_rtsp ? RTSP_REQUEST_TIMEOUT : HTTP_REQUEST_TIMEOUT);
 }
 
-static void http_send_too_busy_reply(int fd)
+static void http_send_too_busy_reply(int fd, unsigned int nb)
 {
     char buffer[400];
     int len = snprintf(buffer, sizeof(buffer),
@@ -832,7 +1071,7 @@ static void http_send_too_busy_reply(int fd)
                        "<p>The number of current connections is %u, and this "
                        "exceeds the limit of %u.</p>\r\n"
                        "</body></html>\r\n",
-                       nb_connections, config.nb_max_connections);
+                       nb, config.nb_max_connections);
     av_assert0(len < sizeof(buffer));
     if (send(fd, buffer, len, 0) < len)
         av_log(NULL, AV_LOG_WARNING,
@@ -840,26 +1079,38 @@ static void http_send_too_busy_reply(int fd)
 }
 
 
-static void new_connection(int server_fd, int is_rtsp)
+static void new_connection(FFServerWorker *w, int server_fd, int is_rtsp)
 {
     struct sockaddr_in from_addr;
     socklen_t len;
     int fd;
+    unsigned int nb;
     HTTPContext *c = NULL;
 
     len = sizeof(from_addr);
     fd = accept(server_fd, (struct sockaddr *)&from_addr,
                 &len);
     if (fd < 0) {
-        http_log("error during accept %s\n", strerror(errno));
+        /* another worker may have been faster */
+        if (ff_neterrno() != AVERROR(EAGAIN))
+            http_log("error during accept %s\n", strerror(errno));
         return;
     }
     if (ff_socket_nonblock(fd, 1) < 0)
         av_log(NULL, AV_LOG_WARNING, "ff_socket_nonblock failed\n");
 
-    if (nb_connections >= config.nb_max_connections) {
-        http_send_too_busy_reply(fd);
-        goto fail;
+    /* reserve our slot right away so that concurrent accepts in other
+     * workers cannot exceed the limit */
+    lock_server();
+    nb = nb_connections;
+    if (nb < config.nb_max_connections)
+        nb_connections++;
+    unlock_server();
+
+    if (nb >= config.nb_max_connections) {
+        http_send_too_busy_reply(fd, nb);
+        closesocket(fd);
+        return;
     }
 
     /* add a new connection */
@@ -867,6 +1118,7 @@ static void new_connection(int server_fd, int is_rtsp)
     if (!c)
         goto fail;
 
+    c->worker = w;
     c->fd = fd;
     c->poll_entry = NULL;
     c->from_addr = from_addr;
@@ -875,9 +1127,10 @@ static void new_connection(int server_fd, int is_rtsp)
     if (!c->buffer)
         goto fail;
 
-    c->next = first_http_ctx;
-    first_http_ctx = c;
-    nb_connections++;
+    c->next = w->first_http_ctx;
+    w->first_http_ctx = c;
+    w->nb_connections++;
+    w->nb_accepted++;
 
     start_wait_request(c, is_rtsp);
 
@@ -888,9 +1141,32 @@ static void new_connection(int server_fd, int is_rtsp)
         av_freep(&c->buffer);
         av_free(c);
     }
+    lock_server();
+    nb_connections--;
+    unlock_server();
     closesocket(fd);
 }
 
+/* release the feed written by c and end the streams reading from it */
+static void close_feed(HTTPContext *c)
+{
+    HTTPContext *c1;
+
+    lock_server();
+    c->stream->feed_opened = 0;
+    c->stream->nb_feed_closed++;
+    unlock_server();
+    close(c->feed_fd);
+    c->feed_fd = -1;
+    /* wake up any waiting connections to stop waiting for feed */
+    for(c1 = c->worker->first_http_ctx; c1; c1 = c1->next) {
+        if (c1->state == HTTPSTATE_WAIT_FEED &&
+            c1->stream->feed == c->stream->feed)
+            c1->state = HTTPSTATE_SEND_DATA_TRAILER;
+    }
+    wake_up_workers(c->worker);
+}
+
 static void close_connection(HTTPContext *c)
 {
     HTTPContext **cp, *c1;
@@ -899,7 +1175,7 @@ static void close_connection(HTTPContext *c)
     AVStream *st;
 
     /* remove connection from list */
-    cp = &first_http_ctx;
+    cp = &c->worker->first_http_ctx;
     while (*cp) {
         c1 = *cp;
         if (c1 == c)
@@ -909,7 +1185,7 @@ static void close_connection(HTTPContext *c)
     }
 
     /* remove references, if any (XXX: do it faster) */
-    for(c1 = first_http_ctx; c1; c1 = c1->next) {
+    for(c1 = c->worker->first_http_ctx; c1; c1 = c1->next) {
         if (c1->rtsp_c == c)
             c1->rtsp_c = NULL;
     }
@@ -960,20 +1236,33 @@ static void close_connection(HTTPContext *c)
         av_freep(&ctx->priv_data);
         }
 
+    /* signal that there is no feed if we are the feeder socket, unless
+     * http_receive_data() already did */
+    if (c->state == HTTPSTATE_RECEIVE_DATA && c->stream && c->feed_fd >= 0)
+        close_feed(c);
+
+    lock_server();
     if (c->stream && !c->post && c->stream->stream_type == STREAM_TYPE_LIVE)
         current_bandwidth -= c->stream->bandwidth;
+    nb_connections--;
+    unlock_server();
 
-    /* signal that there is no feed if we are the feeder socket */
-    if (c->state == HTTPSTATE_RECEIVE_DATA && c->stream) {
-        c->stream->feed_opened = 0;
-        close(c->feed_fd);
-    }
+    c->worker->nb_connections--;
 
     av_freep(&c->pb_buffer);
     av_freep(&c->packet_buffer);
     av_freep(&c->buffer);
     av_free(c);
-    nb_connections--;
+}
+
+static void update_bytes_served(HTTPContext *c, int len)
+{
+    c->worker->bytes_sent += len;
+    if (c->stream) {
+        lock_server();
+        c->stream->bytes_served += len;
+        unlock_server();
+    }
 }
 
 static int handle_connection(HTTPContext *c)
@@ -985,7 +1274,7 @@ static int handle_connection(HTTPContext *c)
     case HTTPSTATE_WAIT_REQUEST:
     case RTSPSTATE_WAIT_REQUEST:
         /* timeout ? */
-        if ((c->timeout - cur_time) < 0)
+        if ((c->timeout - c->worker->cur_time) < 0)
             return -1;
         if (c->poll_entry->revents & (POLLERR | POLLHUP))
             return -1;
@@ -1040,8 +1329,7 @@ static int handle_connection(HTTPContext *c)
             break;
         }
         c->buffer_ptr += len;
-        if (c->stream)
-            c->stream->bytes_served += len;
+        update_bytes_served(c, len);
         c->data_count += len;
         if (c->buffer_ptr >= c->buffer_end) {
             av_freep(&c->pb_buffer);
@@ -1426,6 +1714,29 @@ enum RedirType {
 };
 
 /* parse HTTP request and prepare header */
+/* apply the rates requested by a WMP status report to the connection
+ * of the client it belongs to, which may be served by any worker */
+static void switch_wmp_client(HTTPContext *c, int client_id, char *ratebuf)
+{
+    HTTPContext *wmpc = NULL;
+    int i;
+
+    /* never hold two worker locks at once */
+    unlock_worker(c->worker);
+    for (i = 0; i < nb_workers && !wmpc; i++) {
+        lock_worker(&workers[i]);
+        for (wmpc = workers[i].first_http_ctx; wmpc; wmpc = wmpc->next) {
+            if (wmpc->wmp_client_id == client_id)
+                break;
+        }
+
+        if (wmpc && modify_current_stream(wmpc, ratebuf))
+            wmpc->switch_pending = 1;
+        unlock_worker(&workers[i]);
+    }
+    lock_worker(c->worker);
+}
+
 static int http_parse_request(HTTPContext *c)
 {
     const char *p;
@@ -1439,7 +1750,8 @@ static int http_parse_request(HTTPContext *c)
     char *encoded_msg = NULL;
     const char *mime_type;
     FFServerStream *stream;
-    int i;
+    int i, feed_opened;
+    uint64_t bandwidth;
     char ratebuf[32];
     const char *useragent = 0;
 
@@ -1561,17 +1873,21 @@ static int http_parse_request(HTTPContext *c)
         }
     }
 
+    lock_server();
     if (c->post == 0 && stream->stream_type == STREAM_TYPE_LIVE)
         current_bandwidth += stream->bandwidth;
+    bandwidth   = current_bandwidth;
+    feed_opened = stream->feed_opened;
+    unlock_server();
 
     /* If already streaming this feed, do not let another feeder start */
-    if (stream->feed_opened) {
+    if (feed_opened) {
         snprintf(msg, sizeof(msg), "This feed is already being received.");
         http_log("Feed '%s' already being received\n", stream->feed_filename);
         goto send_error;
     }
 
-    if (c->post == 0 && config.max_bandwidth < current_bandwidth) {
+    if (c->post == 0 && config.max_bandwidth < bandwidth) {
         c->http_error = 503;
         q = c->buffer;
         snprintf(q, c->buffer_size,
@@ -1586,7 +1902,7 @@ static int http_parse_request(HTTPContext *c)
                       "is %"PRIu64"kbit/s, and this exceeds the limit of "
                       "%"PRIu64"kbit/s.</p>\r\n"
                       "</body></html>\r\n",
-                 current_bandwidth, config.max_bandwidth);
+                 bandwidth, config.max_bandwidth);
         q += strlen(q);
         /* prepare output buffer */
         c->buffer_ptr = c->buffer;
@@ -1724,7 +2040,9 @@ static int http_parse_request(HTTPContext *c)
         goto send_error;
     }
 
+    lock_server();
     stream->conns_served++;
+    unlock_server();
 
     /* XXX: add there authenticate and IP match */
 
@@ -1767,18 +2085,8 @@ static int http_parse_request(HTTPContext *c)
             http_log("\nGot request:\n%s\n", c->buffer);
 #endif
 
-            if (client_id && extract_rates(ratebuf, sizeof(ratebuf), c->buffer)) {
-                HTTPContext *wmpc;
-
-                /* Now we have to find the client_id */
-                for (wmpc = first_http_ctx; wmpc; wmpc = wmpc->next) {
-                    if (wmpc->wmp_client_id == client_id)
-                        break;
-                }
-
-                if (wmpc && modify_current_stream(wmpc, ratebuf))
-                    wmpc->switch_pending = 1;
-            }
+            if (client_id && extract_rates(ratebuf, sizeof(ratebuf), c->buffer))
+                switch_wmp_client(c, client_id, ratebuf);
 
             snprintf(msg, sizeof(msg), "POST command not handled");
             c->stream = 0;
@@ -1819,7 +2127,9 @@ static int http_parse_request(HTTPContext *c)
     if (!strcmp(c->stream->fmt->name,"asf_stream")) {
         /* Need to allocate a client id */
 
+        lock_server();
         c->wmp_client_id = av_lfg_get(&random_state);
+        unlock_server();
 
         av_strlcatf(c->buffer, c->buffer_size, "Server: Cougar 4.1.0.3923\r\nCache-Control: no-cache\r\nPragma: client-id=%d\r\nPragma: features=\"broadcast\"\r\n", c->wmp_client_id);
     }
@@ -1957,7 +2267,7 @@ static void compute_status(HTTPContext *c)
     FFServerStream *stream;
     char *p;
     time_t ti;
-    int i, len;
+    int i, n, len;
     AVIOContext *pb;
 
     if (avio_open_dyn_buf(&pb) < 0) {
@@ -2016,11 +2326,13 @@ static void compute_status(HTTPContext *c)
 
         avio_printf(pb, "<tr><td><a href=\"/%s\">%s</a> ",
                     sfilename, stream->filename);
+        lock_server();
         avio_printf(pb, "<td> %d <td> ",
                     stream->conns_served);
         // TODO: Investigate if we can make http bitexact so it always produces the same count of bytes
         if (!config.bitexact)
             fmt_bytecount(pb, stream->bytes_served);
+        unlock_server();
 
         switch(stream->stream_type) {
         case STREAM_TYPE_LIVE: {
@@ -2130,51 +2442,87 @@ static void compute_status(HTTPContext *c)
     /* connection status */
     avio_printf(pb, "<h2>Connection Status</h2>\n");
 
+    lock_server();
     avio_printf(pb, "Number of connections: %d / %d<br>\n",
                 nb_connections, config.nb_max_connections);
 
     avio_printf(pb, "Bandwidth in use: %"PRIu64"k / %"PRIu64"k<br>\n",
                 current_bandwidth, config.max_bandwidth);
+    unlock_server();
 
     avio_printf(pb, "<table>\n");
     avio_printf(pb, "<tr><th>#<th>File<th>IP<th>URL<th>Proto<th>State<th>Target "
                     "bit/s<th>Actual bit/s<th>Bytes transferred\n");
-    c1 = first_http_ctx;
+    /* the connections of a worker may only be looked at with its lock held,
+     * and holding two worker locks at once could deadlock */
+    unlock_worker(c->worker);
     i = 0;
-    while (c1) {
-        int bitrate;
-        int j;
-
-        bitrate = 0;
-        if (c1->stream) {
-            for (j = 0; j < c1->stream->nb_streams; j++) {
-                if (!c1->stream->feed)
-                    bitrate += c1->stream->streams[j]->codecpar->bit_rate;
-                else if (c1->feed_streams[j] >= 0)
-                    bitrate += c1->stream->feed->streams[c1->feed_streams[j]]->codecpar->bit_rate;
+    for (n = 0; n < nb_workers; n++) {
+        lock_worker(&workers[n]);
+        c1 = workers[n].first_http_ctx;
+        while (c1) {
+            int bitrate;
+            int j;
+
+            bitrate = 0;
+            if (c1->stream) {
+                lock_server();
+                for (j = 0; j < c1->stream->nb_streams; j++) {
+                    if (!c1->stream->feed)
+                        bitrate += c1->stream->streams[j]->codecpar->bit_rate;
+                    else if (c1->feed_streams[j] >= 0)
+                        bitrate += c1->stream->feed->streams[c1->feed_streams[j]]->codecpar->bit_rate;
+                }
+                unlock_server();
             }
-        }
 
-        i++;
-        p = inet_ntoa(c1->from_addr.sin_addr);
-        clean_html(c1->clean_url, sizeof(c1->clean_url), c1->url);
-        avio_printf(pb, "<tr><td><b>%d</b><td>%s%s<td>%s<td>%s<td>%s<td>%s"
-                        "<td>",
-                    i, c1->stream ? c1->stream->filename : "",
-                    c1->state == HTTPSTATE_RECEIVE_DATA ? "(input)" : "",
-                    p,
-                    c1->clean_url,
-                    c1->protocol, http_state[c1->state]);
-        fmt_bytecount(pb, bitrate);
-        avio_printf(pb, "<td>");
-        fmt_bytecount(pb, compute_datarate(&c1->datarate, c1->data_count) * 8);
-        avio_printf(pb, "<td>");
-        fmt_bytecount(pb, c1->data_count);
-        avio_printf(pb, "\n");
-        c1 = c1->next;
+            i++;
+            p = inet_ntoa(c1->from_addr.sin_addr);
+            clean_html(c1->clean_url, sizeof(c1->clean_url), c1->url);
+            avio_printf(pb, "<tr><td><b>%d</b><td>%s%s<td>%s<td>%s<td>%s<td>%s"
+                            "<td>",
+                        i, c1->stream ? c1->stream->filename : "",
+                        c1->state == HTTPSTATE_RECEIVE_DATA ? "(input)" : "",
+                        p,
+                        c1->clean_url,
+                        c1->protocol, http_state[c1->state]);
+            fmt_bytecount(pb, bitrate);
+            avio_printf(pb, "<td>");
+            fmt_bytecount(pb, compute_datarate(&c1->datarate, c1->data_count,
+                                               c->worker->cur_time) * 8);
+            avio_printf(pb, "<td>");
+            fmt_bytecount(pb, c1->data_count);
+            avio_printf(pb, "\n");
+            c1 = c1->next;
+        }
+        unlock_worker(&workers[n]);
     }
     avio_printf(pb, "</table>\n");
 
+    if (nb_workers > 1) {
+        avio_printf(pb, "<h2>Workers</h2>\n");
+        avio_printf(pb, "<table>\n");
+        avio_printf(pb, "<tr><th>#<th>Connections<th>Accepted"
+                        "<th>Bytes sent<th>Bytes received<th>Load\n");
+        for (n = 0; n < nb_workers; n++) {
+            FFServerWorker *w = &workers[n];
+            int64_t elapsed;
+
+            lock_worker(w);
+            elapsed = av_gettime_relative() - w->start_time;
+            avio_printf(pb, "<tr><td><b>%d</b><td>%u<td>%"PRIu64"<td>",
+                        w->index, w->nb_connections, w->nb_accepted);
+            fmt_bytecount(pb, w->bytes_sent);
+            avio_printf(pb, "<td>");
+            fmt_bytecount(pb, w->bytes_received);
+            avio_printf(pb, "<td>%d%%\n",
+                        elapsed > 0 ? (int)(w->busy_time * 100 / elapsed) : 0);
+            unlock_worker(w);
+        }
+        avio_printf(pb, "</table>\n");
+    }
+    lock_worker(c->worker);
+
     if (!config.bitexact) {
         /* date */
         ti = time(NULL);
@@ -2193,6 +2541,7 @@ static int open_input_stream(HTTPContext *c, const char *info)
     char buf[128];
     char input_filename[1024];
     AVFormatContext *s = NULL;
+    AVDictionary *in_opts = NULL;
     int buf_size, i, ret;
     int64_t stream_pos;
 
@@ -2228,9 +2577,18 @@ static int open_input_stream(HTTPContext *c, const char *info)
         return AVERROR(EINVAL);
     }
 
-    /* open stream */
-    ret = avformat_open_input(&s, input_filename, c->stream->ifmt,
-                              &c->stream->in_opts);
+    /* open stream; the options are shared by all connections to the stream,
+     * so work on a copy */
+    lock_server();
+    ret = av_dict_copy(&in_opts, c->stream->in_opts, 0);
+    /* the stream ends the next time a feeder disconnects */
+    if (c->stream->feed)
+        c->feed_closed_seen = c->stream->feed->nb_feed_closed;
+    unlock_server();
+    if (ret >= 0)
+        ret = avformat_open_input(&s, input_filename, c->stream->ifmt,
+                                  &in_opts);
+    av_dict_free(&in_opts);
     if (ret < 0) {
         http_log("Could not open input '%s': %s\n",
                  input_filename, av_err2str(ret));
@@ -2268,7 +2626,7 @@ static int open_input_stream(HTTPContext *c, const char *info)
     if (c->fmt_in->iformat->read_seek)
         av_seek_frame(c->fmt_in, -1, stream_pos, 0);
     /* set the start time (needed for maxtime and RTP packet timing) */
-    c->start_time = cur_time;
+    c->start_time = c->worker->cur_time;
     c->first_pts = AV_NOPTS_VALUE;
     return 0;
 }
@@ -2277,7 +2635,7 @@ static int open_input_stream(HTTPContext *c, const char *info)
 static int64_t get_server_clock(HTTPContext *c)
 {
     /* compute current pts value from system time */
-    return (cur_time - c->start_time) * 1000;
+    return (c->worker->cur_time - c->start_time) * 1000;
 }
 
 /* return the estimated time (in us) at which the current packet must be sent */
@@ -2309,11 +2667,16 @@ static int http_prepare_data(HTTPContext *c)
         c->pfmt_ctx = ctx;
         av_dict_copy(&(c->pfmt_ctx->metadata), c->stream->metadata, 0);
 
+        /* the stream parameters are shared with the feed, which may update
+         * them when a new feeder connects */
+        lock_server();
         for(i=0;i<c->stream->nb_streams;i++) {
             LayeredAVStream *src;
             AVStream *st = avformat_new_stream(c->pfmt_ctx, NULL);
-            if (!st)
+            if (!st) {
+                unlock_server();
                 return AVERROR(ENOMEM);
+            }
 
             /* if file or feed, then just take streams from FFServerStream
              * struct */
@@ -2338,6 +2701,7 @@ static int http_prepare_data(HTTPContext *c)
         /* prepare header and save header data in a stream */
         if (avio_open_dyn_buf(&c->pfmt_ctx->pb) < 0) {
             /* XXX: potential leak */
+            unlock_server();
             return -1;
         }
         c->pfmt_ctx->pb->seekable = 0;
@@ -2349,7 +2713,9 @@ static int http_prepare_data(HTTPContext *c)
          */
         c->pfmt_ctx->max_delay = (int)(0.7*AV_TIME_BASE);
 
-        if ((ret = avformat_write_header(c->pfmt_ctx, NULL)) < 0) {
+        ret = avformat_write_header(c->pfmt_ctx, NULL);
+        unlock_server();
+        if (ret < 0) {
             http_log("Error writing output header for stream '%s': %s\n",
                      c->stream->filename, av_err2str(ret));
             return ret;
@@ -2366,13 +2732,16 @@ static int http_prepare_data(HTTPContext *c)
     case HTTPSTATE_SEND_DATA:
         /* find a new packet */
         /* read a packet from the input stream */
-        if (c->stream->feed)
+        if (c->stream->feed) {
+            lock_server();
             ffm_set_write_index(c->fmt_in,
                                 c->stream->feed->feed_write_index,
                                 c->stream->feed->feed_size);
+            unlock_server();
+        }
 
         if (c->stream->max_time &&
-            c->stream->max_time + c->start_time - cur_time < 0)
+            c->stream->max_time + c->start_time - c->worker->cur_time < 0)
             /* We have timed out */
             c->state = HTTPSTATE_SEND_DATA_TRAILER;
         else {
@@ -2382,8 +2751,13 @@ static int http_prepare_data(HTTPContext *c)
             if (ret < 0) {
                 if (c->stream->feed) {
                     /* if coming from feed, it means we reached the end of the
-                     * ffm file, so must wait for more data */
-                    c->state = HTTPSTATE_WAIT_FEED;
+                     * ffm file, so must wait for more data, unless the feeder
+                     * is gone */
+                    lock_server();
+                    ret = c->feed_closed_seen != c->stream->feed->nb_feed_closed;
+                    unlock_server();
+                    c->state = ret ? HTTPSTATE_SEND_DATA_TRAILER
+                                   : HTTPSTATE_WAIT_FEED;
                     return 1; /* state changed */
                 }
                 if (ret == AVERROR(EAGAIN)) {
@@ -2405,7 +2779,7 @@ static int http_prepare_data(HTTPContext *c)
                 /* update first pts if needed */
                 if (c->first_pts == AV_NOPTS_VALUE && pkt.dts != AV_NOPTS_VALUE) {
                     c->first_pts = av_rescale_q(pkt.dts, c->fmt_in->streams[pkt.stream_index]->time_base, AV_TIME_BASE_Q);
-                    c->start_time = cur_time;
+                    c->start_time = c->worker->cur_time;
                 }
                 /* send it to the appropriate stream */
                 if (c->stream->feed) {
@@ -2569,9 +2943,8 @@ static int http_send_data(HTTPContext *c)
                 }
 
                 c->data_count += len;
-                update_datarate(&c->datarate, c->data_count);
-                if (c->stream)
-                    c->stream->bytes_served += len;
+                update_datarate(&c->datarate, c->data_count, c->worker->cur_time);
+                update_bytes_served(c, len);
 
                 if (c->rtp_protocol == RTSP_LOWER_TRANSPORT_TCP) {
                     /* RTP packets are sent inside the RTSP TCP connection */
@@ -2646,9 +3019,8 @@ static int http_send_data(HTTPContext *c)
                 c->buffer_ptr += len;
 
                 c->data_count += len;
-                update_datarate(&c->datarate, c->data_count);
-                if (c->stream)
-                    c->stream->bytes_served += len;
+                update_datarate(&c->datarate, c->data_count, c->worker->cur_time);
+                update_bytes_served(c, len);
                 break;
             }
         }
@@ -2660,17 +3032,22 @@ static int http_start_receive_data(HTTPContext *c)
 {
     int fd;
     int ret;
-    int64_t ret64;
+    int64_t ret64, feed_size;
 
-    if (c->stream->feed_opened) {
-        http_log("Stream feed '%s' was not opened\n",
+    /* Don't permit writing to this one */
+    if (c->stream->readonly) {
+        http_log("Cannot write to read-only file '%s'\n",
                  c->stream->feed_filename);
         return AVERROR(EINVAL);
     }
 
-    /* Don't permit writing to this one */
-    if (c->stream->readonly) {
-        http_log("Cannot write to read-only file '%s'\n",
+    /* claim the feed, another worker may be trying to do the same */
+    lock_server();
+    ret = c->stream->feed_opened;
+    c->stream->feed_opened = 1;
+    unlock_server();
+    if (ret) {
+        http_log("Stream feed '%s' was not opened\n",
                  c->stream->feed_filename);
         return AVERROR(EINVAL);
     }
@@ -2681,7 +3058,7 @@ static int http_start_receive_data(HTTPContext *c)
         ret = AVERROR(errno);
         http_log("Could not open feed file '%s': %s\n",
                  c->stream->feed_filename, strerror(errno));
-        return ret;
+        goto fail;
     }
     c->feed_fd = fd;
 
@@ -2693,29 +3070,40 @@ static int http_start_receive_data(HTTPContext *c)
             ret = AVERROR(errno);
             http_log("Error truncating feed file '%s': %s\n",
                      c->stream->feed_filename, strerror(errno));
-            return ret;
+            goto fail;
         }
     } else {
         ret64 = ffm_read_write_index(fd);
         if (ret64 < 0) {
             http_log("Error reading write index from feed file '%s': %s\n",
                      c->stream->feed_filename, strerror(errno));
-            return ret64;
+            ret = ret64;
+            goto fail;
         }
-        c->stream->feed_write_index = ret64;
     }
 
-    c->stream->feed_write_index = FFMAX(ffm_read_write_index(fd),
-                                        FFM_PACKET_SIZE);
-    c->stream->feed_size = lseek(fd, 0, SEEK_END);
+    ret64     = FFMAX(ffm_read_write_index(fd), FFM_PACKET_SIZE);
+    feed_size = lseek(fd, 0, SEEK_END);
     lseek(fd, 0, SEEK_SET);
 
+    lock_server();
+    c->stream->feed_write_index = ret64;
+    c->stream->feed_size        = feed_size;
+    unlock_server();
+
     /* init buffer input */
     c->buffer_ptr = c->buffer;
     c->buffer_end = c->buffer + FFM_PACKET_SIZE;
-    c->stream->feed_opened = 1;
     c->chunked_encoding = !!av_stristr(c->buffer, "Transfer-Encoding: chunked");
     return 0;
+
+fail:
+    if (fd >= 0)
+        close(fd);
+    lock_server();
+    c->stream->feed_opened = 0;
+    unlock_server();
+    return ret;
 }
 
 static int http_receive_data(HTTPContext *c)
@@ -2769,7 +3157,8 @@ static int http_receive_data(HTTPContext *c)
             c->chunk_size -= len;
             c->buffer_ptr += len;
             c->data_count += len;
-            update_datarate(&c->datarate, c->data_count);
+            c->worker->bytes_received += len;
+            update_datarate(&c->datarate, c->data_count, c->worker->cur_time);
         }
     }
 
@@ -2796,6 +3185,9 @@ static int http_receive_data(HTTPContext *c)
                 goto fail;
             }
 
+            /* only this connection writes to the feed, but readers in
+             * other workers look at the index */
+            lock_server();
             feed->feed_write_index += FFM_PACKET_SIZE;
             /* update file size */
             if (feed->feed_write_index > c->stream->feed_size)
@@ -2805,6 +3197,7 @@ static int http_receive_data(HTTPContext *c)
             if (c->stream->feed_max_size &&
                 feed->feed_write_index >= c->stream->feed_max_size)
                 feed->feed_write_index = FFM_PACKET_SIZE;
+            unlock_server();
 
             /* write index */
             if (ffm_write_write_index(c->feed_fd, feed->feed_write_index) < 0) {
@@ -2814,11 +3207,12 @@ static int http_receive_data(HTTPContext *c)
             }
 
             /* wake up any waiting connections */
-            for(c1 = first_http_ctx; c1; c1 = c1->next) {
+            for(c1 = c->worker->first_http_ctx; c1; c1 = c1->next) {
                 if (c1->state == HTTPSTATE_WAIT_FEED &&
                     c1->stream->feed == c->stream->feed)
                     c1->state = HTTPSTATE_SEND_DATA;
             }
+            wake_up_workers(c->worker);
         } else {
             /* We have a header in our hands that contains useful data */
             AVFormatContext *s = avformat_alloc_context();
@@ -2856,12 +3250,14 @@ static int http_receive_data(HTTPContext *c)
                 goto fail;
             }
 
+            lock_server();
             for (i = 0; i < s->nb_streams; i++) {
                 LayeredAVStream *fst = feed->streams[i];
                 AVStream *st = s->streams[i];
                 avcodec_parameters_to_context(fst->codec, st->codecpar);
                 avcodec_parameters_from_context(fst->codecpar, fst->codec);
             }
+            unlock_server();
 
             avformat_close_input(&s);
             av_freep(&pb);
@@ -2871,14 +3267,7 @@ static int http_receive_data(HTTPContext *c)
 
     return 0;
  fail:
-    c->stream->feed_opened = 0;
-    close(c->feed_fd);
-    /* wake up any waiting connections to stop waiting for feed */
-    for(c1 = first_http_ctx; c1; c1 = c1->next) {
-        if (c1->state == HTTPSTATE_WAIT_FEED &&
-            c1->stream->feed == c->stream->feed)
-            c1->state = HTTPSTATE_SEND_DATA_TRAILER;
-    }
+    close_feed(c);
     return -1;
 }
 
@@ -3111,7 +3500,8 @@ static HTTPContext *find_rtp_session(const char *session_id)
     if (session_id[0] == '\0')
         return NULL;
 
-    for(c = first_http_ctx; c; c = c->next) {
+    /* RTSP and RTP connections are all handled by the first worker */
+    for(c = workers[0].first_http_ctx; c; c = c->next) {
         if (!strcmp(c->session_id, session_id))
             return c;
     }
@@ -3181,8 +3571,11 @@ static void rtsp_cmd_setup(HTTPContext *c, const char *url,
 
     /* generate session id if needed */
     if (h->session_id[0] == '\0') {
-        unsigned random0 = av_lfg_get(&random_state);
-        unsigned random1 = av_lfg_get(&random_state);
+        unsigned random0, random1;
+        lock_server();
+        random0 = av_lfg_get(&random_state);
+        random1 = av_lfg_get(&random_state);
+        unlock_server();
         snprintf(h->session_id, sizeof(h->session_id), "%08x%08x",
                  random0, random1);
     }
@@ -3200,8 +3593,8 @@ static void rtsp_cmd_setup(HTTPContext *c, const char *url,
             }
         }
 
-        rtp_c = rtp_new_connection(&c->from_addr, stream, h->session_id,
-                                   th->lower_transport);
+        rtp_c = rtp_new_connection(c->worker, &c->from_addr, stream,
+                                   h->session_id, th->lower_transport);
         if (!rtp_c) {
             rtsp_reply_error(c, RTSP_STATUS_BANDWIDTH);
             return;
@@ -3374,24 +3767,32 @@ static void rtsp_cmd_interrupt(HTTPContext *c, const char *url,
 /********************************************************************/
 /* RTP handling */
 
-static HTTPContext *rtp_new_connection(struct sockaddr_in *from_addr,
+static HTTPContext *rtp_new_connection(FFServerWorker *w,
+                                       struct sockaddr_in *from_addr,
                                        FFServerStream *stream,
                                        const char *session_id,
                                        enum RTSPLowerTransport rtp_protocol)
 {
     HTTPContext *c = NULL;
     const char *proto_str;
+    int full;
 
     /* XXX: should output a warning page when coming
      * close to the connection limit */
-    if (nb_connections >= config.nb_max_connections)
-        goto fail;
+    lock_server();
+    full = nb_connections >= config.nb_max_connections;
+    if (!full)
+        nb_connections++;
+    unlock_server();
+    if (full)
+        return NULL;
 
     /* add a new connection */
     c = av_mallocz(sizeof(HTTPContext));
     if (!c)
         goto fail;
 
+    c->worker = w;
     c->fd = -1;
     c->poll_entry = NULL;
     c->from_addr = *from_addr;
@@ -3399,7 +3800,6 @@ static HTTPContext *rtp_new_connection(struct sockaddr_in *from_addr,
     c->buffer = av_malloc(c->buffer_size);
     if (!c->buffer)
         goto fail;
-    nb_connections++;
     c->stream = stream;
     av_strlcpy(c->session_id, session_id, sizeof(c->session_id));
     c->state = HTTPSTATE_READY;
@@ -3424,10 +3824,13 @@ static HTTPContext *rtp_new_connection(struct sockaddr_in *from_addr,
     av_strlcpy(c->protocol, "RTP/", sizeof(c->protocol));
     av_strlcat(c->protocol, proto_str, sizeof(c->protocol));
 
+    lock_server();
     current_bandwidth += stream->bandwidth;
+    unlock_server();
 
-    c->next = first_http_ctx;
-    first_http_ctx = c;
+    c->next = w->first_http_ctx;
+    w->first_http_ctx = c;
+    w->nb_connections++;
     return c;
 
  fail:
@@ -3435,6 +3838,9 @@ static HTTPContext *rtp_new_connection(struct sockaddr_in *from_addr,
         av_freep(&c->buffer);
         av_free(c);
     }
+    lock_server();
+    nb_connections--;
+    unlock_server();
     return NULL;
 }
 
@@ -673,6 +673,11 @@ static int ffserver_parse_config_global(FFServerConfig *config, const char *cmd,
             ERROR("Invalid MaxBandwidth: '%s'\n", arg);
         else
             config->max_bandwidth = llval;
+    } else if (!av_strcasecmp(cmd, "Workers")) {
+        ffserver_get_arg(arg, sizeof(arg), p);
+        ffserver_set_int_param(&val, arg, 0, 1, 256, config,
+                "Invalid Workers: '%s'\n", arg);
+        config->nb_workers = val;
     } else if (!av_strcasecmp(cmd, "CustomLog")) {
         if (!config->debug) {
             ffserver_get_arg(config->logfilename, sizeof(config->logfilename),
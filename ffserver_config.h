@@ -111,6 +111,7 @@ typedef struct FFServerStream {
     int64_t feed_max_size;        /* maximum storage size, zero means unlimited */
     int64_t feed_write_index;     /* current write position in feed (it wraps around) */
     int64_t feed_size;            /* current size of feed */
+    unsigned nb_feed_closed;      /* number of times a feeder disconnected */
     struct FFServerStream *next_feed;
 } FFServerStream;
 
@@ -121,6 +122,7 @@ typedef struct FFServerConfig {
     unsigned int nb_max_http_connections;
     unsigned int nb_max_connections;
     uint64_t max_bandwidth;
+    int nb_workers;               /* number of threads handling connections */
     int debug;
     int bitexact;
     char logfilename[1024];
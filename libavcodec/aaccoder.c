@@ -339,7 +339,7 @@ static void search_for_quantizers_anmr(AVCodecContext *avctx, AACEncContext *s,
                     maxscale = av_clip(minscale+1, 1, TRELLIS_STATES);
                     minscale = av_clip(maxscale-1, 0, TRELLIS_STATES - 1);
                 }
-                maxval = find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], s->scoefs+start);
+                maxval = s->find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], s->scoefs+start);
                 for (q = minscale; q < maxscale; q++) {
                     float dist = 0;
                     int cb = find_min_book(maxval, sce->sf_idx[w*16+g]);
@@ -453,7 +453,7 @@ static void search_for_quantizers_fast(AVCodecContext *avctx, AACEncContext *s,
         start = w*128;
         for (g = 0; g < sce->ics.num_swb; g++) {
             const float *scaled = s->scoefs + start;
-            maxvals[w*16+g] = find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], scaled);
+            maxvals[w*16+g] = s->find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], scaled);
             start += sce->ics.swb_sizes[g];
         }
     }
@@ -32,7 +32,6 @@
  * explicitly here to make it possible to provide alternative implementations:
  *  - quantize_band_cost
  *  - abs_pow34_v
- *  - find_max_val
  *  - find_min_book
  *  - find_form_factor
  */
@@ -301,7 +300,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
         for (g = 0;  g < sce->ics.num_swb; g++) {
             const float *scaled = s->scoefs + start;
             int minsfidx;
-            maxvals[w*16+g] = find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], scaled);
+            maxvals[w*16+g] = s->find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], scaled);
             if (maxvals[w*16+g] > 0) {
                 minsfidx = coef2minsf(maxvals[w*16+g]);
                 for (w2 = 0; w2 < sce->ics.group_len[w]; w2++)
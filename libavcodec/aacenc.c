@@ -506,6 +506,104 @@ static void copy_input_samples(AACEncContext *s, const AVFrame *frame)
     }
 }
 
+static void search_element(AVCodecContext *avctx, AACEncContext *s,
+                           ChannelElement *cpe, int tag, int start_ch)
+{
+    SingleChannelElement *sce;
+    int ch, chans = tag == TYPE_CPE ? 2 : 1;
+
+    s->cur_type = tag;
+    for (ch = 0; ch < chans; ch++) {
+        s->cur_channel = start_ch + ch;
+        if (s->options.pns && s->coder->mark_pns)
+            s->coder->mark_pns(s, avctx, &cpe->ch[ch]);
+        s->coder->search_for_quantizers(avctx, s, &cpe->ch[ch], s->lambda);
+    }
+    for (ch = 0; ch < chans; ch++) { /* TNS and PNS */
+        sce = &cpe->ch[ch];
+        s->cur_channel = start_ch + ch;
+        if (s->options.tns && s->coder->search_for_tns)
+            s->coder->search_for_tns(s, sce);
+        if (s->options.tns && s->coder->apply_tns_filt)
+            s->coder->apply_tns_filt(s, sce);
+        if (sce->tns.present)
+            s->tns_mode = 1;
+        if (s->options.pns && s->coder->search_for_pns)
+            s->coder->search_for_pns(s, avctx, sce);
+    }
+    s->cur_channel = start_ch;
+    if (s->options.intensity_stereo) { /* Intensity Stereo */
+        if (s->coder->search_for_is)
+            s->coder->search_for_is(s, avctx, cpe);
+        if (cpe->is_mode) s->is_mode = 1;
+        apply_intensity_stereo(cpe);
+    }
+    if (s->options.pred) { /* Prediction */
+        for (ch = 0; ch < chans; ch++) {
+            sce = &cpe->ch[ch];
+            s->cur_channel = start_ch + ch;
+            if (s->options.pred && s->coder->search_for_pred)
+                s->coder->search_for_pred(s, sce);
+            if (cpe->ch[ch].ics.predictor_present) s->pred_mode = 1;
+        }
+        if (s->coder->adjust_common_pred)
+            s->coder->adjust_common_pred(s, cpe);
+        for (ch = 0; ch < chans; ch++) {
+            sce = &cpe->ch[ch];
+            s->cur_channel = start_ch + ch;
+            if (s->options.pred && s->coder->apply_main_pred)
+                s->coder->apply_main_pred(s, sce);
+        }
+        s->cur_channel = start_ch;
+    }
+    if (s->options.mid_side) { /* Mid/Side stereo */
+        if (s->options.mid_side == -1 && s->coder->search_for_ms)
+            s->coder->search_for_ms(s, cpe);
+        else if (cpe->common_window)
+            memset(cpe->ms_mask, 1, sizeof(cpe->ms_mask));
+        apply_mid_side_stereo(cpe);
+    }
+    adjust_frame_information(cpe, chans);
+    if (s->options.ltp) { /* LTP */
+        for (ch = 0; ch < chans; ch++) {
+            sce = &cpe->ch[ch];
+            s->cur_channel = start_ch + ch;
+            if (s->coder->search_for_ltp)
+                s->coder->search_for_ltp(s, sce, cpe->common_window);
+            if (sce->ics.ltp.present) s->pred_mode = 1;
+        }
+        s->cur_channel = start_ch;
+        if (s->coder->adjust_common_ltp)
+            s->coder->adjust_common_ltp(s, cpe);
+    }
+}
+
+/**
+ * Run the coefficient search for every n-th channel element, where n is the
+ * number of job contexts. Each job only touches its own scratch buffers and
+ * the channel elements assigned to it.
+ */
+static int search_elements(AVCodecContext *avctx, void *arg)
+{
+    AACEncContext *s = *(AACEncContext **)arg;
+    AACEncContext *m = avctx->priv_data;
+    int job = (AACEncContext **)arg - m->jobs;
+    int i, tag, start_ch = 0;
+
+    s->is_mode = s->tns_mode = s->pred_mode = 0;
+    for (i = 0; i < m->chan_map[0]; i++) {
+        tag = m->chan_map[i+1];
+        if (i % m->nb_jobs == job) {
+            s->random_state     = m->el_random_state[i];
+            s->psy.bitres.alloc = m->el_bitres_alloc[i];
+            search_element(avctx, s, &m->cpe[i], tag, start_ch);
+            m->el_random_state[i] = s->random_state;
+        }
+        start_ch += tag == TYPE_CPE ? 2 : 1;
+    }
+    return 0;
+}
+
 static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                             const AVFrame *frame, int *got_packet_ptr)
 {
@@ -641,7 +739,6 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
             put_bitstream_info(s, LIBAVCODEC_IDENT);
         start_ch = 0;
         target_bits = 0;
-        memset(chan_el_counter, 0, sizeof(chan_el_counter));
         for (i = 0; i < s->chan_map[0]; i++) {
             FFPsyWindowInfo* wi = windows + start_ch;
             const float *coeffs[2];
@@ -651,8 +748,6 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
             cpe->common_window = 0;
             memset(cpe->is_mask, 0, sizeof(cpe->is_mask));
             memset(cpe->ms_mask, 0, sizeof(cpe->ms_mask));
-            put_bits(&s->pb, 3, tag);
-            put_bits(&s->pb, 4, chan_el_counter[tag]++);
             for (ch = 0; ch < chans; ch++) {
                 sce = &cpe->ch[ch];
                 coeffs[ch] = sce->coeffs;
@@ -674,13 +769,7 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                     * (s->lambda / (avctx->global_quality ? avctx->global_quality : 120));
                 s->psy.bitres.alloc /= chans;
             }
-            s->cur_type = tag;
-            for (ch = 0; ch < chans; ch++) {
-                s->cur_channel = start_ch + ch;
-                if (s->options.pns && s->coder->mark_pns)
-                    s->coder->mark_pns(s, avctx, &cpe->ch[ch]);
-                s->coder->search_for_quantizers(avctx, s, &cpe->ch[ch], s->lambda);
-            }
+            s->el_bitres_alloc[i] = s->psy.bitres.alloc;
             if (chans > 1
                 && wi[0].window_type[0] == wi[1].window_type[0]
                 && wi[0].window_shape   == wi[1].window_shape) {
@@ -693,63 +782,37 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                     }
                 }
             }
-            for (ch = 0; ch < chans; ch++) { /* TNS and PNS */
-                sce = &cpe->ch[ch];
-                s->cur_channel = start_ch + ch;
-                if (s->options.tns && s->coder->search_for_tns)
-                    s->coder->search_for_tns(s, sce);
-                if (s->options.tns && s->coder->apply_tns_filt)
-                    s->coder->apply_tns_filt(s, sce);
-                if (sce->tns.present)
-                    tns_mode = 1;
-                if (s->options.pns && s->coder->search_for_pns)
-                    s->coder->search_for_pns(s, avctx, sce);
-            }
-            s->cur_channel = start_ch;
-            if (s->options.intensity_stereo) { /* Intensity Stereo */
-                if (s->coder->search_for_is)
-                    s->coder->search_for_is(s, avctx, cpe);
-                if (cpe->is_mode) is_mode = 1;
-                apply_intensity_stereo(cpe);
-            }
-            if (s->options.pred) { /* Prediction */
-                for (ch = 0; ch < chans; ch++) {
-                    sce = &cpe->ch[ch];
-                    s->cur_channel = start_ch + ch;
-                    if (s->options.pred && s->coder->search_for_pred)
-                        s->coder->search_for_pred(s, sce);
-                    if (cpe->ch[ch].ics.predictor_present) pred_mode = 1;
-                }
-                if (s->coder->adjust_common_pred)
-                    s->coder->adjust_common_pred(s, cpe);
-                for (ch = 0; ch < chans; ch++) {
-                    sce = &cpe->ch[ch];
-                    s->cur_channel = start_ch + ch;
-                    if (s->options.pred && s->coder->apply_main_pred)
-                        s->coder->apply_main_pred(s, sce);
-                }
-                s->cur_channel = start_ch;
-            }
-            if (s->options.mid_side) { /* Mid/Side stereo */
-                if (s->options.mid_side == -1 && s->coder->search_for_ms)
-                    s->coder->search_for_ms(s, cpe);
-                else if (cpe->common_window)
-                    memset(cpe->ms_mask, 1, sizeof(cpe->ms_mask));
-                apply_mid_side_stereo(cpe);
-            }
-            adjust_frame_information(cpe, chans);
-            if (s->options.ltp) { /* LTP */
-                for (ch = 0; ch < chans; ch++) {
-                    sce = &cpe->ch[ch];
-                    s->cur_channel = start_ch + ch;
-                    if (s->coder->search_for_ltp)
-                        s->coder->search_for_ltp(s, sce, cpe->common_window);
-                    if (sce->ics.ltp.present) pred_mode = 1;
-                }
-                s->cur_channel = start_ch;
-                if (s->coder->adjust_common_ltp)
-                    s->coder->adjust_common_ltp(s, cpe);
-            }
+            start_ch += chans;
+        }
+
+        /* The psy model carries state from one element to the next, but the
+         * coefficient search of each element only depends on its own channels,
+         * so run it on all elements at once. */
+        for (i = 1; i < s->nb_jobs; i++) {
+            s->jobs[i]->lambda     = s->lambda;
+            s->jobs[i]->psy.cutoff = s->psy.cutoff;
+        }
+        if (s->nb_jobs > 1)
+            avctx->execute(avctx, search_elements, s->jobs, NULL, s->nb_jobs, sizeof(void*));
+        else
+            search_elements(avctx, s->jobs);
+        for (i = 0; i < s->nb_jobs; i++) {
+            AACEncContext *job = s->jobs[i];
+            is_mode   |= job->is_mode;
+            tns_mode  |= job->tns_mode;
+            pred_mode |= job->pred_mode;
+            if (job->psy.cutoff != s->psy.cutoff)
+                s->psy.cutoff = job->psy.cutoff;
+        }
+
+        start_ch = 0;
+        memset(chan_el_counter, 0, sizeof(chan_el_counter));
+        for (i = 0; i < s->chan_map[0]; i++) {
+            tag      = s->chan_map[i+1];
+            chans    = tag == TYPE_CPE ? 2 : 1;
+            cpe      = &s->cpe[i];
+            put_bits(&s->pb, 3, tag);
+            put_bits(&s->pb, 4, chan_el_counter[tag]++);
             if (chans == 2) {
                 put_bits(&s->pb, 1, cpe->common_window);
                 if (cpe->common_window) {
@@ -852,6 +915,7 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
 static av_cold int aac_encode_end(AVCodecContext *avctx)
 {
     AACEncContext *s = avctx->priv_data;
+    int i;
 
     av_log(avctx, AV_LOG_INFO, "Qavg: %.3f\n", s->lambda_sum / s->lambda_count);
 
@@ -859,6 +923,14 @@ static av_cold int aac_encode_end(AVCodecContext *avctx)
     ff_mdct_end(&s->mdct128);
     ff_psy_end(&s->psy);
     ff_lpc_end(&s->lpc);
+    if (s->jobs) {
+        for (i = 1; i < s->nb_jobs; i++) {
+            if (s->jobs[i])
+                ff_lpc_end(&s->jobs[i]->lpc);
+            av_freep(&s->jobs[i]);
+        }
+        av_freep(&s->jobs);
+    }
     if (s->psypp)
         ff_psy_preprocess_end(s->psypp);
     av_freep(&s->buffer.samples);
@@ -910,6 +982,44 @@ static av_cold void aac_encode_init_tables(void)
     ff_aac_tableinit();
 }
 
+av_cold void ff_aac_dsp_init(AACEncContext *s)
+{
+    s->abs_pow34    = abs_pow34_v;
+    s->quant_bands  = quantize_bands;
+    s->find_max_val = find_max_val;
+
+    if (ARCH_X86)
+        ff_aac_dsp_init_x86(s);
+}
+
+static av_cold int alloc_jobs(AVCodecContext *avctx, AACEncContext *s)
+{
+    int i, ret;
+
+    s->nb_jobs = 1;
+    if (avctx->active_thread_type & FF_THREAD_SLICE)
+        s->nb_jobs = av_clip(avctx->thread_count, 1, s->chan_map[0]);
+
+    s->jobs = av_mallocz_array(s->nb_jobs, sizeof(*s->jobs));
+    if (!s->jobs)
+        return AVERROR(ENOMEM);
+    s->jobs[0] = s;
+
+    for (i = 1; i < s->nb_jobs; i++) {
+        AACEncContext *job = av_malloc(sizeof(*job));
+        if (!job)
+            return AVERROR(ENOMEM);
+        memcpy(job, s, sizeof(*job));
+        memset(&job->lpc, 0, sizeof(job->lpc));
+        s->jobs[i] = job;
+        if ((ret = ff_lpc_init(&job->lpc, 2*avctx->frame_size, TNS_MAX_ORDER,
+                               FF_LPC_TYPE_LEVINSON)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 static av_cold int aac_encode_init(AVCodecContext *avctx)
 {
     AACEncContext *s = avctx->priv_data;
@@ -1029,16 +1139,17 @@ static av_cold int aac_encode_init(AVCodecContext *avctx)
     s->psypp = ff_psy_preprocess_init(avctx);
     ff_lpc_init(&s->lpc, 2*avctx->frame_size, TNS_MAX_ORDER, FF_LPC_TYPE_LEVINSON);
     s->random_state = 0x1f2e3d4c;
+    for (i = 0; i < FF_ARRAY_ELEMS(s->el_random_state); i++)
+        s->el_random_state[i] = s->random_state;
 
-    s->abs_pow34   = abs_pow34_v;
-    s->quant_bands = quantize_bands;
-
-    if (ARCH_X86)
-        ff_aac_dsp_init_x86(s);
+    ff_aac_dsp_init(s);
 
     if (HAVE_MIPSDSP)
         ff_aac_coder_init_mips(s);
 
+    if ((ret = alloc_jobs(avctx, s)) < 0)
+        goto fail;
+
     if ((ret = ff_thread_once(&aac_table_init, &aac_encode_init_tables)) != 0)
         return AVERROR_UNKNOWN;
 
@@ -1089,7 +1200,8 @@ AVCodec ff_aac_encoder = {
     .defaults       = aac_encode_defaults,
     .supported_samplerates = mpeg4audio_sample_rates,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
-    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY,
+    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .sample_fmts    = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_FLTP,
                                                      AV_SAMPLE_FMT_NONE },
     .priv_class     = &aacenc_class,
@@ -113,6 +113,9 @@ typedef struct AACEncContext {
     AACCoefficientsEncoder *coder;
     int cur_channel;                             ///< current channel for coder context
     int random_state;
+    int el_random_state[8];                      ///< per-element PNS noise generator state
+    int el_bitres_alloc[8];                      ///< per-element psy bit allocation for the current frame
+    int is_mode, tns_mode, pred_mode;            ///< set by the coefficient search when the tool is in use
     float lambda;
     int last_frame_pb_count;                     ///< number of bits for the previous frame
     float lambda_sum;                            ///< sum(lambda), for Qvg reporting
@@ -120,6 +123,10 @@ typedef struct AACEncContext {
     enum RawDataBlockType cur_type;              ///< channel group type cur_channel belongs to
 
     AudioFrameQueue afq;
+
+    struct AACEncContext **jobs;                 ///< per-thread coder contexts, jobs[0] is this context
+    int nb_jobs;
+
     DECLARE_ALIGNED(16, int,   qcoefs)[96];      ///< quantized coefficients
     DECLARE_ALIGNED(32, float, scoefs)[1024];    ///< scaled coefficients
 
@@ -130,12 +137,14 @@ typedef struct AACEncContext {
     void (*quant_bands)(int *out, const float *in, const float *scaled,
                         int size, int is_signed, int maxval, const float Q34,
                         const float rounding);
+    float (*find_max_val)(int group_len, int swb_size, const float *scaled);
 
     struct {
         float *samples;
     } buffer;
 } AACEncContext;
 
+void ff_aac_dsp_init(AACEncContext *s);
 void ff_aac_dsp_init_x86(AACEncContext *s);
 void ff_aac_coder_init_mips(AACEncContext *c);
 void ff_quantize_band_cost_cache_init(struct AACEncContext *s);
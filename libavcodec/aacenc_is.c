@@ -62,7 +62,7 @@ struct AACISError ff_aac_is_encoding_err(AACEncContext *s, ChannelElement *cpe,
         s->abs_pow34(L34, &L[start+(w+w2)*128], sce0->ics.swb_sizes[g]);
         s->abs_pow34(R34, &R[start+(w+w2)*128], sce0->ics.swb_sizes[g]);
         s->abs_pow34(I34, IS,                   sce0->ics.swb_sizes[g]);
-        maxval = find_max_val(1, sce0->ics.swb_sizes[g], I34);
+        maxval = s->find_max_val(1, sce0->ics.swb_sizes[g], I34);
         is_band_type = find_min_book(maxval, is_sf_idx);
         dist1 += quantize_band_cost(s, &L[start + (w+w2)*128], L34,
                                     sce0->ics.swb_sizes[g],
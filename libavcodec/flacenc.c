@@ -114,7 +114,6 @@ typedef struct FlacEncodeContext {
     uint32_t frame_count;
     uint64_t sample_count;
     uint8_t md5sum[16];
-    FlacFrame frame;
     CompressionOptions options;
     AVCodecContext *avctx;
     LPCContext lpc_ctx;
@@ -126,6 +125,24 @@ typedef struct FlacEncodeContext {
 
     int flushed;
     int64_t next_pts;
+
+    /**
+     * Frames are encoded in batches of nb_jobs frames, in parallel when slice
+     * threading is active. jobs[0] is the main context, the others are copies
+     * of it with their own frame and LPC context.
+     */
+    struct FlacEncodeContext **jobs;
+    int nb_jobs;
+    int nb_queued;          ///< number of frames queued for the next batch
+    int nb_encoded;         ///< number of frames encoded by the last batch
+    int next_output;        ///< index of the next encoded frame to output
+
+    /* per job */
+    uint8_t *frame_buf;     ///< encoded frame, max_framesize bytes
+    int frame_bytes;        ///< size of the encoded frame
+    int64_t frame_pts;
+
+    FlacFrame frame;        ///< must be last, it is not copied to the jobs
 } FlacEncodeContext;
 
 
@@ -236,6 +253,46 @@ static av_cold void dprint_compression_options(FlacEncodeContext *s)
 }
 
 
+static av_cold int init_jobs(FlacEncodeContext *s)
+{
+    AVCodecContext *avctx = s->avctx;
+    int i, ret;
+
+    s->nb_jobs = avctx->active_thread_type & FF_THREAD_SLICE ?
+                 avctx->thread_count : 1;
+    s->jobs = av_mallocz_array(s->nb_jobs, sizeof(*s->jobs));
+    if (!s->jobs)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < s->nb_jobs; i++) {
+        FlacEncodeContext *job = s;
+
+        if (i) {
+            /* the frame is not cleared, init_frame() and the encoding set
+             * all of its fields before they are used */
+            job = av_malloc(sizeof(*job));
+            if (!job)
+                return AVERROR(ENOMEM);
+            memcpy(job, s, offsetof(FlacEncodeContext, frame));
+            memset(&job->lpc_ctx, 0, sizeof(job->lpc_ctx));
+            job->frame_buf = NULL;
+        }
+        s->jobs[i] = job;
+
+        if (i && (ret = ff_lpc_init(&job->lpc_ctx, avctx->frame_size,
+                                    s->options.max_prediction_order,
+                                    FF_LPC_TYPE_LEVINSON)) < 0)
+            return ret;
+
+        job->frame_buf = av_malloc(s->max_framesize);
+        if (!job->frame_buf)
+            return AVERROR(ENOMEM);
+    }
+
+    return 0;
+}
+
+
 static av_cold int flac_encode_init(AVCodecContext *avctx)
 {
     int freq = avctx->sample_rate;
@@ -463,7 +520,9 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
     dprint_compression_options(s);
 
-    return ret;
+    if (ret < 0)
+        return ret;
+    return init_jobs(s);
 }
 
 
@@ -1310,9 +1369,9 @@ static void write_frame_footer(FlacEncodeContext *s)
 }
 
 
-static int write_frame(FlacEncodeContext *s, AVPacket *avpkt)
+static int write_frame(FlacEncodeContext *s, uint8_t *buf, int buf_size)
 {
-    init_put_bits(&s->pb, avpkt->data, avpkt->size);
+    init_put_bits(&s->pb, buf, buf_size);
     write_frame_header(s);
     write_subframes(s);
     write_frame_footer(s);
@@ -1320,10 +1379,10 @@ static int write_frame(FlacEncodeContext *s, AVPacket *avpkt)
 }
 
 
-static int update_md5_sum(FlacEncodeContext *s, const void *samples)
+static int update_md5_sum(FlacEncodeContext *s, int nb_samples, const void *samples)
 {
     const uint8_t *buf;
-    int buf_size = s->frame.blocksize * s->channels *
+    int buf_size = nb_samples * s->channels *
                    ((s->avctx->bits_per_raw_sample + 7) / 8);
 
     if (s->avctx->bits_per_raw_sample > 16 || HAVE_BIGENDIAN) {
@@ -1344,7 +1403,7 @@ static int update_md5_sum(FlacEncodeContext *s, const void *samples)
         const int32_t *samples0 = samples;
         uint8_t *tmp            = s->md5_buffer;
 
-        for (i = 0; i < s->frame.blocksize * s->channels; i++) {
+        for (i = 0; i < nb_samples * s->channels; i++) {
             int32_t v = samples0[i] >> 8;
             AV_WL24(tmp + 3*i, v);
         }
@@ -1356,14 +1415,123 @@ static int update_md5_sum(FlacEncodeContext *s, const void *samples)
 }
 
 
+static int encode_frame_job(AVCodecContext *avctx, void *arg)
+{
+    FlacEncodeContext *s = *(FlacEncodeContext **)arg;
+    int frame_bytes;
+
+    channel_decorrelation(s);
+
+    remove_wasted_bits(s);
+
+    frame_bytes = encode_frame(s);
+
+    /* Fall back on verbatim mode if the compressed frame is larger than it
+       would be if encoded uncompressed. */
+    if (frame_bytes < 0 || frame_bytes > s->max_framesize) {
+        s->frame.verbatim_only = 1;
+        frame_bytes = encode_frame(s);
+        if (frame_bytes < 0) {
+            av_log(avctx, AV_LOG_ERROR, "Bad frame count\n");
+            s->frame_bytes = frame_bytes;
+            return frame_bytes;
+        }
+    }
+
+    s->frame_bytes = write_frame(s, s->frame_buf, frame_bytes);
+
+    return 0;
+}
+
+
+static int encode_queued_frames(FlacEncodeContext *s)
+{
+    AVCodecContext *avctx = s->avctx;
+    int i;
+
+    avctx->execute(avctx, encode_frame_job, s->jobs, NULL, s->nb_queued,
+                   sizeof(*s->jobs));
+
+    s->nb_encoded   = s->nb_queued;
+    s->next_output  = 0;
+    s->nb_queued    = 0;
+    s->frame_count += s->nb_encoded;
+
+    for (i = 0; i < s->nb_encoded; i++)
+        if (s->jobs[i]->frame_bytes < 0)
+            return s->jobs[i]->frame_bytes;
+
+    return 0;
+}
+
+
 static int flac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                              const AVFrame *frame, int *got_packet_ptr)
 {
-    FlacEncodeContext *s;
-    int frame_bytes, out_bytes, ret;
+    FlacEncodeContext *s, *job;
+    int ret;
 
     s = avctx->priv_data;
 
+    if (frame) {
+        job = s->jobs[s->nb_queued];
+
+        /* change max_framesize for small final frame */
+        if (frame->nb_samples < s->max_blocksize) {
+            s->max_framesize = ff_flac_get_max_frame_size(frame->nb_samples,
+                                                          s->channels,
+                                                          avctx->bits_per_raw_sample);
+            job->max_framesize = s->max_framesize;
+        }
+
+        job->frame_count = s->frame_count + s->nb_queued;
+        job->frame_pts   = frame->pts;
+
+        init_frame(job, frame->nb_samples);
+
+        copy_samples(job, frame->data[0]);
+
+        s->sample_count += frame->nb_samples;
+        if ((ret = update_md5_sum(s, job->frame.blocksize, frame->data[0])) < 0) {
+            av_log(avctx, AV_LOG_ERROR, "Error updating MD5 checksum\n");
+            return ret;
+        }
+
+        s->nb_queued++;
+    }
+
+    /* frames are output in order, so the previous batch is output before
+     * a partial batch is encoded when flushing */
+    if (s->next_output == s->nb_encoded &&
+        (s->nb_queued == s->nb_jobs || (!frame && s->nb_queued))) {
+        if ((ret = encode_queued_frames(s)) < 0)
+            return ret;
+    }
+
+    if (s->next_output < s->nb_encoded) {
+        int out_bytes;
+
+        job       = s->jobs[s->next_output++];
+        out_bytes = job->frame_bytes;
+
+        if ((ret = ff_alloc_packet2(avctx, avpkt, out_bytes, out_bytes)) < 0)
+            return ret;
+        memcpy(avpkt->data, job->frame_buf, out_bytes);
+
+        if (out_bytes > s->max_encoded_framesize)
+            s->max_encoded_framesize = out_bytes;
+        if (out_bytes < s->min_framesize)
+            s->min_framesize = out_bytes;
+
+        avpkt->pts      = job->frame_pts;
+        avpkt->duration = ff_samples_to_time_base(avctx, job->frame.blocksize);
+
+        s->next_pts = avpkt->pts + avpkt->duration;
+
+        *got_packet_ptr = 1;
+        return 0;
+    }
+
     /* when the last block is reached, update the header in extradata */
     if (!frame) {
         s->max_framesize = s->max_encoded_framesize;
@@ -1388,61 +1556,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
             *got_packet_ptr = 1;
             s->flushed = 1;
         }
-
-        return 0;
-    }
-
-    /* change max_framesize for small final frame */
-    if (frame->nb_samples < s->frame.blocksize) {
-        s->max_framesize = ff_flac_get_max_frame_size(frame->nb_samples,
-                                                      s->channels,
-                                                      avctx->bits_per_raw_sample);
-    }
-
-    init_frame(s, frame->nb_samples);
-
-    copy_samples(s, frame->data[0]);
-
-    channel_decorrelation(s);
-
-    remove_wasted_bits(s);
-
-    frame_bytes = encode_frame(s);
-
-    /* Fall back on verbatim mode if the compressed frame is larger than it
-       would be if encoded uncompressed. */
-    if (frame_bytes < 0 || frame_bytes > s->max_framesize) {
-        s->frame.verbatim_only = 1;
-        frame_bytes = encode_frame(s);
-        if (frame_bytes < 0) {
-            av_log(avctx, AV_LOG_ERROR, "Bad frame count\n");
-            return frame_bytes;
-        }
     }
 
-    if ((ret = ff_alloc_packet2(avctx, avpkt, frame_bytes, 0)) < 0)
-        return ret;
-
-    out_bytes = write_frame(s, avpkt);
-
-    s->frame_count++;
-    s->sample_count += frame->nb_samples;
-    if ((ret = update_md5_sum(s, frame->data[0])) < 0) {
-        av_log(avctx, AV_LOG_ERROR, "Error updating MD5 checksum\n");
-        return ret;
-    }
-    if (out_bytes > s->max_encoded_framesize)
-        s->max_encoded_framesize = out_bytes;
-    if (out_bytes < s->min_framesize)
-        s->min_framesize = out_bytes;
-
-    avpkt->pts      = frame->pts;
-    avpkt->duration = ff_samples_to_time_base(avctx, frame->nb_samples);
-    avpkt->size     = out_bytes;
-
-    s->next_pts = avpkt->pts + avpkt->duration;
-
-    *got_packet_ptr = 1;
     return 0;
 }
 
@@ -1451,6 +1566,19 @@ static av_cold int flac_encode_close(AVCodecContext *avctx)
 {
     if (avctx->priv_data) {
         FlacEncodeContext *s = avctx->priv_data;
+        int i;
+
+        for (i = 0; s->jobs && i < s->nb_jobs; i++) {
+            FlacEncodeContext *job = s->jobs[i];
+            if (!job)
+                continue;
+            av_freep(&job->frame_buf);
+            if (job != s) {
+                ff_lpc_end(&job->lpc_ctx);
+                av_free(job);
+            }
+        }
+        av_freep(&s->jobs);
         av_freep(&s->md5ctx);
         av_freep(&s->md5_buffer);
         ff_lpc_end(&s->lpc_ctx);
@@ -1508,7 +1636,8 @@ AVCodec ff_flac_encoder = {
     .init           = flac_encode_init,
     .encode2        = flac_encode_frame,
     .close          = flac_encode_close,
-    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY | AV_CODEC_CAP_LOSSLESS,
+    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY | AV_CODEC_CAP_LOSSLESS |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .sample_fmts    = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_S16,
                                                      AV_SAMPLE_FMT_S32,
                                                      AV_SAMPLE_FMT_NONE },
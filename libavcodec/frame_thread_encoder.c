@@ -20,7 +20,8 @@
 
 #include "frame_thread_encoder.h"
 
-#include "libavutil/fifo.h"
+#include <stdatomic.h>
+
 #include "libavutil/avassert.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/opt.h"
@@ -32,63 +33,96 @@
 #define MAX_THREADS 64
 #define BUFFER_SIZE (2*MAX_THREADS)
 
+/**
+ * Upper bound for the input frames and output packets in flight. When the
+ * codec also supports slice threads, frame threads beyond this bound are
+ * replaced by slice threads within each frame thread.
+ */
+#define MAX_INFLIGHT_BYTES (1LL << 30)
+
 typedef struct{
-    void *indata;
-    void *outdata;
+    AVFrame *indata;
+    AVPacket *outdata;
     int64_t return_code;
-    unsigned index;
+    atomic_int finished;
 } Task;
 
 typedef struct{
     AVCodecContext *parent_avctx;
     pthread_mutex_t buffer_mutex;
 
-    AVFifoBuffer *task_fifo;
-    pthread_mutex_t task_fifo_mutex;
-    pthread_cond_t task_fifo_cond;
+    /**
+     * Ring of BUFFER_SIZE tasks. Slots [finished_task_index, task_index) are
+     * in use; the user thread is the only one to fill slots and advance
+     * task_index, workers claim slots by advancing next_task.
+     */
+    Task tasks[BUFFER_SIZE];
+    atomic_uint task_index;
+    atomic_uint next_task;
+    unsigned finished_task_index;
 
-    Task finished_tasks[BUFFER_SIZE];
+    /* Only used to sleep, when there are no tasks or results to take. */
+    pthread_mutex_t task_mutex;
+    pthread_cond_t task_cond;
+    atomic_int idle_workers;
     pthread_mutex_t finished_task_mutex;
     pthread_cond_t finished_task_cond;
-
-    unsigned task_index;
-    unsigned finished_task_index;
+    atomic_int waiting;
 
     pthread_t worker[MAX_THREADS];
-    int exit;
+    int nb_workers;
+    atomic_int exit;
 } ThreadContext;
 
+static Task *get_task(ThreadContext *c)
+{
+    unsigned index = atomic_load_explicit(&c->next_task, memory_order_relaxed);
+
+    while (index != atomic_load_explicit(&c->task_index, memory_order_acquire)) {
+        if (atomic_compare_exchange_weak_explicit(&c->next_task, &index, index + 1,
+                                                  memory_order_acq_rel,
+                                                  memory_order_relaxed))
+            return &c->tasks[index % BUFFER_SIZE];
+    }
+    return NULL;
+}
+
+static Task *wait_task(ThreadContext *c)
+{
+    Task *task = get_task(c);
+
+    if (task)
+        return task;
+
+    pthread_mutex_lock(&c->task_mutex);
+    // announce ourselves before checking again, so the user thread either
+    // sees us idle or we see its task
+    atomic_fetch_add(&c->idle_workers, 1);
+    while (!atomic_load(&c->exit) && !(task = get_task(c)))
+        pthread_cond_wait(&c->task_cond, &c->task_mutex);
+    atomic_fetch_sub(&c->idle_workers, 1);
+    pthread_mutex_unlock(&c->task_mutex);
+
+    return task;
+}
+
 static void * attribute_align_arg worker(void *v){
     AVCodecContext *avctx = v;
     ThreadContext *c = avctx->internal->frame_thread_encoder;
-    AVPacket *pkt = NULL;
+    Task *task;
 
-    while(!c->exit){
+    while ((task = wait_task(c))) {
+        AVPacket *pkt = task->outdata;
         int got_packet, ret;
-        AVFrame *frame;
-        Task task;
 
-        if(!pkt) pkt= av_mallocz(sizeof(*pkt));
-        if(!pkt) continue;
         av_init_packet(pkt);
+        pkt->data = NULL;
+        pkt->size = 0;
 
-        pthread_mutex_lock(&c->task_fifo_mutex);
-        while (av_fifo_size(c->task_fifo) <= 0 || c->exit) {
-            if(c->exit){
-                pthread_mutex_unlock(&c->task_fifo_mutex);
-                goto end;
-            }
-            pthread_cond_wait(&c->task_fifo_cond, &c->task_fifo_mutex);
-        }
-        av_fifo_generic_read(c->task_fifo, &task, sizeof(task), NULL);
-        pthread_mutex_unlock(&c->task_fifo_mutex);
-        frame = task.indata;
-
-        ret = avcodec_encode_video2(avctx, pkt, frame, &got_packet);
+        ret = avcodec_encode_video2(avctx, pkt, task->indata, &got_packet);
         pthread_mutex_lock(&c->buffer_mutex);
-        av_frame_unref(frame);
+        av_frame_unref(task->indata);
         pthread_mutex_unlock(&c->buffer_mutex);
-        av_frame_free(&frame);
         if(got_packet) {
             int ret2 = av_dup_packet(pkt);
             if (ret >= 0 && ret2 < 0)
@@ -97,14 +131,17 @@ static void * attribute_align_arg worker(void *v){
             pkt->data = NULL;
             pkt->size = 0;
         }
-        pthread_mutex_lock(&c->finished_task_mutex);
-        c->finished_tasks[task.index].outdata = pkt; pkt = NULL;
-        c->finished_tasks[task.index].return_code = ret;
-        pthread_cond_signal(&c->finished_task_cond);
-        pthread_mutex_unlock(&c->finished_task_mutex);
+        task->return_code = ret;
+        atomic_store(&task->finished, 1);
+        if (atomic_load(&c->waiting)) {
+            pthread_mutex_lock(&c->finished_task_mutex);
+            pthread_cond_signal(&c->finished_task_cond);
+            pthread_mutex_unlock(&c->finished_task_mutex);
+        }
     }
-end:
-    av_free(pkt);
+
+    // only the parent context owns the workers, also with slice threads
+    avctx->internal->frame_thread_encoder = NULL;
     pthread_mutex_lock(&c->buffer_mutex);
     avcodec_close(avctx);
     pthread_mutex_unlock(&c->buffer_mutex);
@@ -112,13 +149,42 @@ end:
     return NULL;
 }
 
+/**
+ * Return the number of slice threads to use in each frame thread, so that
+ * the memory of the frames in flight stays bounded.
+ */
+static int get_slice_threads(AVCodecContext *avctx)
+{
+    int frame_size, max_tasks;
+
+    if (!(avctx->thread_type & FF_THREAD_SLICE) ||
+        !(avctx->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS))
+        return 1;
+
+    frame_size = av_image_get_buffer_size(avctx->pix_fmt, avctx->width, avctx->height, 1);
+    if (frame_size <= 0)
+        return 1;
+
+    // each task holds an input frame and an output packet of similar size
+    max_tasks = FFMAX(2, MAX_INFLIGHT_BYTES / (2 * (int64_t)frame_size));
+    return (avctx->thread_count + max_tasks - 1) / max_tasks;
+}
+
 int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
     int i=0;
     ThreadContext *c;
+    int slice_threads;
+    char threads[16];
+
 
+    if(!(avctx->thread_type & FF_THREAD_FRAME))
+        return 0;
 
-    if(   !(avctx->thread_type & FF_THREAD_FRAME)
-       || !(avctx->codec->capabilities & AV_CODEC_CAP_INTRA_ONLY))
+    // with a GOP size of 1 all FFV1 frames are independent keyframes, the
+    // first pass statistics are gathered in the encoder context though
+    if(  !(avctx->codec->capabilities & AV_CODEC_CAP_INTRA_ONLY)
+       && !(avctx->codec_id == AV_CODEC_ID_FFV1 && avctx->gop_size == 1 &&
+            !(avctx->flags & AV_CODEC_FLAG_PASS1)))
         return 0;
 
     if(   !avctx->thread_count
@@ -171,6 +237,10 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
     if(avctx->thread_count > MAX_THREADS)
         return AVERROR(EINVAL);
 
+    slice_threads = get_slice_threads(avctx);
+    if(avctx->thread_count / slice_threads <= 1)
+        return 0;
+
     av_assert0(!avctx->internal->frame_thread_encoder);
     c = avctx->internal->frame_thread_encoder = av_mallocz(sizeof(ThreadContext));
     if(!c)
@@ -178,17 +248,30 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
 
     c->parent_avctx = avctx;
 
-    c->task_fifo = av_fifo_alloc_array(BUFFER_SIZE, sizeof(Task));
-    if(!c->task_fifo)
-        goto fail;
-
-    pthread_mutex_init(&c->task_fifo_mutex, NULL);
+    pthread_mutex_init(&c->task_mutex, NULL);
     pthread_mutex_init(&c->finished_task_mutex, NULL);
     pthread_mutex_init(&c->buffer_mutex, NULL);
-    pthread_cond_init(&c->task_fifo_cond, NULL);
+    pthread_cond_init(&c->task_cond, NULL);
     pthread_cond_init(&c->finished_task_cond, NULL);
+    atomic_init(&c->task_index, 0);
+    atomic_init(&c->next_task, 0);
+    atomic_init(&c->idle_workers, 0);
+    atomic_init(&c->waiting, 0);
+    atomic_init(&c->exit, 0);
+
+    for (i = 0; i < BUFFER_SIZE; i++) {
+        c->tasks[i].indata  = av_frame_alloc();
+        c->tasks[i].outdata = av_packet_alloc();
+        if (!c->tasks[i].indata || !c->tasks[i].outdata)
+            goto fail;
+        atomic_init(&c->tasks[i].finished, 0);
+    }
 
-    for(i=0; i<avctx->thread_count ; i++){
+    av_log(avctx, AV_LOG_DEBUG, "Using %d frame threads with %d slice threads each\n",
+           avctx->thread_count / slice_threads, slice_threads);
+    snprintf(threads, sizeof(threads), "%d", slice_threads);
+
+    for(i=0; i<avctx->thread_count / slice_threads; i++){
         AVDictionary *tmp = NULL;
         void *tmpv;
         AVCodecContext *thread_avctx = avcodec_alloc_context3(avctx->codec);
@@ -204,11 +287,12 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
                 goto fail;
         } else
             memcpy(thread_avctx->priv_data, avctx->priv_data, avctx->codec->priv_data_size);
-        thread_avctx->thread_count = 1;
+        thread_avctx->thread_count = slice_threads;
+        thread_avctx->thread_type &= ~FF_THREAD_FRAME;
         thread_avctx->active_thread_type &= ~FF_THREAD_FRAME;
 
         av_dict_copy(&tmp, options, 0);
-        av_dict_set(&tmp, "threads", "1", 0);
+        av_dict_set(&tmp, "threads", threads, 0);
         if(avcodec_open2(thread_avctx, avctx->codec, &tmp) < 0) {
             av_dict_free(&tmp);
             goto fail;
@@ -219,13 +303,13 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
         if(pthread_create(&c->worker[i], NULL, worker, thread_avctx)) {
             goto fail;
         }
+        c->nb_workers++;
     }
 
     avctx->active_thread_type = FF_THREAD_FRAME;
 
     return 0;
 fail:
-    avctx->thread_count = i;
     av_log(avctx, AV_LOG_ERROR, "ff_frame_thread_encoder_init failed\n");
     ff_frame_thread_encoder_free(avctx);
     return -1;
@@ -235,69 +319,71 @@ void ff_frame_thread_encoder_free(AVCodecContext *avctx){
     int i;
     ThreadContext *c= avctx->internal->frame_thread_encoder;
 
-    pthread_mutex_lock(&c->task_fifo_mutex);
-    c->exit = 1;
-    pthread_cond_broadcast(&c->task_fifo_cond);
-    pthread_mutex_unlock(&c->task_fifo_mutex);
+    pthread_mutex_lock(&c->task_mutex);
+    atomic_store(&c->exit, 1);
+    pthread_cond_broadcast(&c->task_cond);
+    pthread_mutex_unlock(&c->task_mutex);
 
-    for (i=0; i<avctx->thread_count; i++) {
+    for (i=0; i<c->nb_workers; i++) {
          pthread_join(c->worker[i], NULL);
     }
 
-    pthread_mutex_destroy(&c->task_fifo_mutex);
+    for (i = 0; i < BUFFER_SIZE; i++) {
+        av_frame_free(&c->tasks[i].indata);
+        av_packet_free(&c->tasks[i].outdata);
+    }
+
+    pthread_mutex_destroy(&c->task_mutex);
     pthread_mutex_destroy(&c->finished_task_mutex);
     pthread_mutex_destroy(&c->buffer_mutex);
-    pthread_cond_destroy(&c->task_fifo_cond);
+    pthread_cond_destroy(&c->task_cond);
     pthread_cond_destroy(&c->finished_task_cond);
-    av_fifo_freep(&c->task_fifo);
     av_freep(&avctx->internal->frame_thread_encoder);
 }
 
 int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVFrame *frame, int *got_packet_ptr){
     ThreadContext *c = avctx->internal->frame_thread_encoder;
-    Task task;
+    unsigned task_index = atomic_load_explicit(&c->task_index, memory_order_relaxed);
+    Task *task;
     int ret;
 
     av_assert1(!*got_packet_ptr);
 
     if(frame){
-        AVFrame *new = av_frame_alloc();
-        if(!new)
-            return AVERROR(ENOMEM);
-        ret = av_frame_ref(new, frame);
-        if(ret < 0) {
-            av_frame_free(&new);
+        // at most nb_workers + 1 tasks are ever in flight, the slot is free
+        task = &c->tasks[task_index % BUFFER_SIZE];
+        ret = av_frame_ref(task->indata, frame);
+        if(ret < 0)
             return ret;
-        }
-
-        task.index = c->task_index;
-        task.indata = (void*)new;
-        pthread_mutex_lock(&c->task_fifo_mutex);
-        av_fifo_generic_write(c->task_fifo, &task, sizeof(task), NULL);
-        pthread_cond_signal(&c->task_fifo_cond);
-        pthread_mutex_unlock(&c->task_fifo_mutex);
+        atomic_store_explicit(&task->finished, 0, memory_order_relaxed);
 
-        c->task_index = (c->task_index+1) % BUFFER_SIZE;
+        atomic_store(&c->task_index, ++task_index);
+        if (atomic_load(&c->idle_workers)) {
+            pthread_mutex_lock(&c->task_mutex);
+            pthread_cond_signal(&c->task_cond);
+            pthread_mutex_unlock(&c->task_mutex);
+        }
     }
 
-    pthread_mutex_lock(&c->finished_task_mutex);
-    if (c->task_index == c->finished_task_index ||
-        (frame && !c->finished_tasks[c->finished_task_index].outdata &&
-         (c->task_index - c->finished_task_index) % BUFFER_SIZE <= avctx->thread_count)) {
-            pthread_mutex_unlock(&c->finished_task_mutex);
-            return 0;
-        }
+    task = &c->tasks[c->finished_task_index % BUFFER_SIZE];
+    if (task_index == c->finished_task_index ||
+        (frame && !atomic_load_explicit(&task->finished, memory_order_acquire) &&
+         task_index - c->finished_task_index <= c->nb_workers))
+        return 0;
 
-    while (!c->finished_tasks[c->finished_task_index].outdata) {
-        pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
+    if (!atomic_load(&task->finished)) {
+        pthread_mutex_lock(&c->finished_task_mutex);
+        atomic_store(&c->waiting, 1);
+        while (!atomic_load(&task->finished))
+            pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
+        atomic_store(&c->waiting, 0);
+        pthread_mutex_unlock(&c->finished_task_mutex);
     }
-    task = c->finished_tasks[c->finished_task_index];
-    *pkt = *(AVPacket*)(task.outdata);
+
+    av_packet_move_ref(pkt, task->outdata);
     if(pkt->data)
         *got_packet_ptr = 1;
-    av_freep(&c->finished_tasks[c->finished_task_index].outdata);
-    c->finished_task_index = (c->finished_task_index+1) % BUFFER_SIZE;
-    pthread_mutex_unlock(&c->finished_task_mutex);
+    c->finished_task_index++;
 
-    return task.return_code;
+    return task->return_code;
 }
@@ -43,6 +43,7 @@
 #include "mjpegdec.h"
 #include "jpeglsdec.h"
 #include "put_bits.h"
+#include "thread.h"
 #include "tiff.h"
 #include "exif.h"
 #include "bytestream.h"
@@ -71,34 +72,63 @@ static int build_vlc(VLC *vlc, const uint8_t *bits_table,
                               huff_code, 2, 2, huff_sym, 2, 2, use_static);
 }
 
-static int build_basic_mjpeg_vlc(MJpegDecodeContext *s)
+/* build the VLC decoders of a huffman table from its raw DHT data */
+static int build_huffman_vlcs(MJpegDecodeContext *s, int class, int index)
 {
-    int ret;
-
-    if ((ret = build_vlc(&s->vlcs[0][0], avpriv_mjpeg_bits_dc_luminance,
-                         avpriv_mjpeg_val_dc, 12, 0, 0)) < 0)
-        return ret;
-
-    if ((ret = build_vlc(&s->vlcs[0][1], avpriv_mjpeg_bits_dc_chrominance,
-                         avpriv_mjpeg_val_dc, 12, 0, 0)) < 0)
-        return ret;
-
-    if ((ret = build_vlc(&s->vlcs[1][0], avpriv_mjpeg_bits_ac_luminance,
-                         avpriv_mjpeg_val_ac_luminance, 251, 0, 1)) < 0)
+    const uint8_t *bits_table = s->raw_huffman_lengths[class][index];
+    const uint8_t *val_table  = s->raw_huffman_values[class][index];
+    int i, n = 0, code_max = 0, ret;
+
+    for (i = 1; i <= 16; i++)
+        n += bits_table[i];
+    for (i = 0; i < n; i++)
+        code_max = FFMAX(code_max, val_table[i]);
+
+    /* build VLC and flush previous vlc if present */
+    ff_free_vlc(&s->vlcs[class][index]);
+    av_log(s->avctx, AV_LOG_DEBUG, "class=%d index=%d nb_codes=%d\n",
+           class, index, code_max + 1);
+    if ((ret = build_vlc(&s->vlcs[class][index], bits_table, val_table,
+                         code_max + 1, 0, class > 0)) < 0)
         return ret;
 
-    if ((ret = build_vlc(&s->vlcs[1][1], avpriv_mjpeg_bits_ac_chrominance,
-                         avpriv_mjpeg_val_ac_chrominance, 251, 0, 1)) < 0)
-        return ret;
-
-    if ((ret = build_vlc(&s->vlcs[2][0], avpriv_mjpeg_bits_ac_luminance,
-                         avpriv_mjpeg_val_ac_luminance, 251, 0, 0)) < 0)
-        return ret;
-
-    if ((ret = build_vlc(&s->vlcs[2][1], avpriv_mjpeg_bits_ac_chrominance,
-                         avpriv_mjpeg_val_ac_chrominance, 251, 0, 0)) < 0)
-        return ret;
+    if (class > 0) {
+        ff_free_vlc(&s->vlcs[2][index]);
+        if ((ret = build_vlc(&s->vlcs[2][index], bits_table, val_table,
+                             code_max + 1, 0, 0)) < 0)
+            return ret;
+    }
+    return 0;
+}
 
+static int build_basic_mjpeg_vlc(MJpegDecodeContext *s)
+{
+    static const struct {
+        int class;
+        int index;
+        const uint8_t *bits;
+        const uint8_t *values;
+        int length;
+    } ht[] = {
+        { 0, 0, avpriv_mjpeg_bits_dc_luminance,
+                avpriv_mjpeg_val_dc,                 12 },
+        { 0, 1, avpriv_mjpeg_bits_dc_chrominance,
+                avpriv_mjpeg_val_dc,                 12 },
+        { 1, 0, avpriv_mjpeg_bits_ac_luminance,
+                avpriv_mjpeg_val_ac_luminance,      162 },
+        { 1, 1, avpriv_mjpeg_bits_ac_chrominance,
+                avpriv_mjpeg_val_ac_chrominance,    162 },
+    };
+    int i, ret;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(ht); i++) {
+        memcpy(s->raw_huffman_lengths[ht[i].class][ht[i].index],
+               ht[i].bits, 17);
+        memcpy(s->raw_huffman_values[ht[i].class][ht[i].index],
+               ht[i].values, ht[i].length);
+        if ((ret = build_huffman_vlcs(s, ht[i].class, ht[i].index)) < 0)
+            return ret;
+    }
 
     return 0;
 }
@@ -226,7 +256,7 @@ int ff_mjpeg_decode_dqt(MJpegDecodeContext *s)
 /* decode huffman tables and build VLC decoders */
 int ff_mjpeg_decode_dht(MJpegDecodeContext *s)
 {
-    int len, index, i, class, n, v, code_max;
+    int len, index, i, class, n;
     uint8_t bits_table[17];
     uint8_t val_table[256];
     int ret = 0;
@@ -256,29 +286,15 @@ int ff_mjpeg_decode_dht(MJpegDecodeContext *s)
         if (len < n || n > 256)
             return AVERROR_INVALIDDATA;
 
-        code_max = 0;
-        for (i = 0; i < n; i++) {
-            v = get_bits(&s->gb, 8);
-            if (v > code_max)
-                code_max = v;
-            val_table[i] = v;
-        }
+        for (i = 0; i < n; i++)
+            val_table[i] = get_bits(&s->gb, 8);
         len -= n;
 
-        /* build VLC and flush previous vlc if present */
-        ff_free_vlc(&s->vlcs[class][index]);
-        av_log(s->avctx, AV_LOG_DEBUG, "class=%d index=%d nb_codes=%d\n",
-               class, index, code_max + 1);
-        if ((ret = build_vlc(&s->vlcs[class][index], bits_table, val_table,
-                             code_max + 1, 0, class > 0)) < 0)
+        memcpy(s->raw_huffman_lengths[class][index], bits_table, 17);
+        memcpy(s->raw_huffman_values[class][index], val_table, n);
+        memset(s->raw_huffman_values[class][index] + n, 0, 256 - n);
+        if ((ret = build_huffman_vlcs(s, class, index)) < 0)
             return ret;
-
-        if (class > 0) {
-            ff_free_vlc(&s->vlcs[2][index]);
-            if ((ret = build_vlc(&s->vlcs[2][index], bits_table, val_table,
-                                 code_max + 1, 0, 0)) < 0)
-                return ret;
-        }
     }
     return 0;
 }
@@ -289,6 +305,7 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
     unsigned pix_fmt_id;
     int h_count[MAX_COMPONENTS] = { 0 };
     int v_count[MAX_COMPONENTS] = { 0 };
+    ThreadFrame tframe = { .f = s->picture_ptr };
 
     s->cur_scan = 0;
     memset(s->upscale_h, 0, sizeof(s->upscale_h));
@@ -643,8 +660,8 @@ unk_pixfmt:
         return 0;
     }
 
-    av_frame_unref(s->picture_ptr);
-    if (ff_get_buffer(s->avctx, s->picture_ptr, AV_GET_BUFFER_FLAG_REF) < 0)
+    ff_thread_release_buffer(s->avctx, &tframe);
+    if (ff_thread_get_buffer(s->avctx, &tframe, AV_GET_BUFFER_FLAG_REF) < 0)
         return -1;
     s->picture_ptr->pict_type = AV_PICTURE_TYPE_I;
     s->picture_ptr->key_frame = 1;
@@ -686,10 +703,11 @@ unk_pixfmt:
     return 0;
 }
 
-static inline int mjpeg_decode_dc(MJpegDecodeContext *s, int dc_index)
+static inline int mjpeg_decode_dc(MJpegDecodeContext *s, GetBitContext *gb,
+                                  int dc_index)
 {
     int code;
-    code = get_vlc2(&s->gb, s->vlcs[0][dc_index].table, 9, 2);
+    code = get_vlc2(gb, s->vlcs[0][dc_index].table, 9, 2);
     if (code < 0 || code > 16) {
         av_log(s->avctx, AV_LOG_WARNING,
                "mjpeg_decode_dc: bad vlc: %d:%d (%p)\n",
@@ -698,47 +716,48 @@ static inline int mjpeg_decode_dc(MJpegDecodeContext *s, int dc_index)
     }
 
     if (code)
-        return get_xbits(&s->gb, code);
+        return get_xbits(gb, code);
     else
         return 0;
 }
 
 /* decode block and dequantize */
-static int decode_block(MJpegDecodeContext *s, int16_t *block, int component,
+static int decode_block(MJpegDecodeContext *s, GetBitContext *gb, int *last_dc,
+                        int16_t *block, int component,
                         int dc_index, int ac_index, uint16_t *quant_matrix)
 {
     int code, i, j, level, val;
 
     /* DC coef */
-    val = mjpeg_decode_dc(s, dc_index);
+    val = mjpeg_decode_dc(s, gb, dc_index);
     if (val == 0xfffff) {
         av_log(s->avctx, AV_LOG_ERROR, "error dc\n");
         return AVERROR_INVALIDDATA;
     }
-    val = val * quant_matrix[0] + s->last_dc[component];
+    val = val * quant_matrix[0] + last_dc[component];
     val = av_clip_int16(val);
-    s->last_dc[component] = val;
+    last_dc[component] = val;
     block[0] = val;
     /* AC coefs */
     i = 0;
-    {OPEN_READER(re, &s->gb);
+    {OPEN_READER(re, gb);
     do {
-        UPDATE_CACHE(re, &s->gb);
-        GET_VLC(code, re, &s->gb, s->vlcs[1][ac_index].table, 9, 2);
+        UPDATE_CACHE(re, gb);
+        GET_VLC(code, re, gb, s->vlcs[1][ac_index].table, 9, 2);
 
         i += ((unsigned)code) >> 4;
             code &= 0xf;
         if (code) {
             if (code > MIN_CACHE_BITS - 16)
-                UPDATE_CACHE(re, &s->gb);
+                UPDATE_CACHE(re, gb);
 
             {
-                int cache = GET_CACHE(re, &s->gb);
+                int cache = GET_CACHE(re, gb);
                 int sign  = (~cache) >> 31;
                 level     = (NEG_USR32(sign ^ cache,code) ^ sign) - sign;
             }
 
-            LAST_SKIP_BITS(re, &s->gb, code);
+            LAST_SKIP_BITS(re, gb, code);
 
             if (i > 63) {
                 av_log(s->avctx, AV_LOG_ERROR, "error count: %d\n", i);
@@ -748,7 +767,7 @@ static int decode_block(MJpegDecodeContext *s, int16_t *block, int component,
             block[j] = level * quant_matrix[i];
         }
     } while (i < 63);
-    CLOSE_READER(re, &s->gb);}
+    CLOSE_READER(re, gb);}
 
     return 0;
 }
@@ -759,7 +778,7 @@ static int decode_dc_progressive(MJpegDecodeContext *s, int16_t *block,
 {
     unsigned val;
     s->bdsp.clear_block(block);
-    val = mjpeg_decode_dc(s, dc_index);
+    val = mjpeg_decode_dc(s, &s->gb, dc_index);
     if (val == 0xfffff) {
         av_log(s->avctx, AV_LOG_ERROR, "error dc\n");
         return AVERROR_INVALIDDATA;
@@ -1027,7 +1046,7 @@ static int ljpeg_decode_rgb_scan(MJpegDecodeContext *s, int nb_components, int p
 
                 PREDICT(pred, topleft[i], top[i], left[i], modified_predictor);
 
-                dc = mjpeg_decode_dc(s, s->dc_index[i]);
+                dc = mjpeg_decode_dc(s, &s->gb, s->dc_index[i]);
                 if(dc == 0xFFFFF)
                     return -1;
 
@@ -1139,7 +1158,7 @@ static int ljpeg_decode_yuv_scan(MJpegDecodeContext *s, int predictor,
                     for(j=0; j<n; j++) {
                         int pred, dc;
 
-                        dc = mjpeg_decode_dc(s, s->dc_index[i]);
+                        dc = mjpeg_decode_dc(s, &s->gb, s->dc_index[i]);
                         if(dc == 0xFFFFF)
                             return -1;
                         if (   h * mb_x + x >= s->width
@@ -1210,7 +1229,7 @@ static int ljpeg_decode_yuv_scan(MJpegDecodeContext *s, int predictor,
                     for (j = 0; j < n; j++) {
                         int pred;
 
-                        dc = mjpeg_decode_dc(s, s->dc_index[i]);
+                        dc = mjpeg_decode_dc(s, &s->gb, s->dc_index[i]);
                         if(dc == 0xFFFFF)
                             return -1;
                         if (   h * mb_x + x >= s->width
@@ -1279,6 +1298,169 @@ static void shift_output(MJpegDecodeContext *s, uint8_t *ptr, int linesize)
     }
 }
 
+typedef struct RestartIntervals {
+    int nb_components;
+    int chroma_width, chroma_height;
+    int start;          ///< offset of the first interval in the scan buffer
+    int nb_intervals;
+    int nb_jobs;
+    int end_bits;       ///< bit position at the end of the last interval
+} RestartIntervals;
+
+/**
+ * Check that the RSTn markers found while unescaping the scan delimit its
+ * restart intervals, so that they can be decoded independently.
+ */
+static int restart_markers_usable(MJpegDecodeContext *s,
+                                  const RestartIntervals *ri)
+{
+    const uint8_t *buf = s->gb.buffer;
+    int size = s->gb.size_in_bits >> 3;
+    int i, first, nb_markers = s->nb_restart_offsets;
+
+    if (buf != s->buffer)
+        return 0;
+    /* a marker may follow the last interval */
+    if (nb_markers == ri->nb_intervals)
+        nb_markers--;
+    if (nb_markers != ri->nb_intervals - 1)
+        return 0;
+    for (i = 0; i < nb_markers; i++) {
+        int offset = s->restart_offsets[i];
+        if (offset < ri->start || offset + 2 > size ||
+            (i && offset < s->restart_offsets[i - 1] + 2) ||
+            buf[offset] != 0xff)
+            return 0;
+        /* some encoders do not start counting from RST0, only require the
+         * markers to be consecutive */
+        if (!i)
+            first = buf[offset + 1] - RST0;
+        if (buf[offset + 1] != RST0 + ((first + i) & 7))
+            return 0;
+    }
+    return 1;
+}
+
+static int decode_restart_intervals(AVCodecContext *avctx, void *arg,
+                                    int jobnr, int threadnr)
+{
+    MJpegDecodeContext *s = avctx->priv_data;
+    RestartIntervals *ri  = arg;
+    const uint8_t *buf    = s->gb.buffer;
+    int size              = s->gb.size_in_bits >> 3;
+    int first = (int64_t)ri->nb_intervals *  jobnr      / ri->nb_jobs;
+    int last  = (int64_t)ri->nb_intervals * (jobnr + 1) / ri->nb_jobs;
+    int bytes_per_pixel = 1 + (s->bits > 8);
+    int interval, i, ret;
+    LOCAL_ALIGNED_16(int16_t, block, [64]);
+
+    for (interval = first; interval < last; interval++) {
+        int start = interval ? s->restart_offsets[interval - 1] + 2 : ri->start;
+        int end   = interval < ri->nb_intervals - 1 ?
+                    s->restart_offsets[interval] : size;
+        int mb    = interval * s->restart_interval;
+        int mb_end = FFMIN(mb + s->restart_interval,
+                           s->mb_width * s->mb_height);
+        int last_dc[MAX_COMPONENTS];
+        GetBitContext gb;
+
+        if ((ret = init_get_bits8(&gb, buf + start, end - start)) < 0)
+            return ret;
+        for (i = 0; i < ri->nb_components; i++)
+            last_dc[i] = 4 << s->bits;
+
+        for (; mb < mb_end; mb++) {
+            int mb_x = mb % s->mb_width;
+            int mb_y = mb / s->mb_width;
+
+            if (get_bits_left(&gb) < 0) {
+                av_log(avctx, AV_LOG_ERROR, "overread %d\n",
+                       -get_bits_left(&gb));
+                return AVERROR_INVALIDDATA;
+            }
+            for (i = 0; i < ri->nb_components; i++) {
+                int c = s->comp_index[i];
+                int h = s->h_scount[i];
+                int v = s->v_scount[i];
+                int linesize = s->linesize[c];
+                int x = 0, y = 0, j;
+
+                for (j = 0; j < s->nb_blocks[i]; j++) {
+                    int block_offset = ((linesize * (v * mb_y + y) * 8) +
+                                        (h * mb_x + x) * 8 * bytes_per_pixel) >> avctx->lowres;
+                    uint8_t *ptr;
+
+                    if (s->interlaced && s->bottom_field)
+                        block_offset += linesize >> 1;
+                    s->bdsp.clear_block(block);
+                    if (decode_block(s, &gb, last_dc, block, i,
+                                     s->dc_index[i], s->ac_index[i],
+                                     s->quant_matrixes[s->quant_sindex[i]]) < 0) {
+                        av_log(avctx, AV_LOG_ERROR,
+                               "error y=%d x=%d\n", mb_y, mb_x);
+                        return AVERROR_INVALIDDATA;
+                    }
+                    if (   8*(h * mb_x + x) < ((c == 1) || (c == 2) ? ri->chroma_width  : s->width)
+                        && 8*(v * mb_y + y) < ((c == 1) || (c == 2) ? ri->chroma_height : s->height)) {
+                        ptr = s->picture_ptr->data[c] + block_offset;
+                        s->idsp.idct_put(ptr, linesize, block);
+                        if (s->bits & 7)
+                            shift_output(s, ptr, linesize);
+                    }
+                    if (++x == h) {
+                        x = 0;
+                        y++;
+                    }
+                }
+            }
+        }
+        if (interval == ri->nb_intervals - 1)
+            ri->end_bits = start * 8 + get_bits_count(&gb);
+    }
+    emms_c();
+
+    return 0;
+}
+
+/**
+ * Decode the restart intervals of a sequential scan in parallel.
+ * @return 0 or an error code if the scan was decoded, 1 if it has to be
+ *         decoded sequentially
+ */
+static int decode_scan_threaded(MJpegDecodeContext *s, int nb_components,
+                                int chroma_width, int chroma_height)
+{
+    RestartIntervals ri;
+    int i, ret = 0, *rets;
+    int nb_mbs = s->mb_width * s->mb_height;
+
+    ri.nb_components = nb_components;
+    ri.chroma_width  = chroma_width;
+    ri.chroma_height = chroma_height;
+    ri.start         = get_bits_count(&s->gb) >> 3;
+    ri.nb_intervals  = (nb_mbs + s->restart_interval - 1) / s->restart_interval;
+    ri.nb_jobs       = FFMIN(ri.nb_intervals, s->mb_height);
+    ri.end_bits      = 0;
+
+    if (ri.nb_intervals < 2 || (get_bits_count(&s->gb) & 7) ||
+        !restart_markers_usable(s, &ri))
+        return 1;
+
+    rets = av_malloc_array(ri.nb_jobs, sizeof(*rets));
+    if (!rets)
+        return AVERROR(ENOMEM);
+    s->avctx->execute2(s->avctx, decode_restart_intervals, &ri, rets,
+                       ri.nb_jobs);
+    for (i = 0; i < ri.nb_jobs; i++)
+        if (rets[i] < 0)
+            ret = rets[i];
+    av_free(rets);
+
+    if (ri.end_bits)
+        skip_bits_long(&s->gb, ri.end_bits - get_bits_count(&s->gb));
+    return ret;
+}
+
 static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
                              int Al, const uint8_t *mb_bitmask,
                              int mb_bitmask_size,
@@ -1314,6 +1496,15 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
         s->coefs_finished[c] |= 1;
     }
 
+    if ((s->avctx->active_thread_type & FF_THREAD_SLICE) &&
+        s->restart_interval && !s->progressive && !mb_bitmask &&
+        s->avctx->codec_id != AV_CODEC_ID_THP) {
+        int ret = decode_scan_threaded(s, nb_components,
+                                       chroma_width, chroma_height);
+        if (ret <= 0)
+            return ret;
+    }
+
     for (mb_y = 0; mb_y < s->mb_height; mb_y++) {
         for (mb_x = 0; mb_x < s->mb_width; mb_x++) {
             const int copy_mb = mb_bitmask && !get_bits1(&mb_bitmask_gb);
@@ -1355,7 +1546,7 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
 
                         } else {
                             s->bdsp.clear_block(s->block);
-                            if (decode_block(s, s->block, i,
+                            if (decode_block(s, &s->gb, s->last_dc, s->block, i,
                                              s->dc_index[i], s->ac_index[i],
                                              s->quant_matrixes[s->quant_sindex[i]]) < 0) {
                                 av_log(s->avctx, AV_LOG_ERROR,
@@ -2043,6 +2234,23 @@ found:
     return val;
 }
 
+/**
+ * Check whether only scans and the EOI marker follow, i.e. whether all the
+ * headers that the next frame may inherit have been parsed.
+ */
+static int only_scans_follow(const uint8_t *buf_ptr, const uint8_t *buf_end)
+{
+    int start_code;
+
+    while ((start_code = find_marker(&buf_ptr, buf_end)) >= 0) {
+        if (start_code == EOI)
+            return 1;
+        if (start_code != SOS && (start_code < RST0 || start_code > RST7))
+            return 0;
+    }
+    return 1;
+}
+
 int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                          const uint8_t **buf_ptr, const uint8_t *buf_end,
                          const uint8_t **unescaped_buf_ptr,
@@ -2061,6 +2269,8 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
         const uint8_t *ptr = src;
         uint8_t *dst = s->buffer;
 
+        s->nb_restart_offsets = 0;
+
         #define copy_data_segment(skip) do {       \
             ptrdiff_t length = (ptr - src) - (skip);  \
             if (length > 0) {                         \
@@ -2098,6 +2308,18 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                         copy_data_segment(1);
                         if (x)
                             break;
+                    } else {
+                        /* remember where the RSTn marker will be copied, for
+                         * the restart intervals to be decoded in parallel */
+                        int *offsets = av_fast_realloc(s->restart_offsets,
+                                                       &s->restart_offsets_size,
+                                                       (s->nb_restart_offsets + 1) *
+                                                       sizeof(*offsets));
+                        if (!offsets)
+                            return AVERROR(ENOMEM);
+                        s->restart_offsets = offsets;
+                        s->restart_offsets[s->nb_restart_offsets++] =
+                            (dst - s->buffer) + (ptr - src) - 2;
                     }
                 }
             }
@@ -2192,6 +2414,7 @@ int ff_mjpeg_decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
     int i, index;
     int ret = 0;
     int is16bit;
+    int setup_finished = 0;
 
     av_dict_free(&s->exif_metadata);
     av_freep(&s->stereo3d);
@@ -2370,6 +2593,16 @@ eoi_parser:
                 break;
             }
 
+            /* the next frame thread can start once it cannot inherit any
+             * more state from this one; a first field leaves the picture
+             * for the next packet to complete, so wait for its end then */
+            if ((avctx->active_thread_type & FF_THREAD_FRAME) &&
+                !setup_finished && !s->interlaced &&
+                only_scans_follow(buf_ptr, buf_end)) {
+                ff_thread_finish_setup(avctx);
+                setup_finished = 1;
+            }
+
             if ((ret = ff_mjpeg_decode_sos(s, NULL, 0, NULL)) < 0 &&
                 (avctx->err_recognition & AV_EF_EXPLODE))
                 goto fail;
@@ -2644,6 +2877,8 @@ av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
     av_freep(&s->stereo3d);
     av_freep(&s->ljpeg_buffer);
     s->ljpeg_buffer_size = 0;
+    av_freep(&s->restart_offsets);
+    s->restart_offsets_size = 0;
 
     for (i = 0; i < 3; i++) {
         for (j = 0; j < 4; j++)
@@ -2660,6 +2895,131 @@ av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
     return 0;
 }
 
+#if CONFIG_MJPEG_DECODER && HAVE_THREADS
+static av_cold int decode_init_thread_copy(AVCodecContext *avctx)
+{
+    MJpegDecodeContext *s = avctx->priv_data;
+    int i, j, ret;
+
+    s->avctx = avctx;
+    s->picture = av_frame_alloc();
+    if (!s->picture)
+        return AVERROR(ENOMEM);
+    s->picture_ptr = s->picture;
+
+    s->buffer          = NULL;
+    s->buffer_size     = 0;
+    s->ljpeg_buffer    = NULL;
+    s->ljpeg_buffer_size = 0;
+    s->restart_offsets = NULL;
+    s->restart_offsets_size = 0;
+    s->exif_metadata   = NULL;
+    s->stereo3d        = NULL;
+    s->iccdata         = NULL;
+    s->iccdatalens     = NULL;
+    s->iccnum          = 0;
+    s->iccread         = 0;
+    memset(s->blocks,   0, sizeof(s->blocks));
+    memset(s->last_nnz, 0, sizeof(s->last_nnz));
+
+    /* the VLC tables are still those of the copied context */
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < 4; j++) {
+            int built = !!s->vlcs[i][j].table;
+
+            memset(&s->vlcs[i][j], 0, sizeof(s->vlcs[i][j]));
+            if (i)
+                memset(&s->vlcs[2][j], 0, sizeof(s->vlcs[2][j]));
+            if (built && (ret = build_huffman_vlcs(s, i, j)) < 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+static int decode_update_thread_context(AVCodecContext *dst,
+                                        const AVCodecContext *src)
+{
+    MJpegDecodeContext *s = dst->priv_data, *s1 = src->priv_data;
+    int i, j, ret;
+
+    if (dst == src)
+        return 0;
+
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < 4; j++) {
+            if (!memcmp(s->raw_huffman_lengths[i][j], s1->raw_huffman_lengths[i][j],
+                        sizeof(s->raw_huffman_lengths[i][j])) &&
+                !memcmp(s->raw_huffman_values[i][j], s1->raw_huffman_values[i][j],
+                        sizeof(s->raw_huffman_values[i][j])))
+                continue;
+            memcpy(s->raw_huffman_lengths[i][j], s1->raw_huffman_lengths[i][j],
+                   sizeof(s->raw_huffman_lengths[i][j]));
+            memcpy(s->raw_huffman_values[i][j], s1->raw_huffman_values[i][j],
+                   sizeof(s->raw_huffman_values[i][j]));
+            if ((ret = build_huffman_vlcs(s, i, j)) < 0)
+                return ret;
+        }
+    }
+    memcpy(s->quant_matrixes, s1->quant_matrixes, sizeof(s->quant_matrixes));
+    memcpy(s->qscale,         s1->qscale,         sizeof(s->qscale));
+
+    s->first_picture      = s1->first_picture;
+    s->lossless           = s1->lossless;
+    s->ls                 = s1->ls;
+    s->progressive        = s1->progressive;
+    s->rgb                = s1->rgb;
+    s->rct                = s1->rct;
+    s->pegasus_rct        = s1->pegasus_rct;
+    s->bits               = s1->bits;
+    s->colr               = s1->colr;
+    s->xfrm               = s1->xfrm;
+    s->maxval             = s1->maxval;
+    s->near               = s1->near;
+    s->t1                 = s1->t1;
+    s->t2                 = s1->t2;
+    s->t3                 = s1->t3;
+    s->reset              = s1->reset;
+    s->palette_index      = s1->palette_index;
+    s->width              = s1->width;
+    s->height             = s1->height;
+    memcpy(s->h_count, s1->h_count, sizeof(s->h_count));
+    memcpy(s->v_count, s1->v_count, sizeof(s->v_count));
+    s->restart_interval   = s1->restart_interval;
+    s->buggy_avid         = s1->buggy_avid;
+    s->cs_itu601          = s1->cs_itu601;
+    s->interlace_polarity = s1->interlace_polarity;
+    s->multiscope         = s1->multiscope;
+    s->flipped            = s1->flipped;
+    s->interlaced         = s1->interlaced;
+
+    /* the dimensions are only set when they change */
+    dst->width               = src->width;
+    dst->height              = src->height;
+    dst->coded_width         = src->coded_width;
+    dst->coded_height        = src->coded_height;
+    dst->sample_aspect_ratio = src->sample_aspect_ratio;
+
+    /* src only finishes its setup early for progressive frames, so an
+     * interlaced one is done and may have left its first field for this
+     * packet to complete */
+    s->got_picture = 0;
+    if (s->interlaced) {
+        s->bottom_field = s1->bottom_field;
+        if (s1->got_picture && s1->bottom_field == !s1->interlace_polarity) {
+            av_frame_unref(s->picture_ptr);
+            if ((ret = av_frame_ref(s->picture_ptr, s1->picture_ptr)) < 0)
+                return ret;
+            memcpy(s->linesize, s1->linesize, sizeof(s->linesize));
+            s->got_picture = 1;
+        }
+    }
+
+    return 0;
+}
+#endif
+
 static void decode_flush(AVCodecContext *avctx)
 {
     MJpegDecodeContext *s = avctx->priv_data;
@@ -2692,7 +3052,10 @@ AVCodec ff_mjpeg_decoder = {
     .close          = ff_mjpeg_decode_end,
     .decode         = ff_mjpeg_decode_frame,
     .flush          = decode_flush,
-    .capabilities   = AV_CODEC_CAP_DR1,
+    .init_thread_copy      = ONLY_IF_THREADS_ENABLED(decode_init_thread_copy),
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(decode_update_thread_context),
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .max_lowres     = 3,
     .priv_class     = &mjpegdec_class,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE |
@@ -52,6 +52,8 @@ typedef struct MJpegDecodeContext {
 
     uint16_t quant_matrixes[4][64];
     VLC vlcs[3][4];
+    uint8_t raw_huffman_lengths[2][4][17]; ///< DHT code counts per length, index 0 unused
+    uint8_t raw_huffman_values[2][4][256];
     int qscale[4];      ///< quantizer scale calculated from quant_matrixes
 
     int org_height;  /* size given at codec init */
@@ -110,6 +112,9 @@ typedef struct MJpegDecodeContext {
 
     int restart_interval;
     int restart_count;
+    int *restart_offsets;       ///< positions of the RSTn markers in the unescaped scan
+    unsigned int restart_offsets_size;
+    int nb_restart_offsets;
 
     int buggy_avid;
     int cs_itu601;
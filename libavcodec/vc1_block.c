@@ -30,6 +30,7 @@
 #include "mpegutils.h"
 #include "mpegvideo.h"
 #include "msmpeg4data.h"
+#include "thread.h"
 #include "unary.h"
 #include "vc1.h"
 #include "vc1_pred.h"
@@ -2482,6 +2483,51 @@ static int vc1_decode_b_mb_intfr(VC1Context *v)
     return 0;
 }
 
+/** Wait for the reference frames to be decoded as far as the motion
+ * vectors of the current MB row can point to (frame threading).
+ */
+static void vc1_await_references(VC1Context *v)
+{
+    MpegEncContext *s = &v->s;
+    int range, lines, row;
+
+    if (!(s->avctx->active_thread_type & FF_THREAD_FRAME))
+        return;
+
+    /* direct mode MVs of B pictures are scaled from the MVs of the next
+     * anchor, which may use a larger MV range than the current picture */
+    if (s->pict_type == AV_PICTURE_TYPE_B)
+        range = (v->extended_mv ? 1024 : 128) << (v->fcm != PROGRESSIVE);
+    else
+        range = v->range_y;
+
+    /* MV range in quarter pels, MB height and bicubic filter taps */
+    lines = (range >> 2) + 16 + 3;
+    if (v->field_mode)
+        lines = 2 * (s->mb_y * 16 + lines) + 1;
+    else
+        lines = s->mb_y * 16 + (lines << (v->fcm != PROGRESSIVE));
+    row = FFMIN(lines >> 4, s->mb_height - 1);
+
+    if (s->last_picture_ptr)
+        ff_thread_await_progress(&s->last_picture_ptr->tf, row, 0);
+    if (s->pict_type == AV_PICTURE_TYPE_B && s->next_picture_ptr)
+        ff_thread_await_progress(&s->next_picture_ptr->tf, row, 0);
+}
+
+/** Report the MB rows which are final once the current row is decoded.
+ * The overlap and loop filters run up to two MB rows behind the decoding
+ * loop; field pictures only report their progress when they are finished.
+ */
+static void vc1_report_decode_progress(VC1Context *v)
+{
+    MpegEncContext *s = &v->s;
+
+    if (!v->field_mode && s->pict_type != AV_PICTURE_TYPE_B &&
+        !s->er.error_occurred && s->mb_y >= 2)
+        ff_thread_report_progress(&s->current_picture_ptr->tf, s->mb_y - 2, 0);
+}
+
 /** Decode blocks of I-frame
  */
 static void vc1_decode_i_blocks(VC1Context *v)
@@ -2616,6 +2662,7 @@ static void vc1_decode_i_blocks(VC1Context *v)
             ff_mpeg_draw_horiz_band(s, s->mb_y * 16, 16);
         else if (s->mb_y)
             ff_mpeg_draw_horiz_band(s, (s->mb_y - 1) * 16, 16);
+        vc1_report_decode_progress(v);
 
         s->first_slice_line = 0;
     }
@@ -2745,6 +2792,7 @@ static void vc1_decode_i_blocks_adv(VC1Context *v)
             ff_mpeg_draw_horiz_band(s, s->mb_y * 16, 16);
         else if (s->mb_y)
             ff_mpeg_draw_horiz_band(s, (s->mb_y-1) * 16, 16);
+        vc1_report_decode_progress(v);
         s->first_slice_line = 0;
     }
 
@@ -2800,6 +2848,7 @@ static void vc1_decode_p_blocks(VC1Context *v)
     for (s->mb_y = s->start_mb_y; s->mb_y < s->end_mb_y; s->mb_y++) {
         s->mb_x = 0;
         init_block_index(v);
+        vc1_await_references(v);
         for (; s->mb_x < s->mb_width; s->mb_x++) {
             ff_update_block_index(s);
 
@@ -2824,6 +2873,7 @@ static void vc1_decode_p_blocks(VC1Context *v)
         memmove(v->luma_mv_base,  v->luma_mv,  sizeof(v->luma_mv_base[0])  * s->mb_stride);
         if (s->mb_y != s->start_mb_y)
             ff_mpeg_draw_horiz_band(s, (s->mb_y - 1) * 16, 16);
+        vc1_report_decode_progress(v);
         s->first_slice_line = 0;
     }
     if (apply_loop_filter) {
@@ -2873,6 +2923,7 @@ static void vc1_decode_b_blocks(VC1Context *v)
     for (s->mb_y = s->start_mb_y; s->mb_y < s->end_mb_y; s->mb_y++) {
         s->mb_x = 0;
         init_block_index(v);
+        vc1_await_references(v);
         for (; s->mb_x < s->mb_width; s->mb_x++) {
             ff_update_block_index(s);
 
@@ -2917,10 +2968,12 @@ static void vc1_decode_skip_blocks(VC1Context *v)
         s->mb_x = 0;
         init_block_index(v);
         ff_update_block_index(s);
+        ff_thread_await_progress(&s->last_picture_ptr->tf, s->mb_y, 0);
         memcpy(s->dest[0], s->last_picture.f->data[0] + s->mb_y * 16 * s->linesize,   s->linesize   * 16);
         memcpy(s->dest[1], s->last_picture.f->data[1] + s->mb_y *  8 * s->uvlinesize, s->uvlinesize *  8);
         memcpy(s->dest[2], s->last_picture.f->data[2] + s->mb_y *  8 * s->uvlinesize, s->uvlinesize *  8);
         ff_mpeg_draw_horiz_band(s, s->mb_y * 16, 16);
+        vc1_report_decode_progress(v);
         s->first_slice_line = 0;
     }
     s->pict_type = AV_PICTURE_TYPE_P;
@@ -35,6 +35,7 @@
 #include "msmpeg4.h"
 #include "msmpeg4data.h"
 #include "profiles.h"
+#include "thread.h"
 #include "vc1.h"
 #include "vc1data.h"
 #include "vdpau_compat.h"
@@ -541,6 +542,7 @@ static av_cold int vc1_decode_init(AVCodecContext *avctx)
         return AVERROR(ENOMEM);
 
     avctx->has_b_frames = !!avctx->max_b_frames;
+    avctx->internal->allocate_progress = 1;
 
     if (v->color_prim == 1 || v->color_prim == 5 || v->color_prim == 6)
         avctx->color_primaries = v->color_prim;
@@ -581,6 +583,100 @@ static av_cold int vc1_decode_init(AVCodecContext *avctx)
     return 0;
 }
 
+#if HAVE_THREADS
+static av_cold int vc1_decode_init_thread_copy(AVCodecContext *avctx)
+{
+    VC1Context *v = avctx->priv_data;
+
+    // the copied sprite frame belongs to the first thread
+    v->sprite_output_frame = av_frame_alloc();
+    if (!v->sprite_output_frame)
+        return AVERROR(ENOMEM);
+
+    return 0;
+}
+
+static int vc1_update_thread_context(AVCodecContext *dst,
+                                     const AVCodecContext *src)
+{
+    VC1Context *v = dst->priv_data, *v1 = src->priv_data;
+    MpegEncContext *s = &v->s, *s1 = &v1->s;
+    int ctx_initialized, ret;
+
+    if (dst == src)
+        return 0;
+
+    if (s->context_initialized &&
+        (s->width != s1->width || s->height != s1->height ||
+         !s1->context_initialized))
+        ff_vc1_decode_end(dst);
+
+    ctx_initialized = s->context_initialized;
+    if ((ret = ff_mpeg_update_thread_context(dst, src)) < 0)
+        return ret;
+    if (!ctx_initialized && s->context_initialized) {
+        if (!v->sprite_output_frame &&
+            !(v->sprite_output_frame = av_frame_alloc()))
+            return AVERROR(ENOMEM);
+        if ((ret = ff_vc1_decode_init_alloc_tables(v)) < 0)
+            return ret;
+    }
+
+    // sequence header and entry point
+    memcpy(&v->res_sprite, &v1->res_sprite,
+           (char *)&v1->mv_mode - (char *)&v1->res_sprite);
+    v->broken_link           = v1->broken_link;
+    v->closed_entry          = v1->closed_entry;
+    v->range_mapy_flag       = v1->range_mapy_flag;
+    v->range_mapuv_flag      = v1->range_mapuv_flag;
+    v->range_mapy            = v1->range_mapy;
+    v->range_mapuv           = v1->range_mapuv;
+    v->hrd_num_leaky_buckets = v1->hrd_num_leaky_buckets;
+    s->loop_filter           = s1->loop_filter;
+    s->h_edge_pos            = s1->h_edge_pos;
+    s->v_edge_pos            = s1->v_edge_pos;
+
+    // state carried over from the previous pictures
+    s->quarter_sample = s1->quarter_sample;
+    s->mspel          = s1->mspel;
+    v->rnd            = v1->rnd;
+    v->mvrange        = v1->mvrange;
+    v->respic         = v1->respic;
+    v->refdist        = v1->refdist;
+    v->qs_last        = v1->qs_last;
+
+    memcpy(v->last_luty,  v1->last_luty,  sizeof(v->last_luty));
+    memcpy(v->last_lutuv, v1->last_lutuv, sizeof(v->last_lutuv));
+    memcpy(v->aux_luty,   v1->aux_luty,   sizeof(v->aux_luty));
+    memcpy(v->aux_lutuv,  v1->aux_lutuv,  sizeof(v->aux_lutuv));
+    memcpy(v->next_luty,  v1->next_luty,  sizeof(v->next_luty));
+    memcpy(v->next_lutuv, v1->next_lutuv, sizeof(v->next_lutuv));
+    v->last_use_ic = v1->last_use_ic;
+    v->next_use_ic = v1->next_use_ic;
+    v->aux_use_ic  = v1->aux_use_ic;
+    if (v1->curr_use_ic == &v1->aux_use_ic) {
+        v->curr_luty   = v->aux_luty;
+        v->curr_lutuv  = v->aux_lutuv;
+        v->curr_use_ic = &v->aux_use_ic;
+    } else {
+        v->curr_luty   = v->next_luty;
+        v->curr_lutuv  = v->next_lutuv;
+        v->curr_use_ic = &v->next_use_ic;
+    }
+
+    // field MV types of the next anchor, used by B field pictures
+    if (v->interlace && s->context_initialized && s1->context_initialized) {
+        int mb_height = FFALIGN(s->mb_height, 2);
+        int size      = s->b8_stride * (mb_height * 2 + 1) + s->mb_stride * (mb_height + 1) * 2;
+
+        memcpy(v->mv_f_next[0] - s->b8_stride - 1,
+               v1->mv_f_next[0] - s1->b8_stride - 1, 2 * size);
+    }
+
+    return 0;
+}
+#endif
+
 /** Close a VC1/WMV3 decoder
  * @warning Initial try at using MpegEncContext stuff
  */
@@ -629,7 +725,7 @@ static int vc1_decode_frame(AVCodecContext *avctx, void *data,
     AVFrame *pict = data;
     uint8_t *buf2 = NULL;
     const uint8_t *buf_start = buf, *buf_start_second_field = NULL;
-    int mb_height, n_slices1=-1;
+    int mb_height, n_slices1=-1, frame_started = 0;
     struct {
         uint8_t *buf;
         GetBitContext gb;
@@ -897,6 +993,7 @@ static int vc1_decode_frame(AVCodecContext *avctx, void *data,
     if ((ret = ff_mpv_frame_start(s, avctx)) < 0) {
         goto err;
     }
+    frame_started = 1;
 
     v->s.current_picture_ptr->field_picture = v->field_mode;
     v->s.current_picture_ptr->f->interlaced_frame = (v->fcm != PROGRESSIVE);
@@ -917,6 +1014,18 @@ static int vc1_decode_frame(AVCodecContext *avctx, void *data,
     s->me.qpel_put = s->qdsp.put_qpel_pixels_tab;
     s->me.qpel_avg = s->qdsp.avg_qpel_pixels_tab;
 
+    /* the header of the second field and picture headers repeated in slice
+     * headers still update the intensity compensation LUTs, rounding and MV
+     * range, and the field MV types are swapped after decoding, so such
+     * pictures finish their setup when done */
+    if (!v->field_mode) {
+        for (i = 0; i < n_slices; i++)
+            if (show_bits1(&slices[i].gb))
+                break;
+        if (i == n_slices)
+            ff_thread_finish_setup(avctx);
+    }
+
 #if FF_API_CAP_VDPAU
     if ((CONFIG_VC1_VDPAU_DECODER)
         &&s->avctx->codec->capabilities&AV_CODEC_CAP_HWACCEL_VDPAU) {
@@ -1136,6 +1245,8 @@ end:
     return buf_size;
 
 err:
+    if (frame_started)
+        ff_thread_report_progress(&s->current_picture_ptr->tf, INT_MAX, 0);
     av_free(buf2);
     for (i = 0; i < n_slices; i++)
         av_free(slices[i].buf);
@@ -1172,7 +1283,9 @@ AVCodec ff_vc1_decoder = {
     .close          = ff_vc1_decode_end,
     .decode         = vc1_decode_frame,
     .flush          = ff_mpeg_flush,
-    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY | AV_CODEC_CAP_FRAME_THREADS,
+    .init_thread_copy      = ONLY_IF_THREADS_ENABLED(vc1_decode_init_thread_copy),
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(vc1_update_thread_context),
     .pix_fmts       = vc1_hwaccel_pixfmt_list_420,
     .profiles       = NULL_IF_CONFIG_SMALL(ff_vc1_profiles)
 };
@@ -1188,7 +1301,9 @@ AVCodec ff_wmv3_decoder = {
     .close          = ff_vc1_decode_end,
     .decode         = vc1_decode_frame,
     .flush          = ff_mpeg_flush,
-    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY | AV_CODEC_CAP_FRAME_THREADS,
+    .init_thread_copy      = ONLY_IF_THREADS_ENABLED(vc1_decode_init_thread_copy),
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(vc1_update_thread_context),
     .pix_fmts       = vc1_hwaccel_pixfmt_list_420,
     .profiles       = NULL_IF_CONFIG_SMALL(ff_vc1_profiles)
 };
@@ -84,3 +84,31 @@ cglobal aac_quantize_bands, 5, 5, 6, out, in, scaled, size, is_signed, maxval, Q
     add       sizeq, mmsize
     jl       .loop
     RET
+
+;*******************************************************************
+;float ff_aac_find_max_val(int group_len, int swb_size, const float *scaled);
+;*******************************************************************
+INIT_XMM sse
+cglobal aac_find_max_val, 3, 4, 2, group_len, swb_size, scaled, i
+    xorps     m0, m0
+    shl       swb_sized, 2
+    add       scaledq, swb_sizeq
+    neg       swb_sizeq
+.group:
+    mov       iq, swb_sizeq
+.loop:
+    maxps     m0, [scaledq+iq]
+    add       iq, mmsize
+    jl       .loop
+    add       scaledq, 128*4
+    dec       group_lend
+    jg       .group
+    movhlps   m1, m0
+    maxps     m0, m1
+    shufps    m1, m0, m0, q0001
+    maxss     m0, m1
+%if ARCH_X86_64 == 0
+    movss     r0m, m0
+    fld dword r0m
+%endif
+    RET
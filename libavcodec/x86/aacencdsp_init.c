@@ -31,13 +31,17 @@ void ff_aac_quantize_bands_sse2(int *out, const float *in, const float *scaled,
                                 int size, int is_signed, int maxval, const float Q34,
                                 const float rounding);
 
+float ff_aac_find_max_val_sse(int group_len, int swb_size, const float *scaled);
+
 av_cold void ff_aac_dsp_init_x86(AACEncContext *s)
 {
     int cpu_flags = av_get_cpu_flags();
 
-    if (EXTERNAL_SSE(cpu_flags))
-        s->abs_pow34   = ff_abs_pow34_sse;
+    if (EXTERNAL_SSE(cpu_flags)) {
+        s->abs_pow34    = ff_abs_pow34_sse;
+        s->find_max_val = ff_aac_find_max_val_sse;
+    }
 
     if (EXTERNAL_SSE2(cpu_flags))
-        s->quant_bands = ff_aac_quantize_bands_sse2;
+        s->quant_bands  = ff_aac_quantize_bands_sse2;
 }
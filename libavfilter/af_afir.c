@@ -52,7 +52,7 @@ static void fcmul_add_c(float *sum, const float *t, const float *c, ptrdiff_t le
     sum[2 * n] += t[2 * n] * c[2 * n];
 }
 
-static int fir_channel(AVFilterContext *ctx, void *arg, int ch, int nb_jobs)
+static int fir_channel(AVFilterContext *ctx, void *arg, int ch)
 {
     AudioFIRContext *s = ctx->priv;
     const float *src = (const float *)s->in[0]->extended_data[ch];
@@ -112,6 +112,19 @@ static int fir_channel(AVFilterContext *ctx, void *arg, int ch, int nb_jobs)
     return 0;
 }
 
+static int fir_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    const int channels = ctx->outputs[0]->channels;
+    const int start = (channels *  jobnr   ) / nb_jobs;
+    const int end   = (channels * (jobnr+1)) / nb_jobs;
+    int ch;
+
+    for (ch = start; ch < end; ch++)
+        fir_channel(ctx, arg, ch);
+
+    return 0;
+}
+
 static int fir_frame(AudioFIRContext *s, AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
@@ -134,7 +147,8 @@ static int fir_frame(AudioFIRContext *s, AVFilterLink *outlink)
 
     av_audio_fifo_peek(s->fifo[0], (void **)s->in[0]->extended_data, s->nb_samples);
 
-    ctx->internal->execute(ctx, fir_channel, out, NULL, outlink->channels);
+    ctx->internal->execute(ctx, fir_channels, out, NULL,
+                           FFMIN(outlink->channels, ff_filter_get_nb_threads(ctx)));
 
     s->part_index = (s->part_index + 1) % s->nb_partitions;
 
@@ -64,6 +64,7 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/opt.h"
+#include "af_biquads.h"
 #include "audio.h"
 #include "avfilter.h"
 #include "internal.h"
@@ -92,6 +93,7 @@ enum WidthType {
 typedef struct ChanCache {
     double i1, i2;
     double o1, o2;
+    int clippings;
 } ChanCache;
 
 typedef struct BiquadsContext {
@@ -111,12 +113,16 @@ typedef struct BiquadsContext {
     double b0, b1, b2;
 
     ChanCache *cache;
-    int clippings;
     int block_align;
 
-    void (*filter)(struct BiquadsContext *s, const void *ibuf, void *obuf, int len,
+    BiquadDSPContext dsp;
+    double *state;
+    void **src, **dst;
+
+    void (*filter)(const void *ibuf, void *obuf, int len,
                    double *i1, double *i2, double *o1, double *o2,
-                   double b0, double b1, double b2, double a1, double a2);
+                   double b0, double b1, double b2, double a1, double a2,
+                   int *clippings);
 } BiquadsContext;
 
 static av_cold int init(AVFilterContext *ctx)
@@ -168,12 +174,11 @@ static int query_formats(AVFilterContext *ctx)
 }
 
 #define BIQUAD_FILTER(name, type, min, max, need_clipping)                    \
-static void biquad_## name (BiquadsContext *s,                                \
-                            const void *input, void *output, int len,         \
+static void biquad_## name (const void *input, void *output, int len,         \
                             double *in1, double *in2,                         \
                             double *out1, double *out2,                       \
                             double b0, double b1, double b2,                  \
-                            double a1, double a2)                             \
+                            double a1, double a2, int *clippings)             \
 {                                                                             \
     const type *ibuf = input;                                                 \
     type *obuf = output;                                                      \
@@ -189,10 +194,10 @@ static void biquad_## name (BiquadsContext *s,                                \
         o2 = i2 * b2 + i1 * b1 + ibuf[i] * b0 + o2 * a2 + o1 * a1;            \
         i2 = ibuf[i];                                                         \
         if (need_clipping && o2 < min) {                                      \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = min;                                                    \
         } else if (need_clipping && o2 > max) {                               \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = max;                                                    \
         } else {                                                              \
             obuf[i] = o2;                                                     \
@@ -201,10 +206,10 @@ static void biquad_## name (BiquadsContext *s,                                \
         o1 = i1 * b2 + i2 * b1 + ibuf[i] * b0 + o1 * a2 + o2 * a1;            \
         i1 = ibuf[i];                                                         \
         if (need_clipping && o1 < min) {                                      \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = min;                                                    \
         } else if (need_clipping && o1 > max) {                               \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = max;                                                    \
         } else {                                                              \
             obuf[i] = o1;                                                     \
@@ -217,10 +222,10 @@ static void biquad_## name (BiquadsContext *s,                                \
         o2 = o1;                                                              \
         o1 = o0;                                                              \
         if (need_clipping && o0 < min) {                                      \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = min;                                                    \
         } else if (need_clipping && o0 > max) {                               \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = max;                                                    \
         } else {                                                              \
             obuf[i] = o0;                                                     \
@@ -237,6 +242,35 @@ BIQUAD_FILTER(s32, int32_t, INT32_MIN, INT32_MAX, 1)
 BIQUAD_FILTER(flt, float,   -1., 1., 0)
 BIQUAD_FILTER(dbl, double,  -1., 1., 0)
 
+#define BIQUAD_FILTER_PLANES(name, type)                                      \
+static int biquad_planes_## name (type **dst, const type **src,               \
+                                  int nb_channels, int len,                   \
+                                  double *state, const double *coeffs)        \
+{                                                                             \
+    int ch;                                                                   \
+                                                                              \
+    for (ch = 0; ch < nb_channels; ch++)                                      \
+        biquad_## name (src[ch], dst[ch], len,                                \
+                        &state[ch], &state[nb_channels + ch],                 \
+                        &state[2 * nb_channels + ch],                         \
+                        &state[3 * nb_channels + ch],                         \
+                        coeffs[0], coeffs[1], coeffs[2],                      \
+                        coeffs[3], coeffs[4], NULL);                          \
+    return nb_channels;                                                       \
+}
+
+BIQUAD_FILTER_PLANES(flt, float)
+BIQUAD_FILTER_PLANES(dbl, double)
+
+av_cold void ff_biquad_dsp_init(BiquadDSPContext *dsp)
+{
+    dsp->filter_flt = biquad_planes_flt;
+    dsp->filter_dbl = biquad_planes_dbl;
+
+    if (ARCH_X86)
+        ff_biquad_dsp_init_x86(dsp);
+}
+
 static int config_output(AVFilterLink *outlink)
 {
     AVFilterContext *ctx    = outlink->src;
@@ -382,6 +416,16 @@ static int config_output(AVFilterLink *outlink)
         return AVERROR(ENOMEM);
     memset(s->cache, 0, sizeof(ChanCache) * inlink->channels);
 
+    av_freep(&s->state);
+    av_freep(&s->src);
+    av_freep(&s->dst);
+    s->state = av_malloc_array(inlink->channels, 4 * sizeof(*s->state));
+    s->src   = av_malloc_array(inlink->channels, sizeof(*s->src));
+    s->dst   = av_malloc_array(inlink->channels, sizeof(*s->dst));
+    if (!s->state || !s->src || !s->dst)
+        return AVERROR(ENOMEM);
+    ff_biquad_dsp_init(&s->dsp);
+
     switch (inlink->format) {
     case AV_SAMPLE_FMT_S16P: s->filter = biquad_s16; break;
     case AV_SAMPLE_FMT_S32P: s->filter = biquad_s32; break;
@@ -395,14 +439,110 @@ static int config_output(AVFilterLink *outlink)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static int channel_enabled(AVFilterContext *ctx, int ch)
+{
+    BiquadsContext *s = ctx->priv;
+
+    return !!(av_channel_layout_extract_channel(ctx->inputs[0]->channel_layout, ch) & s->channels);
+}
+
+/* Filter the n enabled float or double channels of [start, end) with the
+ * DSP functions, which may handle several channels at once. */
+static void filter_planes(AVFilterContext *ctx, int start, int end, int n,
+                          int nb_samples)
+{
+    BiquadsContext *s    = ctx->priv;
+    const double coeffs[5] = { s->b0, s->b1, s->b2, s->a1, s->a2 };
+    double *state = s->state + 4 * start;
+    void **src    = s->src + start;
+    void **dst    = s->dst + start;
+    int ch, i, done;
+
+    for (ch = start, i = 0; ch < end; ch++) {
+        if (!channel_enabled(ctx, ch))
+            continue;
+        state[        i] = s->cache[ch].i1;
+        state[    n + i] = s->cache[ch].i2;
+        state[2 * n + i] = s->cache[ch].o1;
+        state[3 * n + i] = s->cache[ch].o2;
+        i++;
+    }
+
+    if (ctx->inputs[0]->format == AV_SAMPLE_FMT_FLTP)
+        done = s->dsp.filter_flt((float **)dst, (const float **)src, n,
+                                 nb_samples, state, coeffs);
+    else
+        done = s->dsp.filter_dbl((double **)dst, (const double **)src, n,
+                                 nb_samples, state, coeffs);
+
+    for (i = done; i < n; i++)
+        s->filter(src[i], dst[i], nb_samples,
+                  &state[i], &state[n + i], &state[2 * n + i], &state[3 * n + i],
+                  s->b0, s->b1, s->b2, s->a1, s->a2, NULL);
+
+    for (ch = start, i = 0; ch < end; ch++) {
+        if (!channel_enabled(ctx, ch))
+            continue;
+        s->cache[ch].i1 = state[        i];
+        s->cache[ch].i2 = state[    n + i];
+        s->cache[ch].o1 = state[2 * n + i];
+        s->cache[ch].o2 = state[3 * n + i];
+        i++;
+    }
+}
+
+static int filter_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BiquadsContext *s    = ctx->priv;
+    ThreadData *td       = arg;
+    AVFrame *buf         = td->in;
+    AVFrame *out_buf     = td->out;
+    const int nb_samples = buf->nb_samples;
+    const int start      = (buf->channels *  jobnr   ) / nb_jobs;
+    const int end        = (buf->channels * (jobnr+1)) / nb_jobs;
+    const int planes     = ctx->inputs[0]->format == AV_SAMPLE_FMT_FLTP ||
+                           ctx->inputs[0]->format == AV_SAMPLE_FMT_DBLP;
+    int ch, n = 0;
+
+    for (ch = start; ch < end; ch++) {
+        if (!channel_enabled(ctx, ch)) {
+            if (buf != out_buf)
+                memcpy(out_buf->extended_data[ch], buf->extended_data[ch], nb_samples * s->block_align);
+            continue;
+        }
+        if (planes) {
+            s->src[start + n] = buf->extended_data[ch];
+            s->dst[start + n] = out_buf->extended_data[ch];
+            n++;
+            continue;
+        }
+        s->filter(buf->extended_data[ch],
+                  out_buf->extended_data[ch], nb_samples,
+                  &s->cache[ch].i1, &s->cache[ch].i2,
+                  &s->cache[ch].o1, &s->cache[ch].o2,
+                  s->b0, s->b1, s->b2, s->a1, s->a2,
+                  &s->cache[ch].clippings);
+    }
+
+    if (n)
+        filter_planes(ctx, start, end, n, nb_samples);
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
 {
     AVFilterContext  *ctx = inlink->dst;
     BiquadsContext *s     = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
     AVFrame *out_buf;
+    ThreadData td;
     int nb_samples = buf->nb_samples;
-    int ch;
+    int ch, clippings = 0;
 
     if (av_frame_is_writable(buf)) {
         out_buf = buf;
@@ -415,22 +555,17 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
         av_frame_copy_props(out_buf, buf);
     }
 
+    td.in  = buf;
+    td.out = out_buf;
+    ctx->internal->execute(ctx, filter_channels, &td, NULL,
+                           FFMIN(buf->channels, ff_filter_get_nb_threads(ctx)));
+
     for (ch = 0; ch < buf->channels; ch++) {
-        if (!((av_channel_layout_extract_channel(inlink->channel_layout, ch) & s->channels))) {
-            if (buf != out_buf)
-                memcpy(out_buf->extended_data[ch], buf->extended_data[ch], nb_samples * s->block_align);
-            continue;
-        }
-        s->filter(s, buf->extended_data[ch],
-                  out_buf->extended_data[ch], nb_samples,
-                  &s->cache[ch].i1, &s->cache[ch].i2,
-                  &s->cache[ch].o1, &s->cache[ch].o2,
-                  s->b0, s->b1, s->b2, s->a1, s->a2);
+        clippings += s->cache[ch].clippings;
+        s->cache[ch].clippings = 0;
     }
-
-    if (s->clippings > 0)
-        av_log(ctx, AV_LOG_WARNING, "clipping %d times. Please reduce gain.\n", s->clippings);
-    s->clippings = 0;
+    if (clippings > 0)
+        av_log(ctx, AV_LOG_WARNING, "clipping %d times. Please reduce gain.\n", clippings);
 
     if (buf != out_buf)
         av_frame_free(&buf);
@@ -443,6 +578,9 @@ static av_cold void uninit(AVFilterContext *ctx)
     BiquadsContext *s = ctx->priv;
 
     av_freep(&s->cache);
+    av_freep(&s->state);
+    av_freep(&s->src);
+    av_freep(&s->dst);
 }
 
 static const AVFilterPad inputs[] = {
@@ -486,6 +624,7 @@ AVFilter ff_af_##name_ = {                         \
     .inputs        = inputs,                             \
     .outputs       = outputs,                            \
     .priv_class    = &name_##_class,                     \
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,        \
 }
 
 #if CONFIG_EQUALIZER_FILTER
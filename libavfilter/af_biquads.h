@@ -0,0 +1,40 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_BIQUADS_H
+#define AVFILTER_BIQUADS_H
+
+typedef struct BiquadDSPContext {
+    /**
+     * Run the biquad over len samples of each of the nb_channels planar
+     * channels of src, writing to dst. state holds the i1, i2, o1 and o2
+     * histories of the channels as four consecutive arrays of nb_channels
+     * values, and is updated. coeffs holds b0, b1, b2, a1 and a2.
+     * Returns the number of channels processed, which may be less than
+     * nb_channels; the caller is responsible for the remaining ones.
+     */
+    int (*filter_flt)(float **dst, const float **src, int nb_channels,
+                      int len, double *state, const double *coeffs);
+    int (*filter_dbl)(double **dst, const double **src, int nb_channels,
+                      int len, double *state, const double *coeffs);
+} BiquadDSPContext;
+
+void ff_biquad_dsp_init(BiquadDSPContext *dsp);
+void ff_biquad_dsp_init_x86(BiquadDSPContext *dsp);
+
+#endif /* AVFILTER_BIQUADS_H */
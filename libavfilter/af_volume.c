@@ -338,6 +338,45 @@ static int process_command(AVFilterContext *ctx, const char *cmd, const char *ar
 #define TS2D(ts) ((ts) == AV_NOPTS_VALUE ? NAN : (double)(ts))
 #define TS2T(ts, tb) ((ts) == AV_NOPTS_VALUE ? NAN : (double)(ts)*av_q2d(tb))
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int plane_samples;
+} ThreadData;
+
+static int scale_planes(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VolumeContext *vol = ctx->priv;
+    ThreadData *td     = arg;
+    AVFrame *buf       = td->in;
+    AVFrame *out_buf   = td->out;
+    const int start    = (vol->planes *  jobnr   ) / nb_jobs;
+    const int end      = (vol->planes * (jobnr+1)) / nb_jobs;
+    int p;
+
+    if (vol->precision == PRECISION_FIXED) {
+        for (p = start; p < end; p++) {
+            vol->scale_samples(out_buf->extended_data[p],
+                               buf->extended_data[p], td->plane_samples,
+                               vol->volume_i);
+        }
+    } else if (av_get_packed_sample_fmt(vol->sample_fmt) == AV_SAMPLE_FMT_FLT) {
+        for (p = start; p < end; p++) {
+            vol->fdsp->vector_fmul_scalar((float *)out_buf->extended_data[p],
+                                         (const float *)buf->extended_data[p],
+                                         vol->volume, td->plane_samples);
+        }
+    } else {
+        for (p = start; p < end; p++) {
+            vol->fdsp->vector_dmul_scalar((double *)out_buf->extended_data[p],
+                                         (const double *)buf->extended_data[p],
+                                         vol->volume, td->plane_samples);
+        }
+    }
+
+    emms_c();
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
 {
     AVFilterContext *ctx = inlink->dst;
@@ -424,32 +463,17 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
     }
 
     if (vol->precision != PRECISION_FIXED || vol->volume_i > 0) {
-        int p, plane_samples;
+        ThreadData td;
 
         if (av_sample_fmt_is_planar(buf->format))
-            plane_samples = FFALIGN(nb_samples, vol->samples_align);
+            td.plane_samples = FFALIGN(nb_samples, vol->samples_align);
         else
-            plane_samples = FFALIGN(nb_samples * vol->channels, vol->samples_align);
+            td.plane_samples = FFALIGN(nb_samples * vol->channels, vol->samples_align);
 
-        if (vol->precision == PRECISION_FIXED) {
-            for (p = 0; p < vol->planes; p++) {
-                vol->scale_samples(out_buf->extended_data[p],
-                                   buf->extended_data[p], plane_samples,
-                                   vol->volume_i);
-            }
-        } else if (av_get_packed_sample_fmt(vol->sample_fmt) == AV_SAMPLE_FMT_FLT) {
-            for (p = 0; p < vol->planes; p++) {
-                vol->fdsp->vector_fmul_scalar((float *)out_buf->extended_data[p],
-                                             (const float *)buf->extended_data[p],
-                                             vol->volume, plane_samples);
-            }
-        } else {
-            for (p = 0; p < vol->planes; p++) {
-                vol->fdsp->vector_dmul_scalar((double *)out_buf->extended_data[p],
-                                             (const double *)buf->extended_data[p],
-                                             vol->volume, plane_samples);
-            }
-        }
+        td.in  = buf;
+        td.out = out_buf;
+        ctx->internal->execute(ctx, scale_planes, &td, NULL,
+                               FFMIN(vol->planes, ff_filter_get_nb_threads(ctx)));
     }
 
     emms_c();
@@ -490,6 +514,7 @@ AVFilter ff_af_volume = {
     .uninit         = uninit,
     .inputs         = avfilter_af_volume_inputs,
     .outputs        = avfilter_af_volume_outputs,
-    .flags          = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags          = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC |
+                      AVFILTER_FLAG_SLICE_THREADS,
     .process_command = process_command,
 };
@@ -33,6 +33,9 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/time.h"
+
+#include <time.h>
 
 #define FF_INTERNAL_FIELDS 1
 #include "framequeue.h"
@@ -1471,6 +1474,22 @@ static int ff_filter_activate_default(AVFilterContext *filter)
 
  */
 
+/* CPU time used by the calling thread in microseconds, 0 if unknown */
+static int64_t thread_cpu_time(void)
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_THREAD_CPUTIME_ID)
+#ifdef __APPLE__
+    if (clock_gettime)
+#endif
+    {
+        struct timespec ts;
+        if (!clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+            return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+#endif
+    return 0;
+}
+
 int ff_filter_activate(AVFilterContext *filter)
 {
     int ret;
@@ -1479,8 +1498,18 @@ int ff_filter_activate(AVFilterContext *filter)
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
     filter->ready = 0;
-    ret = filter->filter->activate ? filter->filter->activate(filter) :
-          ff_filter_activate_default(filter);
+    if (filter->graph->instrument) {
+        int64_t start     = av_gettime_relative();
+        int64_t cpu_start = thread_cpu_time();
+        ret = filter->filter->activate ? filter->filter->activate(filter) :
+              ff_filter_activate_default(filter);
+        filter->internal->cpu_time += thread_cpu_time() - cpu_start;
+        filter->internal->time     += av_gettime_relative() - start;
+        filter->internal->nb_activations++;
+    } else {
+        ret = filter->filter->activate ? filter->filter->activate(filter) :
+              ff_filter_activate_default(filter);
+    }
     if (ret == FFERROR_NOT_READY)
         ret = 0;
     return ret;
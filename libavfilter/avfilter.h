@@ -911,6 +911,17 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * If nonzero, record for each filter the time spent processing and the
+     * number of activations, and for each link the maximum number of queued
+     * frames. The statistics can be retrieved with
+     * avfilter_graph_dump_stats().
+     *
+     * May be set by the caller at any point; only the processing done while
+     * it is set is accounted for. Set with the "instrument" AVOption.
+     */
+    int instrument;
+
     /**
      * Private fields
      *
@@ -1170,6 +1181,27 @@ int avfilter_graph_queue_command(AVFilterGraph *graph, const char *target, const
  */
 char *avfilter_graph_dump(AVFilterGraph *graph, const char *options);
 
+/**
+ * Dump the processing statistics of a graph as a JSON document.
+ *
+ * For every filter, the document contains its name and type, the
+ * cumulated wall-clock ("time") and CPU ("cpu_time") time spent in it in
+ * microseconds, the number of times it was activated and the number of
+ * frames it received and produced. The CPU time is the one of the thread
+ * running the graph: work a filter hands over to slice threads only shows
+ * in the wall-clock time. It is 0 where the system cannot measure it.
+ * For every input link, it contains the number of frames currently
+ * queued, the maximum number of frames ever queued and the number of
+ * frames that went through it.
+ *
+ * Times and activations are only recorded while AVFilterGraph.instrument
+ * is set. The function may be called at any time between calls to the
+ * filtering functions, including while the graph is running.
+ *
+ * @return  a string, to be freed with av_free(), or NULL on error
+ */
+char *avfilter_graph_dump_stats(AVFilterGraph *graph);
+
 /**
  * Request a frame on the oldest sink link.
  *
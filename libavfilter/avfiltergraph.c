@@ -53,6 +53,8 @@ static const AVOption filtergraph_options[] = {
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, FLAGS },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, FLAGS },
+    { "instrument", "record per-filter timing and queue statistics", OFFSET(instrument),
+        AV_OPT_TYPE_BOOL,  { .i64 = 0 }, 0, 1, FLAGS },
     { NULL },
 };
 
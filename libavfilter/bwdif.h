@@ -38,15 +38,33 @@ enum BWDIFDeint {
     BWDIF_DEINT_INTERLACED = 1, ///< only deinterlace frames marked as interlaced
 };
 
+/**
+ * Output frame waiting to be filtered, with references to the input frames
+ * it is interpolated from.
+ */
+typedef struct BWDIFQueuedFrame {
+    AVFrame *prev;
+    AVFrame *cur;
+    AVFrame *next;
+    AVFrame *out;
+    int parity;
+    int tff;
+    int inter_field;
+} BWDIFQueuedFrame;
+
 typedef struct BWDIFContext {
     const AVClass *class;
 
     int mode;           ///< BWDIFMode
     int parity;         ///< BWDIFParity
     int deint;          ///< BWDIFDeint
+    int batch;          ///< number of output frames filtered together
 
     int frame_pending;
 
+    BWDIFQueuedFrame *queued;
+    int nb_queued;
+
     AVFrame *cur;
     AVFrame *next;
     AVFrame *prev;
@@ -73,6 +73,11 @@ typedef struct FFFrameQueue {
      */
     size_t queued;
 
+    /**
+     * Maximum number of frames queued at the same time.
+     */
+    size_t max_queued;
+
     /**
      * Pre-allocated bucket for queues of size 1.
      */
@@ -21,9 +21,14 @@
 
 #include <string.h>
 
+#include "libavutil/avstring.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/bprint.h"
 #include "libavutil/pixdesc.h"
+
+#define FF_INTERNAL_FIELDS 1
+#include "framequeue.h"
+
 #include "avfilter.h"
 #include "internal.h"
 
@@ -163,3 +168,65 @@ char *avfilter_graph_dump(AVFilterGraph *graph, const char *options)
     av_bprint_finalize(&buf, &dump);
     return dump;
 }
+
+static void print_json_string(AVBPrint *buf, const char *str)
+{
+    av_bprint_chars(buf, '"', 1);
+    av_bprint_escape(buf, str, "\"\\", AV_ESCAPE_MODE_BACKSLASH, 0);
+    av_bprint_chars(buf, '"', 1);
+}
+
+char *avfilter_graph_dump_stats(AVFilterGraph *graph)
+{
+    AVBPrint buf;
+    char *dump;
+    unsigned i, j;
+
+    av_bprint_init(&buf, 0, AV_BPRINT_SIZE_UNLIMITED);
+    av_bprintf(&buf, "{\n  \"filters\": [");
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *filter = graph->filters[i];
+        int64_t frames_in = 0, frames_out = 0;
+
+        for (j = 0; j < filter->nb_inputs; j++)
+            frames_in += filter->inputs[j]->frame_count_out;
+        for (j = 0; j < filter->nb_outputs; j++)
+            frames_out += filter->outputs[j]->frame_count_in;
+
+        av_bprintf(&buf, "%s\n    {\n      \"name\": ", i ? "," : "");
+        print_json_string(&buf, filter->name);
+        av_bprintf(&buf, ",\n      \"filter\": ");
+        print_json_string(&buf, filter->filter->name);
+        av_bprintf(&buf, ",\n      \"time\": %"PRId64",\n"
+                   "      \"cpu_time\": %"PRId64",\n"
+                   "      \"activations\": %"PRId64",\n"
+                   "      \"frames_in\": %"PRId64",\n"
+                   "      \"frames_out\": %"PRId64",\n"
+                   "      \"inputs\": [",
+                   filter->internal->time, filter->internal->cpu_time,
+                   filter->internal->nb_activations,
+                   frames_in, frames_out);
+        for (j = 0; j < filter->nb_inputs; j++) {
+            AVFilterLink *l = filter->inputs[j];
+
+            av_bprintf(&buf, "%s\n        { \"pad\": ", j ? "," : "");
+            print_json_string(&buf, l->dstpad->name);
+            av_bprintf(&buf, ", \"src\": ");
+            print_json_string(&buf, l->src->name);
+            av_bprintf(&buf, ", \"queued\": %"SIZE_SPECIFIER", "
+                       "\"max_queued\": %"SIZE_SPECIFIER", "
+                       "\"frames\": %"PRId64" }",
+                       ff_framequeue_queued_frames(&l->fifo),
+                       l->fifo.max_queued, l->frame_count_out);
+        }
+        av_bprintf(&buf, "%s]\n    }", filter->nb_inputs ? "\n      " : "");
+    }
+    av_bprintf(&buf, "\n  ]\n}\n");
+
+    if (!av_bprint_is_complete(&buf)) {
+        av_bprint_finalize(&buf, NULL);
+        return NULL;
+    }
+    av_bprint_finalize(&buf, &dump);
+    return dump;
+}
@@ -153,6 +153,15 @@ struct AVFilterGraphInternal {
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+
+    /**
+     * Statistics recorded when AVFilterGraph.instrument is set:
+     * cumulated wall-clock and CPU time spent in activate, in microseconds,
+     * and number of activations.
+     */
+    int64_t time;
+    int64_t cpu_time;
+    int64_t nb_activations;
 };
 
 /**
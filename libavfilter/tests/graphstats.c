@@ -0,0 +1,92 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/error.h"
+#include "libavutil/mem.h"
+#include "libavfilter/avfilter.h"
+
+static const char *graph_desc =
+    "testsrc=size=32x24:rate=25:duration=1,format=gray,split[a][b];"
+    "[a]nullsink;[b]fifo,nullsink";
+
+/* print the statistics, masking the timings which are not reproducible */
+static void print_stats(const char *stats)
+{
+    const char *p = stats;
+
+    while (*p) {
+        const char *eol = strchr(p, '\n');
+        int len = eol ? eol - p + 1 : strlen(p);
+
+        if (!strncmp(p, "      \"time\":", 13))
+            printf("      \"time\": X,\n");
+        else if (!strncmp(p, "      \"cpu_time\":", 17))
+            printf("      \"cpu_time\": X,\n");
+        else
+            printf("%.*s", len, p);
+        p += len;
+    }
+    printf("\n");
+}
+
+int main(void)
+{
+    AVFilterGraph *graph;
+    char *stats;
+    int ret;
+
+    avfilter_register_all();
+
+    graph = avfilter_graph_alloc();
+    if (!graph)
+        return 1;
+    graph->instrument = 1;
+
+    ret = avfilter_graph_parse_ptr(graph, graph_desc, NULL, NULL, NULL);
+    if (ret >= 0)
+        ret = avfilter_graph_config(graph, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "Failed to set up the graph: %s\n", av_err2str(ret));
+        avfilter_graph_free(&graph);
+        return 1;
+    }
+
+    /* the sinks discard the frames, so most requests end with EAGAIN */
+    do {
+        ret = avfilter_graph_request_oldest(graph);
+    } while (ret >= 0 || ret == AVERROR(EAGAIN));
+    if (ret != AVERROR_EOF) {
+        fprintf(stderr, "Error while filtering: %s\n", av_err2str(ret));
+        avfilter_graph_free(&graph);
+        return 1;
+    }
+
+    stats = avfilter_graph_dump_stats(graph);
+    if (!stats) {
+        avfilter_graph_free(&graph);
+        return 1;
+    }
+    print_stats(stats);
+
+    av_free(stats);
+    avfilter_graph_free(&graph);
+    return 0;
+}
@@ -49,14 +49,6 @@ static const uint16_t coef_lf[2] = { 4309, 213 };
 static const uint16_t coef_hf[3] = { 5570, 3801, 1016 };
 static const uint16_t coef_sp[2] = { 5077, 981 };
 
-typedef struct ThreadData {
-    AVFrame *frame;
-    int plane;
-    int w, h;
-    int parity;
-    int tff;
-} ThreadData;
-
 #define FILTER_INTRA() \
     for (x = 0; x < w; x++) { \
         interpol = (coef_sp[0] * (cur[mrefs] + cur[prefs]) - coef_sp[1] * (cur[mrefs3] + cur[prefs3])) >> 13; \
@@ -213,78 +205,136 @@ static void filter_edge_16bit(void *dst1, void *prev1, void *cur1, void *next1,
     FILTER2()
 }
 
-static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+static void filter_plane_slice(BWDIFContext *s, const BWDIFQueuedFrame *q,
+                               int plane, int w, int h, int jobnr, int nb_jobs)
 {
-    BWDIFContext *s = ctx->priv;
-    ThreadData *td  = arg;
-    int linesize = s->cur->linesize[td->plane];
-    int clip_max = (1 << (s->csp->comp[td->plane].depth)) - 1;
-    int df = (s->csp->comp[td->plane].depth + 7) / 8;
+    int linesize = q->cur->linesize[plane];
+    int clip_max = (1 << (s->csp->comp[plane].depth)) - 1;
+    int df = (s->csp->comp[plane].depth + 7) / 8;
     int refs = linesize / df;
-    int slice_start = (td->h *  jobnr   ) / nb_jobs;
-    int slice_end   = (td->h * (jobnr+1)) / nb_jobs;
+    int slice_start = (h *  jobnr   ) / nb_jobs;
+    int slice_end   = (h * (jobnr+1)) / nb_jobs;
     int y;
 
     for (y = slice_start; y < slice_end; y++) {
-        if ((y ^ td->parity) & 1) {
-            uint8_t *prev = &s->prev->data[td->plane][y * linesize];
-            uint8_t *cur  = &s->cur ->data[td->plane][y * linesize];
-            uint8_t *next = &s->next->data[td->plane][y * linesize];
-            uint8_t *dst  = &td->frame->data[td->plane][y * td->frame->linesize[td->plane]];
-            if (!s->inter_field) {
-                s->filter_intra(dst, cur, td->w, (y + df) < td->h ? refs : -refs,
+        if ((y ^ q->parity) & 1) {
+            uint8_t *prev = &q->prev->data[plane][y * linesize];
+            uint8_t *cur  = &q->cur ->data[plane][y * linesize];
+            uint8_t *next = &q->next->data[plane][y * linesize];
+            uint8_t *dst  = &q->out->data[plane][y * q->out->linesize[plane]];
+            if (!q->inter_field) {
+                s->filter_intra(dst, cur, w, (y + df) < h ? refs : -refs,
                                 y > (df - 1) ? -refs : refs,
-                                (y + 3*df) < td->h ? 3 * refs : -refs,
+                                (y + 3*df) < h ? 3 * refs : -refs,
                                 y > (3*df - 1) ? -3 * refs : refs,
-                                td->parity ^ td->tff, clip_max);
-            } else if ((y < 4) || ((y + 5) > td->h)) {
-                s->filter_edge(dst, prev, cur, next, td->w,
-                               (y + df) < td->h ? refs : -refs,
+                                q->parity ^ q->tff, clip_max);
+            } else if ((y < 4) || ((y + 5) > h)) {
+                s->filter_edge(dst, prev, cur, next, w,
+                               (y + df) < h ? refs : -refs,
                                y > (df - 1) ? -refs : refs,
                                refs << 1, -(refs << 1),
-                               td->parity ^ td->tff, clip_max,
-                               (y < 2) || ((y + 3) > td->h) ? 0 : 1);
+                               q->parity ^ q->tff, clip_max,
+                               (y < 2) || ((y + 3) > h) ? 0 : 1);
             } else {
-                s->filter_line(dst, prev, cur, next, td->w,
+                s->filter_line(dst, prev, cur, next, w,
                                refs, -refs, refs << 1, -(refs << 1),
                                3 * refs, -3 * refs, refs << 2, -(refs << 2),
-                               td->parity ^ td->tff, clip_max);
+                               q->parity ^ q->tff, clip_max);
             }
         } else {
-            memcpy(&td->frame->data[td->plane][y * td->frame->linesize[td->plane]],
-                   &s->cur->data[td->plane][y * linesize], td->w * df);
+            memcpy(&q->out->data[plane][y * q->out->linesize[plane]],
+                   &q->cur->data[plane][y * linesize], w * df);
+        }
+    }
+}
+
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BWDIFContext *s = ctx->priv;
+    int i, plane;
+
+    for (i = 0; i < s->nb_queued; i++) {
+        const BWDIFQueuedFrame *q = &s->queued[i];
+
+        for (plane = 0; plane < s->csp->nb_components; plane++) {
+            int w = q->out->width;
+            int h = q->out->height;
+
+            if (plane == 1 || plane == 2) {
+                w = AV_CEIL_RSHIFT(w, s->csp->log2_chroma_w);
+                h = AV_CEIL_RSHIFT(h, s->csp->log2_chroma_h);
+            }
+
+            filter_plane_slice(s, q, plane, w, h, jobnr, nb_jobs);
         }
     }
     return 0;
 }
 
-static void filter(AVFilterContext *ctx, AVFrame *dstpic,
-                   int parity, int tff)
+static void free_queued_frame(BWDIFQueuedFrame *q)
+{
+    av_frame_free(&q->prev);
+    av_frame_free(&q->cur);
+    av_frame_free(&q->next);
+    av_frame_free(&q->out);
+}
+
+/**
+ * Filter all the queued frames with a single call to execute() and send
+ * them in order.
+ */
+static int flush_frames(AVFilterContext *ctx)
 {
     BWDIFContext *bwdif = ctx->priv;
-    ThreadData td = { .frame = dstpic, .parity = parity, .tff = tff };
-    int i;
+    int i, ret = 0;
 
-    for (i = 0; i < bwdif->csp->nb_components; i++) {
-        int w = dstpic->width;
-        int h = dstpic->height;
+    if (!bwdif->nb_queued)
+        return 0;
 
-        if (i == 1 || i == 2) {
-            w = AV_CEIL_RSHIFT(w, bwdif->csp->log2_chroma_w);
-            h = AV_CEIL_RSHIFT(h, bwdif->csp->log2_chroma_h);
+    ctx->internal->execute(ctx, filter_slice, NULL, NULL,
+                           FFMIN(bwdif->queued[0].out->height,
+                                 ff_filter_get_nb_threads(ctx)));
+    emms_c();
+
+    for (i = 0; i < bwdif->nb_queued; i++) {
+        BWDIFQueuedFrame *q = &bwdif->queued[i];
+
+        if (ret >= 0) {
+            ret = ff_filter_frame(ctx->outputs[0], q->out);
+            q->out = NULL;
         }
+        free_queued_frame(q);
+    }
+    bwdif->nb_queued = 0;
 
-        td.w     = w;
-        td.h     = h;
-        td.plane = i;
+    return ret;
+}
 
-        ctx->internal->execute(ctx, filter_slice, &td, NULL, FFMIN(h, ff_filter_get_nb_threads(ctx)));
+static int filter(AVFilterContext *ctx, AVFrame *dstpic,
+                  int parity, int tff)
+{
+    BWDIFContext *bwdif = ctx->priv;
+    BWDIFQueuedFrame *q = &bwdif->queued[bwdif->nb_queued];
+
+    q->out         = dstpic;
+    q->parity      = parity;
+    q->tff         = tff;
+    q->inter_field = bwdif->inter_field;
+    q->prev        = av_frame_clone(bwdif->prev);
+    q->cur         = av_frame_clone(bwdif->cur);
+    q->next        = av_frame_clone(bwdif->next);
+    if (!q->prev || !q->cur || !q->next) {
+        free_queued_frame(q);
+        return AVERROR(ENOMEM);
     }
+
     if (!bwdif->inter_field) {
         bwdif->inter_field = 1;
     }
 
-    emms_c();
+    if (++bwdif->nb_queued < bwdif->batch)
+        return 0;
+    return flush_frames(ctx);
 }
 
 static int return_frame(AVFilterContext *ctx, int is_second)
@@ -311,8 +361,6 @@ static int return_frame(AVFilterContext *ctx, int is_second)
             bwdif->inter_field = 0;
     }
 
-    filter(ctx, bwdif->out, tff ^ !is_second, tff);
-
     if (is_second) {
         int64_t cur_pts  = bwdif->cur->pts;
         int64_t next_pts = bwdif->next->pts;
@@ -323,7 +371,8 @@ static int return_frame(AVFilterContext *ctx, int is_second)
             bwdif->out->pts = AV_NOPTS_VALUE;
         }
     }
-    ret = ff_filter_frame(ctx->outputs[0], bwdif->out);
+    ret = filter(ctx, bwdif->out, tff ^ !is_second, tff);
+    bwdif->out = NULL;
 
     bwdif->frame_pending = (bwdif->mode&1) && !is_second;
     return ret;
@@ -396,6 +445,10 @@ static int filter_frame(AVFilterLink *link, AVFrame *frame)
         (bwdif->deint && !bwdif->prev->interlaced_frame && bwdif->prev->repeat_pict) ||
         (bwdif->deint && !bwdif->next->interlaced_frame && bwdif->next->repeat_pict)
     ) {
+        int ret = flush_frames(ctx);
+        if (ret < 0)
+            return ret;
+
         bwdif->out  = av_frame_clone(bwdif->cur);
         if (!bwdif->out)
             return AVERROR(ENOMEM);
@@ -426,12 +479,18 @@ static int request_frame(AVFilterLink *link)
     int ret;
 
     if (bwdif->frame_pending) {
-        return_frame(ctx, 1);
-        return 0;
+        ret = return_frame(ctx, 1);
+        /* keep requesting input while the batch is not complete */
+        if (ret < 0 || !bwdif->nb_queued)
+            return ret;
+        if (bwdif->eof)
+            return flush_frames(ctx);
     }
 
-    if (bwdif->eof)
-        return AVERROR_EOF;
+    if (bwdif->eof) {
+        ret = flush_frames(ctx);
+        return ret < 0 ? ret : AVERROR_EOF;
+    }
 
     ret  = ff_request_frame(link->src->inputs[0]);
 
@@ -446,6 +505,7 @@ static int request_frame(AVFilterLink *link)
 
         filter_frame(link->src->inputs[0], next);
         bwdif->eof = 1;
+        return flush_frames(ctx);
     } else if (ret < 0) {
         return ret;
     }
@@ -456,10 +516,15 @@ static int request_frame(AVFilterLink *link)
 static av_cold void uninit(AVFilterContext *ctx)
 {
     BWDIFContext *bwdif = ctx->priv;
+    int i;
 
     av_frame_free(&bwdif->prev);
     av_frame_free(&bwdif->cur );
     av_frame_free(&bwdif->next);
+
+    for (i = 0; i < bwdif->nb_queued; i++)
+        free_queued_frame(&bwdif->queued[i]);
+    av_freep(&bwdif->queued);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -510,6 +575,12 @@ static int config_props(AVFilterLink *link)
         return AVERROR(EINVAL);
     }
 
+    av_freep(&s->queued);
+    s->nb_queued = 0;
+    s->queued = av_calloc(s->batch, sizeof(*s->queued));
+    if (!s->queued)
+        return AVERROR(ENOMEM);
+
     s->csp = av_pix_fmt_desc_get(link->format);
     if (s->csp->comp[0].depth > 8) {
         s->filter_intra = filter_intra_16bit;
@@ -547,6 +618,8 @@ static const AVOption bwdif_options[] = {
     CONST("all",        "deinterlace all frames",                       BWDIF_DEINT_ALL,        "deint"),
     CONST("interlaced", "only deinterlace frames marked as interlaced", BWDIF_DEINT_INTERLACED, "deint"),
 
+    { "batch", "set the number of output frames filtered together", OFFSET(batch), AV_OPT_TYPE_INT, {.i64=1}, 1, 64, FLAGS },
+
     { NULL }
 };
 
@@ -25,6 +25,7 @@
 
 #include "libavutil/opt.h"
 #include "libavutil/file.h"
+#include "libavutil/imgutils.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/avassert.h"
 #include "libavutil/pixdesc.h"
@@ -35,6 +36,7 @@
 #include "framesync2.h"
 #include "internal.h"
 #include "video.h"
+#include "vf_lut3d.h"
 
 #define R 0
 #define G 1
@@ -52,9 +54,8 @@ struct rgbvec {
     float r, g, b;
 };
 
-/* 3D LUT don't often go up to level 32, but it is common to have a Hald CLUT
- * of 512x512 (64x64x64) */
-#define MAX_LEVEL 64
+#define MAX_LEVEL LUT3D_MAX_LEVEL
+#define MAX_1D_LEVEL 65536
 
 typedef struct LUT3DContext {
     const AVClass *class;
@@ -63,12 +64,23 @@ typedef struct LUT3DContext {
     uint8_t rgba_map[4];
     int step;
     avfilter_action_func *interp;
+    void (*interp_row)(float *r, float *g, float *b, int w,
+                       const float *lut, int lutsize);
+    LUT3DDSPContext dsp;
     struct rgbvec lut[MAX_LEVEL][MAX_LEVEL][MAX_LEVEL];
     int lutsize;
+    float *prelut;              ///< 1D shaper, r, g and b arrays of prelut_size entries
+    int prelut_size;
+    float prelut_range[2];      ///< input range of the shaper
+    float lut_range[2];         ///< input range of the 3D LUT
+    float *coord_tab;           ///< LUT coordinates of every input value, for each component
+    float *rowbuf;              ///< r, g and b rows of each job, of rowbuf_stride floats
+    int rowbuf_stride;
 #if CONFIG_HALDCLUT_FILTER
     uint8_t clut_rgba_map[4];
     int clut_step;
-    int clut_is16bit;
+    int clut_bits;
+    int clut_planar;
     int clut_width;
     FFFrameSync fs;
 #endif
@@ -102,35 +114,37 @@ static inline struct rgbvec lerp(const struct rgbvec *v0, const struct rgbvec *v
 
 #define NEAR(x) ((int)((x) + .5))
 #define PREV(x) ((int)(x))
-#define NEXT(x) (FFMIN((int)(x) + 1, lut3d->lutsize - 1))
+#define NEXT(x) (FFMIN((int)(x) + 1, lutsize - 1))
 
 /**
  * Get the nearest defined point
  */
-static inline struct rgbvec interp_nearest(const LUT3DContext *lut3d,
+static inline struct rgbvec interp_nearest(const struct rgbvec (*lut)[MAX_LEVEL][MAX_LEVEL],
+                                           int lutsize,
                                            const struct rgbvec *s)
 {
-    return lut3d->lut[NEAR(s->r)][NEAR(s->g)][NEAR(s->b)];
+    return lut[NEAR(s->r)][NEAR(s->g)][NEAR(s->b)];
 }
 
 /**
  * Interpolate using the 8 vertices of a cube
  * @see https://en.wikipedia.org/wiki/Trilinear_interpolation
  */
-static inline struct rgbvec interp_trilinear(const LUT3DContext *lut3d,
+static inline struct rgbvec interp_trilinear(const struct rgbvec (*lut)[MAX_LEVEL][MAX_LEVEL],
+                                             int lutsize,
                                              const struct rgbvec *s)
 {
     const int prev[] = {PREV(s->r), PREV(s->g), PREV(s->b)};
     const int next[] = {NEXT(s->r), NEXT(s->g), NEXT(s->b)};
     const struct rgbvec d = {s->r - prev[0], s->g - prev[1], s->b - prev[2]};
-    const struct rgbvec c000 = lut3d->lut[prev[0]][prev[1]][prev[2]];
-    const struct rgbvec c001 = lut3d->lut[prev[0]][prev[1]][next[2]];
-    const struct rgbvec c010 = lut3d->lut[prev[0]][next[1]][prev[2]];
-    const struct rgbvec c011 = lut3d->lut[prev[0]][next[1]][next[2]];
-    const struct rgbvec c100 = lut3d->lut[next[0]][prev[1]][prev[2]];
-    const struct rgbvec c101 = lut3d->lut[next[0]][prev[1]][next[2]];
-    const struct rgbvec c110 = lut3d->lut[next[0]][next[1]][prev[2]];
-    const struct rgbvec c111 = lut3d->lut[next[0]][next[1]][next[2]];
+    const struct rgbvec c000 = lut[prev[0]][prev[1]][prev[2]];
+    const struct rgbvec c001 = lut[prev[0]][prev[1]][next[2]];
+    const struct rgbvec c010 = lut[prev[0]][next[1]][prev[2]];
+    const struct rgbvec c011 = lut[prev[0]][next[1]][next[2]];
+    const struct rgbvec c100 = lut[next[0]][prev[1]][prev[2]];
+    const struct rgbvec c101 = lut[next[0]][prev[1]][next[2]];
+    const struct rgbvec c110 = lut[next[0]][next[1]][prev[2]];
+    const struct rgbvec c111 = lut[next[0]][next[1]][next[2]];
     const struct rgbvec c00  = lerp(&c000, &c100, d.r);
     const struct rgbvec c10  = lerp(&c010, &c110, d.r);
     const struct rgbvec c01  = lerp(&c001, &c101, d.r);
@@ -145,51 +159,52 @@ static inline struct rgbvec interp_trilinear(const LUT3DContext *lut3d,
  * Tetrahedral interpolation. Based on code found in Truelight Software Library paper.
  * @see http://www.filmlight.ltd.uk/pdf/whitepapers/FL-TL-TN-0057-SoftwareLib.pdf
  */
-static inline struct rgbvec interp_tetrahedral(const LUT3DContext *lut3d,
+static inline struct rgbvec interp_tetrahedral(const struct rgbvec (*lut)[MAX_LEVEL][MAX_LEVEL],
+                                               int lutsize,
                                                const struct rgbvec *s)
 {
     const int prev[] = {PREV(s->r), PREV(s->g), PREV(s->b)};
     const int next[] = {NEXT(s->r), NEXT(s->g), NEXT(s->b)};
     const struct rgbvec d = {s->r - prev[0], s->g - prev[1], s->b - prev[2]};
-    const struct rgbvec c000 = lut3d->lut[prev[0]][prev[1]][prev[2]];
-    const struct rgbvec c111 = lut3d->lut[next[0]][next[1]][next[2]];
+    const struct rgbvec c000 = lut[prev[0]][prev[1]][prev[2]];
+    const struct rgbvec c111 = lut[next[0]][next[1]][next[2]];
     struct rgbvec c;
     if (d.r > d.g) {
         if (d.g > d.b) {
-            const struct rgbvec c100 = lut3d->lut[next[0]][prev[1]][prev[2]];
-            const struct rgbvec c110 = lut3d->lut[next[0]][next[1]][prev[2]];
+            const struct rgbvec c100 = lut[next[0]][prev[1]][prev[2]];
+            const struct rgbvec c110 = lut[next[0]][next[1]][prev[2]];
             c.r = (1-d.r) * c000.r + (d.r-d.g) * c100.r + (d.g-d.b) * c110.r + (d.b) * c111.r;
             c.g = (1-d.r) * c000.g + (d.r-d.g) * c100.g + (d.g-d.b) * c110.g + (d.b) * c111.g;
             c.b = (1-d.r) * c000.b + (d.r-d.g) * c100.b + (d.g-d.b) * c110.b + (d.b) * c111.b;
         } else if (d.r > d.b) {
-            const struct rgbvec c100 = lut3d->lut[next[0]][prev[1]][prev[2]];
-            const struct rgbvec c101 = lut3d->lut[next[0]][prev[1]][next[2]];
+            const struct rgbvec c100 = lut[next[0]][prev[1]][prev[2]];
+            const struct rgbvec c101 = lut[next[0]][prev[1]][next[2]];
             c.r = (1-d.r) * c000.r + (d.r-d.b) * c100.r + (d.b-d.g) * c101.r + (d.g) * c111.r;
             c.g = (1-d.r) * c000.g + (d.r-d.b) * c100.g + (d.b-d.g) * c101.g + (d.g) * c111.g;
             c.b = (1-d.r) * c000.b + (d.r-d.b) * c100.b + (d.b-d.g) * c101.b + (d.g) * c111.b;
         } else {
-            const struct rgbvec c001 = lut3d->lut[prev[0]][prev[1]][next[2]];
-            const struct rgbvec c101 = lut3d->lut[next[0]][prev[1]][next[2]];
+            const struct rgbvec c001 = lut[prev[0]][prev[1]][next[2]];
+            const struct rgbvec c101 = lut[next[0]][prev[1]][next[2]];
             c.r = (1-d.b) * c000.r + (d.b-d.r) * c001.r + (d.r-d.g) * c101.r + (d.g) * c111.r;
             c.g = (1-d.b) * c000.g + (d.b-d.r) * c001.g + (d.r-d.g) * c101.g + (d.g) * c111.g;
             c.b = (1-d.b) * c000.b + (d.b-d.r) * c001.b + (d.r-d.g) * c101.b + (d.g) * c111.b;
         }
     } else {
         if (d.b > d.g) {
-            const struct rgbvec c001 = lut3d->lut[prev[0]][prev[1]][next[2]];
-            const struct rgbvec c011 = lut3d->lut[prev[0]][next[1]][next[2]];
+            const struct rgbvec c001 = lut[prev[0]][prev[1]][next[2]];
+            const struct rgbvec c011 = lut[prev[0]][next[1]][next[2]];
             c.r = (1-d.b) * c000.r + (d.b-d.g) * c001.r + (d.g-d.r) * c011.r + (d.r) * c111.r;
             c.g = (1-d.b) * c000.g + (d.b-d.g) * c001.g + (d.g-d.r) * c011.g + (d.r) * c111.g;
             c.b = (1-d.b) * c000.b + (d.b-d.g) * c001.b + (d.g-d.r) * c011.b + (d.r) * c111.b;
         } else if (d.b > d.r) {
-            const struct rgbvec c010 = lut3d->lut[prev[0]][next[1]][prev[2]];
-            const struct rgbvec c011 = lut3d->lut[prev[0]][next[1]][next[2]];
+            const struct rgbvec c010 = lut[prev[0]][next[1]][prev[2]];
+            const struct rgbvec c011 = lut[prev[0]][next[1]][next[2]];
             c.r = (1-d.g) * c000.r + (d.g-d.b) * c010.r + (d.b-d.r) * c011.r + (d.r) * c111.r;
             c.g = (1-d.g) * c000.g + (d.g-d.b) * c010.g + (d.b-d.r) * c011.g + (d.r) * c111.g;
             c.b = (1-d.g) * c000.b + (d.g-d.b) * c010.b + (d.b-d.r) * c011.b + (d.r) * c111.b;
         } else {
-            const struct rgbvec c010 = lut3d->lut[prev[0]][next[1]][prev[2]];
-            const struct rgbvec c110 = lut3d->lut[next[0]][next[1]][prev[2]];
+            const struct rgbvec c010 = lut[prev[0]][next[1]][prev[2]];
+            const struct rgbvec c110 = lut[next[0]][next[1]][prev[2]];
             c.r = (1-d.g) * c000.r + (d.g-d.r) * c010.r + (d.r-d.b) * c110.r + (d.b) * c111.r;
             c.g = (1-d.g) * c000.g + (d.g-d.r) * c010.g + (d.r-d.b) * c110.g + (d.b) * c111.g;
             c.b = (1-d.g) * c000.b + (d.g-d.r) * c010.b + (d.r-d.b) * c110.b + (d.b) * c111.b;
@@ -198,8 +213,54 @@ static inline struct rgbvec interp_tetrahedral(const LUT3DContext *lut3d,
     return c;
 }
 
-#define DEFINE_INTERP_FUNC(name, nbits)                                                             \
-static int interp_##nbits##_##name(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)         \
+#define DEFINE_INTERP_ROW(name)                                                                     \
+static void interp_row_##name##_c(float *r, float *g, float *b, int w,                              \
+                                  const float *lut, int lutsize)                                    \
+{                                                                                                   \
+    const struct rgbvec (*cube)[MAX_LEVEL][MAX_LEVEL] = (const void *)lut;                          \
+    int x;                                                                                          \
+                                                                                                    \
+    for (x = 0; x < w; x++) {                                                                       \
+        const struct rgbvec s = {r[x], g[x], b[x]};                                                 \
+        const struct rgbvec vec = interp_##name(cube, lutsize, &s);                                 \
+        r[x] = vec.r;                                                                               \
+        g[x] = vec.g;                                                                               \
+        b[x] = vec.b;                                                                               \
+    }                                                                                               \
+}
+
+DEFINE_INTERP_ROW(nearest)
+DEFINE_INTERP_ROW(trilinear)
+DEFINE_INTERP_ROW(tetrahedral)
+
+av_cold void ff_lut3d_dsp_init(LUT3DDSPContext *dsp)
+{
+    dsp->interp_trilinear   = interp_row_trilinear_c;
+    dsp->interp_tetrahedral = interp_row_tetrahedral_c;
+
+    if (ARCH_X86)
+        ff_lut3d_dsp_init_x86(dsp);
+}
+
+/**
+ * Interpolate the w points of the r, g and b rows of a job, which hold
+ * their LUT coordinates.
+ */
+static inline void interp_row(const LUT3DContext *lut3d,
+                              float *r, float *g, float *b, int w)
+{
+    int x;
+
+    /* the padding is processed by the SIMD versions */
+    for (x = w; x < lut3d->rowbuf_stride; x++)
+        r[x] = g[x] = b[x] = 0;
+    lut3d->interp_row(r, g, b, w, &lut3d->lut[0][0][0].r, lut3d->lutsize);
+}
+
+/* Each row is converted to LUT coordinates, interpolated as a whole, then
+ * converted back. */
+#define DEFINE_INTERP_FUNC_PACKED(nbits)                                                            \
+static int interp_##nbits(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)                  \
 {                                                                                                   \
     int x, y;                                                                                       \
     const LUT3DContext *lut3d = ctx->priv;                                                          \
@@ -208,6 +269,7 @@ static int interp_##nbits##_##name(AVFilterContext *ctx, void *arg, int jobnr, i
     const AVFrame *out = td->out;                                                                   \
     const int direct = out == in;                                                                   \
     const int step = lut3d->step;                                                                   \
+    const int w = in->width;                                                                        \
     const uint8_t r = lut3d->rgba_map[R];                                                           \
     const uint8_t g = lut3d->rgba_map[G];                                                           \
     const uint8_t b = lut3d->rgba_map[B];                                                           \
@@ -217,20 +279,34 @@ static int interp_##nbits##_##name(AVFilterContext *ctx, void *arg, int jobnr, i
     uint8_t       *dstrow = out->data[0] + slice_start * out->linesize[0];                          \
     const uint8_t *srcrow = in ->data[0] + slice_start * in ->linesize[0];                          \
     const float scale = (1. / ((1<<nbits) - 1)) * (lut3d->lutsize - 1);                             \
+    const float *tab = lut3d->coord_tab;                                                            \
+    float *rrow = lut3d->rowbuf + jobnr * 3 * lut3d->rowbuf_stride;                                 \
+    float *grow = rrow + lut3d->rowbuf_stride;                                                      \
+    float *brow = grow + lut3d->rowbuf_stride;                                                      \
                                                                                                     \
     for (y = slice_start; y < slice_end; y++) {                                                     \
         uint##nbits##_t *dst = (uint##nbits##_t *)dstrow;                                           \
         const uint##nbits##_t *src = (const uint##nbits##_t *)srcrow;                               \
-        for (x = 0; x < in->width * step; x += step) {                                              \
-            const struct rgbvec scaled_rgb = {src[x + r] * scale,                                   \
-                                              src[x + g] * scale,                                   \
-                                              src[x + b] * scale};                                  \
-            struct rgbvec vec = interp_##name(lut3d, &scaled_rgb);                                  \
-            dst[x + r] = av_clip_uint##nbits(vec.r * (float)((1<<nbits) - 1));                      \
-            dst[x + g] = av_clip_uint##nbits(vec.g * (float)((1<<nbits) - 1));                      \
-            dst[x + b] = av_clip_uint##nbits(vec.b * (float)((1<<nbits) - 1));                      \
+        if (tab) {                                                                                  \
+            for (x = 0; x < w; x++) {                                                               \
+                rrow[x] = tab[                  src[x * step + r]];                                 \
+                grow[x] = tab[     (1<<nbits) + src[x * step + g]];                                 \
+                brow[x] = tab[2 * (1<<nbits)  + src[x * step + b]];                                 \
+            }                                                                                       \
+        } else {                                                                                    \
+            for (x = 0; x < w; x++) {                                                               \
+                rrow[x] = src[x * step + r] * scale;                                                \
+                grow[x] = src[x * step + g] * scale;                                                \
+                brow[x] = src[x * step + b] * scale;                                                \
+            }                                                                                       \
+        }                                                                                           \
+        interp_row(lut3d, rrow, grow, brow, w);                                                     \
+        for (x = 0; x < w; x++) {                                                                   \
+            dst[x * step + r] = av_clip_uint##nbits(rrow[x] * (float)((1<<nbits) - 1));             \
+            dst[x * step + g] = av_clip_uint##nbits(grow[x] * (float)((1<<nbits) - 1));             \
+            dst[x * step + b] = av_clip_uint##nbits(brow[x] * (float)((1<<nbits) - 1));             \
             if (!direct && step == 4)                                                               \
-                dst[x + a] = src[x + a];                                                            \
+                dst[x * step + a] = src[x * step + a];                                              \
         }                                                                                           \
         dstrow += out->linesize[0];                                                                 \
         srcrow += in ->linesize[0];                                                                 \
@@ -238,13 +314,79 @@ static int interp_##nbits##_##name(AVFilterContext *ctx, void *arg, int jobnr, i
     return 0;                                                                                       \
 }
 
-DEFINE_INTERP_FUNC(nearest,     8)
-DEFINE_INTERP_FUNC(trilinear,   8)
-DEFINE_INTERP_FUNC(tetrahedral, 8)
+DEFINE_INTERP_FUNC_PACKED(8)
+DEFINE_INTERP_FUNC_PACKED(16)
+
+#define DEFINE_INTERP_FUNC_PLANAR(nbits, depth)                                                     \
+static int interp_planar_##depth(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)           \
+{                                                                                                   \
+    int x, y;                                                                                       \
+    const LUT3DContext *lut3d = ctx->priv;                                                          \
+    const ThreadData *td = arg;                                                                     \
+    const AVFrame *in  = td->in;                                                                    \
+    const AVFrame *out = td->out;                                                                   \
+    const int direct = out == in;                                                                   \
+    const int w = in->width;                                                                        \
+    const int slice_start = (in->height *  jobnr   ) / nb_jobs;                                     \
+    const int slice_end   = (in->height * (jobnr+1)) / nb_jobs;                                     \
+    uint8_t *grow_dst = out->data[0] + slice_start * out->linesize[0];                              \
+    uint8_t *brow_dst = out->data[1] + slice_start * out->linesize[1];                              \
+    uint8_t *rrow_dst = out->data[2] + slice_start * out->linesize[2];                              \
+    const uint8_t *grow_src = in->data[0] + slice_start * in->linesize[0];                          \
+    const uint8_t *brow_src = in->data[1] + slice_start * in->linesize[1];                          \
+    const uint8_t *rrow_src = in->data[2] + slice_start * in->linesize[2];                          \
+    const float scale = (1. / ((1<<depth) - 1)) * (lut3d->lutsize - 1);                             \
+    const float *tab = lut3d->coord_tab;                                                            \
+    float *rrow = lut3d->rowbuf + jobnr * 3 * lut3d->rowbuf_stride;                                 \
+    float *grow = rrow + lut3d->rowbuf_stride;                                                      \
+    float *brow = grow + lut3d->rowbuf_stride;                                                      \
+                                                                                                    \
+    for (y = slice_start; y < slice_end; y++) {                                                     \
+        uint##nbits##_t *dstg = (uint##nbits##_t *)grow_dst;                                        \
+        uint##nbits##_t *dstb = (uint##nbits##_t *)brow_dst;                                        \
+        uint##nbits##_t *dstr = (uint##nbits##_t *)rrow_dst;                                        \
+        const uint##nbits##_t *srcg = (const uint##nbits##_t *)grow_src;                            \
+        const uint##nbits##_t *srcb = (const uint##nbits##_t *)brow_src;                            \
+        const uint##nbits##_t *srcr = (const uint##nbits##_t *)rrow_src;                            \
+        if (tab) {                                                                                  \
+            for (x = 0; x < w; x++) {                                                               \
+                rrow[x] = tab[                  srcr[x]];                                           \
+                grow[x] = tab[     (1<<depth) + srcg[x]];                                           \
+                brow[x] = tab[2 * (1<<depth)  + srcb[x]];                                           \
+            }                                                                                       \
+        } else {                                                                                    \
+            for (x = 0; x < w; x++) {                                                               \
+                rrow[x] = srcr[x] * scale;                                                          \
+                grow[x] = srcg[x] * scale;                                                          \
+                brow[x] = srcb[x] * scale;                                                          \
+            }                                                                                       \
+        }                                                                                           \
+        interp_row(lut3d, rrow, grow, brow, w);                                                     \
+        for (x = 0; x < w; x++) {                                                                   \
+            dstr[x] = av_clip_uintp2(rrow[x] * (float)((1<<depth) - 1), depth);                     \
+            dstg[x] = av_clip_uintp2(grow[x] * (float)((1<<depth) - 1), depth);                     \
+            dstb[x] = av_clip_uintp2(brow[x] * (float)((1<<depth) - 1), depth);                     \
+        }                                                                                           \
+        grow_dst += out->linesize[0];                                                               \
+        brow_dst += out->linesize[1];                                                               \
+        rrow_dst += out->linesize[2];                                                               \
+        grow_src += in->linesize[0];                                                                \
+        brow_src += in->linesize[1];                                                                \
+        rrow_src += in->linesize[2];                                                                \
+    }                                                                                               \
+    if (!direct && in->data[3])                                                                     \
+        av_image_copy_plane(out->data[3] + slice_start * out->linesize[3], out->linesize[3],        \
+                            in->data[3] + slice_start * in->linesize[3], in->linesize[3],           \
+                            w * sizeof(uint##nbits##_t), slice_end - slice_start);                  \
+    return 0;                                                                                       \
+}
 
-DEFINE_INTERP_FUNC(nearest,     16)
-DEFINE_INTERP_FUNC(trilinear,   16)
-DEFINE_INTERP_FUNC(tetrahedral, 16)
+DEFINE_INTERP_FUNC_PLANAR(8,   8)
+DEFINE_INTERP_FUNC_PLANAR(16,  9)
+DEFINE_INTERP_FUNC_PLANAR(16, 10)
+DEFINE_INTERP_FUNC_PLANAR(16, 12)
+DEFINE_INTERP_FUNC_PLANAR(16, 14)
+DEFINE_INTERP_FUNC_PLANAR(16, 16)
 
 #define MAX_LINE_SIZE 512
 
@@ -296,53 +438,133 @@ static int parse_dat(AVFilterContext *ctx, FILE *f)
     return 0;
 }
 
-/* Iridas format */
+static int parse_range(AVFilterContext *ctx, const char *p, float *range)
+{
+    if (sscanf(p, "%f %f", range, range + 1) != 2 || range[1] <= range[0]) {
+        av_log(ctx, AV_LOG_ERROR, "Invalid input range\n");
+        return AVERROR_INVALIDDATA;
+    }
+    return 0;
+}
+
+/* DOMAIN_MIN/MAX keyword, which may appear anywhere before or between the
+ * values; returns 1 if the line was one */
+static int parse_cube_domain(AVFilterContext *ctx, const char *p,
+                             float *min, float *max)
+{
+    float *vals = NULL;
+
+    while (av_isspace(*p))
+        p++;
+    if (strncmp(p, "DOMAIN_", 7))
+        return 0;
+    if      (!strncmp(p + 7, "MIN ", 4)) vals = min;
+    else if (!strncmp(p + 7, "MAX ", 4)) vals = max;
+    if (!vals)
+        return AVERROR_INVALIDDATA;
+    sscanf(p + 11, "%f %f %f", vals, vals + 1, vals + 2);
+    av_log(ctx, AV_LOG_DEBUG, "min: %f %f %f | max: %f %f %f\n",
+           min[0], min[1], min[2], max[0], max[1], max[2]);
+    return 1;
+}
+
+/* read the next line of values, skipping comments and DOMAIN_ keywords */
+static int next_cube_line(AVFilterContext *ctx, FILE *f, char *line,
+                          float *min, float *max)
+{
+    int ret;
+
+    do {
+        if (!fgets(line, MAX_LINE_SIZE, f)) {
+            av_log(ctx, AV_LOG_ERROR, "Unexpected EOF\n");
+            return AVERROR_INVALIDDATA;
+        }
+        if ((ret = parse_cube_domain(ctx, line, min, max)) < 0)
+            return ret;
+    } while (ret || skip_line(line));
+    return 0;
+}
+
+/* Iridas format, with the optional 1D shaper of the Resolve flavour: the
+ * LUT_1D_SIZE entries of the shaper come first, then the 3D LUT */
 static int parse_cube(AVFilterContext *ctx, FILE *f)
 {
     LUT3DContext *lut3d = ctx->priv;
     char line[MAX_LINE_SIZE];
     float min[3] = {0.0, 0.0, 0.0};
     float max[3] = {1.0, 1.0, 1.0};
+    int i, j, k, ret, size = 0, size1d = 0;
 
-    while (fgets(line, sizeof(line), f)) {
-        if (!strncmp(line, "LUT_3D_SIZE ", 12)) {
-            int i, j, k;
-            const int size = strtol(line + 12, NULL, 0);
+    /* keywords, up to the first line of values */
+    for (;;) {
+        const char *p = line;
 
+        NEXT_LINE(skip_line(line));
+        while (av_isspace(*p))
+            p++;
+        if (av_isdigit(*p) || *p == '-' || *p == '+' || *p == '.')
+            break;
+        if (!strncmp(p, "LUT_3D_SIZE ", 12)) {
+            size = strtol(p + 12, NULL, 0);
             if (size < 2 || size > MAX_LEVEL) {
                 av_log(ctx, AV_LOG_ERROR, "Too large or invalid 3D LUT size\n");
                 return AVERROR(EINVAL);
             }
-            lut3d->lutsize = size;
-            for (k = 0; k < size; k++) {
-                for (j = 0; j < size; j++) {
-                    for (i = 0; i < size; i++) {
-                        struct rgbvec *vec = &lut3d->lut[i][j][k];
-
-                        do {
-try_again:
-                            NEXT_LINE(0);
-                            if (!strncmp(line, "DOMAIN_", 7)) {
-                                float *vals = NULL;
-                                if      (!strncmp(line + 7, "MIN ", 4)) vals = min;
-                                else if (!strncmp(line + 7, "MAX ", 4)) vals = max;
-                                if (!vals)
-                                    return AVERROR_INVALIDDATA;
-                                sscanf(line + 11, "%f %f %f", vals, vals + 1, vals + 2);
-                                av_log(ctx, AV_LOG_DEBUG, "min: %f %f %f | max: %f %f %f\n",
-                                       min[0], min[1], min[2], max[0], max[1], max[2]);
-                                goto try_again;
-                            }
-                        } while (skip_line(line));
-                        if (sscanf(line, "%f %f %f", &vec->r, &vec->g, &vec->b) != 3)
-                            return AVERROR_INVALIDDATA;
-                        vec->r *= max[0] - min[0];
-                        vec->g *= max[1] - min[1];
-                        vec->b *= max[2] - min[2];
-                    }
-                }
+        } else if (!strncmp(p, "LUT_1D_SIZE ", 12)) {
+            size1d = strtol(p + 12, NULL, 0);
+            if (size1d < 2 || size1d > MAX_1D_LEVEL) {
+                av_log(ctx, AV_LOG_ERROR, "Too large or invalid 1D LUT size\n");
+                return AVERROR(EINVAL);
+            }
+        } else if (!strncmp(p, "LUT_1D_INPUT_RANGE ", 19)) {
+            if ((ret = parse_range(ctx, p + 19, lut3d->prelut_range)) < 0)
+                return ret;
+        } else if (!strncmp(p, "LUT_3D_INPUT_RANGE ", 19)) {
+            if ((ret = parse_range(ctx, p + 19, lut3d->lut_range)) < 0)
+                return ret;
+        } else if ((ret = parse_cube_domain(ctx, p, min, max)) < 0) {
+            return ret;
+        }
+    }
+
+    if (!size) {
+        av_log(ctx, AV_LOG_ERROR, "Missing LUT_3D_SIZE\n");
+        return AVERROR_INVALIDDATA;
+    }
+
+    if (size1d) {
+        float *prelut = av_malloc_array(3 * size1d, sizeof(*prelut));
+        if (!prelut)
+            return AVERROR(ENOMEM);
+        av_freep(&lut3d->prelut);
+        lut3d->prelut      = prelut;
+        lut3d->prelut_size = size1d;
+        for (i = 0; i < size1d; i++) {
+            if (i && (ret = next_cube_line(ctx, f, line, min, max)) < 0)
+                return ret;
+            if (sscanf(line, "%f %f %f", &prelut[i], &prelut[size1d + i],
+                       &prelut[2 * size1d + i]) != 3)
+                return AVERROR_INVALIDDATA;
+        }
+        if ((ret = next_cube_line(ctx, f, line, min, max)) < 0)
+            return ret;
+    }
+
+    lut3d->lutsize = size;
+    for (k = 0; k < size; k++) {
+        for (j = 0; j < size; j++) {
+            for (i = 0; i < size; i++) {
+                struct rgbvec *vec = &lut3d->lut[i][j][k];
+
+                if ((k != 0 || j != 0 || i != 0) &&
+                    (ret = next_cube_line(ctx, f, line, min, max)) < 0)
+                    return ret;
+                if (sscanf(line, "%f %f %f", &vec->r, &vec->g, &vec->b) != 3)
+                    return AVERROR_INVALIDDATA;
+                vec->r *= max[0] - min[0];
+                vec->g *= max[1] - min[1];
+                vec->b *= max[2] - min[2];
             }
-            break;
         }
     }
     return 0;
@@ -470,6 +692,12 @@ static int query_formats(AVFilterContext *ctx)
         AV_PIX_FMT_RGB0,   AV_PIX_FMT_BGR0,
         AV_PIX_FMT_RGB48,  AV_PIX_FMT_BGR48,
         AV_PIX_FMT_RGBA64, AV_PIX_FMT_BGRA64,
+        AV_PIX_FMT_GBRP,   AV_PIX_FMT_GBRAP,
+        AV_PIX_FMT_GBRP9,
+        AV_PIX_FMT_GBRP10, AV_PIX_FMT_GBRAP10,
+        AV_PIX_FMT_GBRP12, AV_PIX_FMT_GBRAP12,
+        AV_PIX_FMT_GBRP14,
+        AV_PIX_FMT_GBRP16, AV_PIX_FMT_GBRAP16,
         AV_PIX_FMT_NONE
     };
     AVFilterFormats *fmts_list = ff_make_format_list(pix_fmts);
@@ -478,36 +706,97 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_formats(ctx, fmts_list);
 }
 
-static int config_input(AVFilterLink *inlink)
+/**
+ * Map every input value of each component to its LUT coordinate, through
+ * the 1D shaper and the input ranges.
+ */
+static int init_coord_tab(AVFilterContext *ctx, int depth)
 {
-    int is16bit = 0;
-    LUT3DContext *lut3d = inlink->dst->priv;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+    LUT3DContext *lut3d = ctx->priv;
+    const int max = (1 << depth) - 1;
+    const float lut_max = lut3d->lutsize - 1;
+    int i, c;
+
+    av_freep(&lut3d->coord_tab);
+    lut3d->coord_tab = av_malloc_array(3 << depth, sizeof(*lut3d->coord_tab));
+    if (!lut3d->coord_tab)
+        return AVERROR(ENOMEM);
 
-    switch (inlink->format) {
-    case AV_PIX_FMT_RGB48:
-    case AV_PIX_FMT_BGR48:
-    case AV_PIX_FMT_RGBA64:
-    case AV_PIX_FMT_BGRA64:
-        is16bit = 1;
+    for (c = 0; c < 3; c++) {
+        float *tab = lut3d->coord_tab + (c << depth);
+
+        for (i = 0; i <= max; i++) {
+            float v = i / (float)max;
+
+            if (lut3d->prelut) {
+                const float *prelut = lut3d->prelut + c * lut3d->prelut_size;
+                const float size_max = lut3d->prelut_size - 1;
+                const float x = av_clipf((v - lut3d->prelut_range[0]) /
+                                         (lut3d->prelut_range[1] - lut3d->prelut_range[0]) *
+                                         size_max, 0, size_max);
+                const int prev = PREV(x);
+                const int next = FFMIN(prev + 1, lut3d->prelut_size - 1);
+
+                v = lerpf(prelut[prev], prelut[next], x - prev);
+            }
+            tab[i] = av_clipf((v - lut3d->lut_range[0]) /
+                              (lut3d->lut_range[1] - lut3d->lut_range[0]) *
+                              lut_max, 0, lut_max);
+        }
     }
+    return 0;
+}
 
-    ff_fill_rgba_map(lut3d->rgba_map, inlink->format);
-    lut3d->step = av_get_padded_bits_per_pixel(desc) >> (3 + is16bit);
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    LUT3DContext *lut3d = ctx->priv;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+    const int depth = desc->comp[0].depth;
+    const int planar = desc->flags & AV_PIX_FMT_FLAG_PLANAR;
+    const int nb_threads = ff_filter_get_nb_threads(ctx);
+    int ret;
 
-#define SET_FUNC(name) do {                             \
-    if (is16bit) lut3d->interp = interp_16_##name;      \
-    else         lut3d->interp = interp_8_##name;       \
-} while (0)
+    ff_fill_rgba_map(lut3d->rgba_map, inlink->format);
+    lut3d->step = av_get_padded_bits_per_pixel(desc) >> (3 + (depth > 8));
+
+    if (planar) {
+        switch (depth) {
+        case  8: lut3d->interp = interp_planar_8;  break;
+        case  9: lut3d->interp = interp_planar_9;  break;
+        case 10: lut3d->interp = interp_planar_10; break;
+        case 12: lut3d->interp = interp_planar_12; break;
+        case 14: lut3d->interp = interp_planar_14; break;
+        case 16: lut3d->interp = interp_planar_16; break;
+        default:
+            av_assert0(0);
+        }
+    } else {
+        lut3d->interp = depth > 8 ? interp_16 : interp_8;
+    }
 
+    ff_lut3d_dsp_init(&lut3d->dsp);
     switch (lut3d->interpolation) {
-    case INTERPOLATE_NEAREST:     SET_FUNC(nearest);        break;
-    case INTERPOLATE_TRILINEAR:   SET_FUNC(trilinear);      break;
-    case INTERPOLATE_TETRAHEDRAL: SET_FUNC(tetrahedral);    break;
+    case INTERPOLATE_NEAREST:     lut3d->interp_row = interp_row_nearest_c;         break;
+    case INTERPOLATE_TRILINEAR:   lut3d->interp_row = lut3d->dsp.interp_trilinear;   break;
+    case INTERPOLATE_TETRAHEDRAL: lut3d->interp_row = lut3d->dsp.interp_tetrahedral; break;
     default:
         av_assert0(0);
     }
 
+    av_freep(&lut3d->coord_tab);
+    if (lut3d->prelut || lut3d->lut_range[0] != 0.f || lut3d->lut_range[1] != 1.f) {
+        if ((ret = init_coord_tab(ctx, depth)) < 0)
+            return ret;
+    }
+
+    av_freep(&lut3d->rowbuf);
+    lut3d->rowbuf_stride = FFALIGN(inlink->w, 8);
+    lut3d->rowbuf = av_malloc_array(3 * nb_threads * lut3d->rowbuf_stride,
+                                    sizeof(*lut3d->rowbuf));
+    if (!lut3d->rowbuf)
+        return AVERROR(ENOMEM);
+
     return 0;
 }
 
@@ -564,6 +853,8 @@ static av_cold int lut3d_init(AVFilterContext *ctx)
     const char *ext;
     LUT3DContext *lut3d = ctx->priv;
 
+    lut3d->prelut_range[1] = lut3d->lut_range[1] = 1.f;
+
     if (!lut3d->file) {
         set_identity_matrix(lut3d, 32);
         return 0;
@@ -607,6 +898,15 @@ end:
     return ret;
 }
 
+static av_cold void lut3d_uninit(AVFilterContext *ctx)
+{
+    LUT3DContext *lut3d = ctx->priv;
+
+    av_freep(&lut3d->prelut);
+    av_freep(&lut3d->coord_tab);
+    av_freep(&lut3d->rowbuf);
+}
+
 static const AVFilterPad lut3d_inputs[] = {
     {
         .name         = "default",
@@ -630,6 +930,7 @@ AVFilter ff_vf_lut3d = {
     .description   = NULL_IF_CONFIG_SMALL("Adjust colors using a 3D LUT."),
     .priv_size     = sizeof(LUT3DContext),
     .init          = lut3d_init,
+    .uninit        = lut3d_uninit,
     .query_formats = query_formats,
     .inputs        = lut3d_inputs,
     .outputs       = lut3d_outputs,
@@ -670,8 +971,44 @@ static void update_clut(LUT3DContext *lut3d, const AVFrame *frame)
     }                                                                   \
 } while (0)
 
-    if (!lut3d->clut_is16bit) LOAD_CLUT(8);
-    else                      LOAD_CLUT(16);
+#define LOAD_CLUT_PLANAR(nbits, depth) do {                             \
+    int i, j, k, x = 0, y = 0;                                          \
+                                                                        \
+    for (k = 0; k < level; k++) {                                       \
+        for (j = 0; j < level; j++) {                                   \
+            for (i = 0; i < level; i++) {                               \
+                const uint##nbits##_t *gsrc = (const uint##nbits##_t *) \
+                    (frame->data[0] + y * frame->linesize[0]);          \
+                const uint##nbits##_t *bsrc = (const uint##nbits##_t *) \
+                    (frame->data[1] + y * frame->linesize[1]);          \
+                const uint##nbits##_t *rsrc = (const uint##nbits##_t *) \
+                    (frame->data[2] + y * frame->linesize[2]);          \
+                struct rgbvec *vec = &lut3d->lut[i][j][k];              \
+                vec->r = rsrc[x] / (float)((1<<(depth)) - 1);           \
+                vec->g = gsrc[x] / (float)((1<<(depth)) - 1);           \
+                vec->b = bsrc[x] / (float)((1<<(depth)) - 1);           \
+                if (++x == w) {                                         \
+                    x = 0;                                              \
+                    y++;                                                \
+                }                                                       \
+            }                                                           \
+        }                                                               \
+    }                                                                   \
+} while (0)
+
+    if (!lut3d->clut_planar) {
+        if (lut3d->clut_bits == 8) LOAD_CLUT(8);
+        else                       LOAD_CLUT(16);
+    } else {
+        switch (lut3d->clut_bits) {
+        case  8: LOAD_CLUT_PLANAR(8,   8); break;
+        case  9: LOAD_CLUT_PLANAR(16,  9); break;
+        case 10: LOAD_CLUT_PLANAR(16, 10); break;
+        case 12: LOAD_CLUT_PLANAR(16, 12); break;
+        case 14: LOAD_CLUT_PLANAR(16, 14); break;
+        case 16: LOAD_CLUT_PLANAR(16, 16); break;
+        }
+    }
 }
 
 
@@ -707,14 +1044,8 @@ static int config_clut(AVFilterLink *inlink)
 
     av_assert0(desc);
 
-    lut3d->clut_is16bit = 0;
-    switch (inlink->format) {
-    case AV_PIX_FMT_RGB48:
-    case AV_PIX_FMT_BGR48:
-    case AV_PIX_FMT_RGBA64:
-    case AV_PIX_FMT_BGRA64:
-        lut3d->clut_is16bit = 1;
-    }
+    lut3d->clut_bits   = desc->comp[0].depth;
+    lut3d->clut_planar = desc->flags & AV_PIX_FMT_FLAG_PLANAR;
 
     lut3d->clut_step = av_get_padded_bits_per_pixel(desc) >> 3;
     ff_fill_rgba_map(lut3d->clut_rgba_map, inlink->format);
@@ -769,6 +1100,7 @@ static av_cold int haldclut_init(AVFilterContext *ctx)
 {
     LUT3DContext *lut3d = ctx->priv;
     lut3d->fs.on_event = update_apply_clut;
+    lut3d->prelut_range[1] = lut3d->lut_range[1] = 1.f;
     return 0;
 }
 
@@ -776,6 +1108,8 @@ static av_cold void haldclut_uninit(AVFilterContext *ctx)
 {
     LUT3DContext *lut3d = ctx->priv;
     ff_framesync2_uninit(&lut3d->fs);
+    av_freep(&lut3d->coord_tab);
+    av_freep(&lut3d->rowbuf);
 }
 
 static const AVOption haldclut_options[] = {
@@ -0,0 +1,44 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_LUT3D_H
+#define AVFILTER_LUT3D_H
+
+/* 3D LUT don't often go up to level 32, but it is common to have a Hald CLUT
+ * of 512x512 (64x64x64) */
+#define LUT3D_MAX_LEVEL 64
+
+typedef struct LUT3DDSPContext {
+    /**
+     * Interpolate the w points whose LUT coordinates are in r, g and b,
+     * replacing them with the interpolated colors. The coordinates are in
+     * the [0, lutsize - 1] range. lut holds the r, g and b components of
+     * the point (i, j, k) at offset ((i * LUT3D_MAX_LEVEL + j) *
+     * LUT3D_MAX_LEVEL + k) * 3. The arrays are padded to a multiple of 8
+     * points, which must hold valid coordinates and may be overwritten.
+     */
+    void (*interp_trilinear)(float *r, float *g, float *b, int w,
+                             const float *lut, int lutsize);
+    void (*interp_tetrahedral)(float *r, float *g, float *b, int w,
+                               const float *lut, int lutsize);
+} LUT3DDSPContext;
+
+void ff_lut3d_dsp_init(LUT3DDSPContext *dsp);
+void ff_lut3d_dsp_init_x86(LUT3DDSPContext *dsp);
+
+#endif /* AVFILTER_LUT3D_H */
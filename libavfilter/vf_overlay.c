@@ -39,6 +39,7 @@
 #include "drawutils.h"
 #include "framesync2.h"
 #include "video.h"
+#include "vf_overlay.h"
 
 static const char *const var_names[] = {
     "main_w",    "W", ///< width  of the main    video
@@ -123,9 +124,14 @@ typedef struct OverlayContext {
 
     AVExpr *x_pexpr, *y_pexpr;
 
-    void (*blend_image)(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y);
+    OverlayDSPContext dsp;
+    int (*blend_slice)(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
 } OverlayContext;
 
+typedef struct ThreadData {
+    AVFrame *dst, *src;
+} ThreadData;
+
 static av_cold void uninit(AVFilterContext *ctx)
 {
     OverlayContext *s = ctx->priv;
@@ -397,16 +403,53 @@ static int config_output(AVFilterLink *outlink)
 // ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)) is a faster version of: 255 * (x + y)
 #define UNPREMULTIPLY_ALPHA(x, y) ((((x) << 16) - ((x) << 9) + (x)) / ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)))
 
+static int blend_row_444_c(uint8_t *dst, const uint8_t *src,
+                           const uint8_t *alpha, int w)
+{
+    int i;
+
+    for (i = 0; i < w; i++)
+        dst[i] = FAST_DIV255(dst[i] * (255 - alpha[i]) + src[i] * alpha[i]);
+    return w;
+}
+
+static int blend_row_420_c(uint8_t *dst, const uint8_t *src,
+                           const uint8_t *alpha, int w,
+                           ptrdiff_t alpha_linesize)
+{
+    int i;
+
+    for (i = 0; i < w; i++) {
+        const uint8_t *a = alpha + 2 * i;
+        int avg = (a[0] + a[alpha_linesize] +
+                   a[1] + a[alpha_linesize + 1]) >> 2;
+        dst[i] = FAST_DIV255(dst[i] * (255 - avg) + src[i] * avg);
+    }
+    return w;
+}
+
+av_cold void ff_overlay_dsp_init(OverlayDSPContext *dsp)
+{
+    dsp->blend_row_444 = blend_row_444_c;
+    dsp->blend_row_420 = blend_row_420_c;
+
+    if (ARCH_X86)
+        ff_overlay_dsp_init_x86(dsp);
+}
+
 /**
- * Blend image in src to destination buffer dst at position (x, y).
+ * Blend the rows of the jobnr-th out of nb_jobs slices of the image in src
+ * to destination buffer dst at position (x, y).
  */
 
-static void blend_image_packed_rgb(AVFilterContext *ctx,
+static void blend_slice_packed_rgb(AVFilterContext *ctx,
                                    AVFrame *dst, const AVFrame *src,
-                                   int main_has_alpha, int x, int y)
+                                   int main_has_alpha, int x, int y,
+                                   int jobnr, int nb_jobs)
 {
     OverlayContext *s = ctx->priv;
     int i, imax, j, jmax;
+    int slice_start, slice_end;
     const int src_w = src->width;
     const int src_h = src->height;
     const int dst_w = dst->width;
@@ -424,11 +467,15 @@ static void blend_image_packed_rgb(AVFilterContext *ctx,
     const int sstep = s->overlay_pix_step[0];
     uint8_t *S, *sp, *d, *dp;
 
-    i = FFMAX(-y, 0);
-    sp = src->data[0] + i     * src->linesize[0];
-    dp = dst->data[0] + (y+i) * dst->linesize[0];
+    i    = FFMAX(-y, 0);
+    imax = FFMIN(-y + dst_h, src_h);
+    slice_start = i + FFMAX(imax - i, 0) *  jobnr      / nb_jobs;
+    slice_end   = i + FFMAX(imax - i, 0) * (jobnr + 1) / nb_jobs;
 
-    for (imax = FFMIN(-y + dst_h, src_h); i < imax; i++) {
+    sp = src->data[0] + slice_start     * src->linesize[0];
+    dp = dst->data[0] + (y+slice_start) * dst->linesize[0];
+
+    for (i = slice_start; i < slice_end; i++) {
         j = FFMAX(-x, 0);
         S = sp + j     * sstep;
         d = dp + (x+j) * dstep;
@@ -487,8 +534,10 @@ static av_always_inline void blend_plane(AVFilterContext *ctx,
                                          int main_has_alpha,
                                          int dst_plane,
                                          int dst_offset,
-                                         int dst_step)
+                                         int dst_step,
+                                         int jobnr, int nb_jobs)
 {
+    const OverlayDSPContext *dsp = &((OverlayContext *)ctx->priv)->dsp;
     int src_wp = AV_CEIL_RSHIFT(src_w, hsub);
     int src_hp = AV_CEIL_RSHIFT(src_h, vsub);
     int dst_wp = AV_CEIL_RSHIFT(dst_w, hsub);
@@ -497,23 +546,46 @@ static av_always_inline void blend_plane(AVFilterContext *ctx,
     int xp = x>>hsub;
     uint8_t *s, *sp, *d, *dp, *dap, *a, *da, *ap;
     int jmax, j, k, kmax;
+    int slice_start, slice_end;
+
+    j    = FFMAX(-yp, 0);
+    jmax = FFMIN(-yp + dst_hp, src_hp);
+    slice_start = j + FFMAX(jmax - j, 0) *  jobnr      / nb_jobs;
+    slice_end   = j + FFMAX(jmax - j, 0) * (jobnr + 1) / nb_jobs;
 
-    j = FFMAX(-yp, 0);
-    sp = src->data[i] + j         * src->linesize[i];
+    sp = src->data[i] + slice_start         * src->linesize[i];
     dp = dst->data[dst_plane]
-                      + (yp+j)    * dst->linesize[dst_plane]
+                      + (yp+slice_start)    * dst->linesize[dst_plane]
                       + dst_offset;
-    ap = src->data[3] + (j<<vsub) * src->linesize[3];
-    dap = dst->data[3] + ((yp+j) << vsub) * dst->linesize[3];
+    ap = src->data[3] + (slice_start<<vsub) * src->linesize[3];
+    dap = dst->data[3] + ((yp+slice_start) << vsub) * dst->linesize[3];
 
-    for (jmax = FFMIN(-yp + dst_hp, src_hp); j < jmax; j++) {
+    for (j = slice_start; j < slice_end; j++) {
         k = FFMAX(-xp, 0);
         d = dp + (xp+k) * dst_step;
         s = sp + k;
         a = ap + (k<<hsub);
         da = dap + ((xp+k) << hsub);
+        kmax = FFMIN(-xp + dst_wp, src_wp);
+
+        // fast path for the common case of a straight alpha main input,
+        // the generic loop below takes care of whatever is left over
+        if (!main_has_alpha && dst_step == 1) {
+            int c = 0;
+
+            if (!hsub && !vsub && k < kmax)
+                c = dsp->blend_row_444(d, s, a, kmax - k);
+            else if (hsub && vsub && j+1 < src_hp && k < FFMIN(kmax, src_wp - 1))
+                c = dsp->blend_row_420(d, s, a, FFMIN(kmax, src_wp - 1) - k,
+                                       src->linesize[3]);
+            s  += c;
+            d  += c;
+            da += c << hsub;
+            a  += c << hsub;
+            k  += c;
+        }
 
-        for (kmax = FFMIN(-xp + dst_wp, src_wp); k < kmax; k++) {
+        for (; k < kmax; k++) {
             int alpha_v, alpha_h, alpha;
 
             // average alpha for color components, improve quality
@@ -562,17 +634,23 @@ static av_always_inline void blend_plane(AVFilterContext *ctx,
 static inline void alpha_composite(const AVFrame *src, const AVFrame *dst,
                                    int src_w, int src_h,
                                    int dst_w, int dst_h,
-                                   int x, int y)
+                                   int x, int y,
+                                   int jobnr, int nb_jobs)
 {
     uint8_t alpha;          ///< the amount of overlay to blend on to main
     uint8_t *s, *sa, *d, *da;
     int i, imax, j, jmax;
+    int slice_start, slice_end;
+
+    i    = FFMAX(-y, 0);
+    imax = FFMIN(-y + dst_h, src_h);
+    slice_start = i + FFMAX(imax - i, 0) *  jobnr      / nb_jobs;
+    slice_end   = i + FFMAX(imax - i, 0) * (jobnr + 1) / nb_jobs;
 
-    i = FFMAX(-y, 0);
-    sa = src->data[3] + i     * src->linesize[3];
-    da = dst->data[3] + (y+i) * dst->linesize[3];
+    sa = src->data[3] + slice_start     * src->linesize[3];
+    da = dst->data[3] + (y+slice_start) * dst->linesize[3];
 
-    for (imax = FFMIN(-y + dst_h, src_h); i < imax; i++) {
+    for (i = slice_start; i < slice_end; i++) {
         j = FFMAX(-x, 0);
         s = sa + j;
         d = da + x+j;
@@ -601,11 +679,12 @@ static inline void alpha_composite(const AVFrame *src, const AVFrame *dst,
     }
 }
 
-static av_always_inline void blend_image_yuv(AVFilterContext *ctx,
+static av_always_inline void blend_slice_yuv(AVFilterContext *ctx,
                                              AVFrame *dst, const AVFrame *src,
                                              int hsub, int vsub,
                                              int main_has_alpha,
-                                             int x, int y)
+                                             int x, int y,
+                                             int jobnr, int nb_jobs)
 {
     OverlayContext *s = ctx->priv;
     const int src_w = src->width;
@@ -614,21 +693,22 @@ static av_always_inline void blend_image_yuv(AVFilterContext *ctx,
     const int dst_h = dst->height;
 
     blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 0, 0,       0, x, y, main_has_alpha,
-                s->main_desc->comp[0].plane, s->main_desc->comp[0].offset, s->main_desc->comp[0].step);
+                s->main_desc->comp[0].plane, s->main_desc->comp[0].offset, s->main_desc->comp[0].step,
+                jobnr, nb_jobs);
     blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 1, hsub, vsub, x, y, main_has_alpha,
-                s->main_desc->comp[1].plane, s->main_desc->comp[1].offset, s->main_desc->comp[1].step);
+                s->main_desc->comp[1].plane, s->main_desc->comp[1].offset, s->main_desc->comp[1].step,
+                jobnr, nb_jobs);
     blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 2, hsub, vsub, x, y, main_has_alpha,
-                s->main_desc->comp[2].plane, s->main_desc->comp[2].offset, s->main_desc->comp[2].step);
-
-    if (main_has_alpha)
-        alpha_composite(src, dst, src_w, src_h, dst_w, dst_h, x, y);
+                s->main_desc->comp[2].plane, s->main_desc->comp[2].offset, s->main_desc->comp[2].step,
+                jobnr, nb_jobs);
 }
 
-static av_always_inline void blend_image_planar_rgb(AVFilterContext *ctx,
+static av_always_inline void blend_slice_planar_rgb(AVFilterContext *ctx,
                                                     AVFrame *dst, const AVFrame *src,
                                                     int hsub, int vsub,
                                                     int main_has_alpha,
-                                                    int x, int y)
+                                                    int x, int y,
+                                                    int jobnr, int nb_jobs)
 {
     OverlayContext *s = ctx->priv;
     const int src_w = src->width;
@@ -637,64 +717,114 @@ static av_always_inline void blend_image_planar_rgb(AVFilterContext *ctx,
     const int dst_h = dst->height;
 
     blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 0, 0,       0, x, y, main_has_alpha,
-                s->main_desc->comp[1].plane, s->main_desc->comp[1].offset, s->main_desc->comp[1].step);
+                s->main_desc->comp[1].plane, s->main_desc->comp[1].offset, s->main_desc->comp[1].step,
+                jobnr, nb_jobs);
     blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 1, hsub, vsub, x, y, main_has_alpha,
-                s->main_desc->comp[2].plane, s->main_desc->comp[2].offset, s->main_desc->comp[2].step);
+                s->main_desc->comp[2].plane, s->main_desc->comp[2].offset, s->main_desc->comp[2].step,
+                jobnr, nb_jobs);
     blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 2, hsub, vsub, x, y, main_has_alpha,
-                s->main_desc->comp[0].plane, s->main_desc->comp[0].offset, s->main_desc->comp[0].step);
+                s->main_desc->comp[0].plane, s->main_desc->comp[0].offset, s->main_desc->comp[0].step,
+                jobnr, nb_jobs);
+}
+
+static int blend_slice_yuv420(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
 
-    if (main_has_alpha)
-        alpha_composite(src, dst, src_w, src_h, dst_w, dst_h, x, y);
+    blend_slice_yuv(ctx, td->dst, td->src, 1, 1, 0, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_yuv420(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int blend_slice_yuva420(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_yuv(ctx, dst, src, 1, 1, 0, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    blend_slice_yuv(ctx, td->dst, td->src, 1, 1, 1, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_yuva420(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int blend_slice_yuv422(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_yuv(ctx, dst, src, 1, 1, 1, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    blend_slice_yuv(ctx, td->dst, td->src, 1, 0, 0, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_yuv422(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int blend_slice_yuva422(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_yuv(ctx, dst, src, 1, 0, 0, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    blend_slice_yuv(ctx, td->dst, td->src, 1, 0, 1, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_yuva422(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int blend_slice_yuv444(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_yuv(ctx, dst, src, 1, 0, 1, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    blend_slice_yuv(ctx, td->dst, td->src, 0, 0, 0, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_yuv444(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int blend_slice_yuva444(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_yuv(ctx, dst, src, 0, 0, 0, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    blend_slice_yuv(ctx, td->dst, td->src, 0, 0, 1, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_yuva444(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int blend_slice_gbrp(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_yuv(ctx, dst, src, 0, 0, 1, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 0, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_gbrp(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int blend_slice_gbrap(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_planar_rgb(ctx, dst, src, 0, 0, 0, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    blend_slice_planar_rgb(ctx, td->dst, td->src, 0, 0, 1, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_gbrap(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int blend_slice_rgb(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_planar_rgb(ctx, dst, src, 0, 0, 1, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    blend_slice_packed_rgb(ctx, td->dst, td->src, 0, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_rgb(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int blend_slice_rgba(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_packed_rgb(ctx, dst, src, 0, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    blend_slice_packed_rgb(ctx, td->dst, td->src, 1, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
-static void blend_image_rgba(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y)
+static int alpha_composite_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    blend_image_packed_rgb(ctx, dst, src, 1, x, y);
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    alpha_composite(td->src, td->dst, td->src->width, td->src->height,
+                    td->dst->width, td->dst->height, s->x, s->y, jobnr, nb_jobs);
+    return 0;
 }
 
 static int config_input_main(AVFilterLink *inlink)
@@ -714,39 +844,39 @@ static int config_input_main(AVFilterLink *inlink)
     s->main_has_alpha = ff_fmt_is_in(inlink->format, alpha_pix_fmts);
     switch (s->format) {
     case OVERLAY_FORMAT_YUV420:
-        s->blend_image = s->main_has_alpha ? blend_image_yuva420 : blend_image_yuv420;
+        s->blend_slice = s->main_has_alpha ? blend_slice_yuva420 : blend_slice_yuv420;
         break;
     case OVERLAY_FORMAT_YUV422:
-        s->blend_image = s->main_has_alpha ? blend_image_yuva422 : blend_image_yuv422;
+        s->blend_slice = s->main_has_alpha ? blend_slice_yuva422 : blend_slice_yuv422;
         break;
     case OVERLAY_FORMAT_YUV444:
-        s->blend_image = s->main_has_alpha ? blend_image_yuva444 : blend_image_yuv444;
+        s->blend_slice = s->main_has_alpha ? blend_slice_yuva444 : blend_slice_yuv444;
         break;
     case OVERLAY_FORMAT_RGB:
-        s->blend_image = s->main_has_alpha ? blend_image_rgba : blend_image_rgb;
+        s->blend_slice = s->main_has_alpha ? blend_slice_rgba : blend_slice_rgb;
         break;
     case OVERLAY_FORMAT_GBRP:
-        s->blend_image = s->main_has_alpha ? blend_image_gbrap : blend_image_gbrp;
+        s->blend_slice = s->main_has_alpha ? blend_slice_gbrap : blend_slice_gbrp;
         break;
     case OVERLAY_FORMAT_AUTO:
         switch (inlink->format) {
         case AV_PIX_FMT_YUVA420P:
-            s->blend_image = blend_image_yuva420;
+            s->blend_slice = blend_slice_yuva420;
             break;
         case AV_PIX_FMT_YUVA422P:
-            s->blend_image = blend_image_yuva422;
+            s->blend_slice = blend_slice_yuva422;
             break;
         case AV_PIX_FMT_YUVA444P:
-            s->blend_image = blend_image_yuva444;
+            s->blend_slice = blend_slice_yuva444;
             break;
         case AV_PIX_FMT_ARGB:
         case AV_PIX_FMT_RGBA:
         case AV_PIX_FMT_BGRA:
         case AV_PIX_FMT_ABGR:
-            s->blend_image = blend_image_rgba;
+            s->blend_slice = blend_slice_rgba;
             break;
         case AV_PIX_FMT_GBRAP:
-            s->blend_image = blend_image_gbrap;
+            s->blend_slice = blend_slice_gbrap;
             break;
         default:
             av_assert0(0);
@@ -792,8 +922,17 @@ static int do_blend(FFFrameSync *fs)
     }
 
     if (s->x < mainpic->width  && s->x + second->width  >= 0 ||
-        s->y < mainpic->height && s->y + second->height >= 0)
-        s->blend_image(ctx, mainpic, second, s->x, s->y);
+        s->y < mainpic->height && s->y + second->height >= 0) {
+        ThreadData td = { .dst = mainpic, .src = second };
+        int nb_jobs = FFMIN(FFMAX(1, AV_CEIL_RSHIFT(second->height, s->vsub)),
+                            ff_filter_get_nb_threads(ctx));
+
+        ctx->internal->execute(ctx, s->blend_slice, &td, NULL, nb_jobs);
+        // the alpha plane of main is read by the chroma blending above, so it
+        // can only be updated once every slice is done with it
+        if (s->main_has_alpha && !s->main_is_packed_rgb)
+            ctx->internal->execute(ctx, alpha_composite_slice, &td, NULL, nb_jobs);
+    }
     return ff_filter_frame(ctx->outputs[0], mainpic);
 }
 
@@ -802,6 +941,7 @@ static av_cold int init(AVFilterContext *ctx)
     OverlayContext *s = ctx->priv;
 
     s->fs.on_event = do_blend;
+    ff_overlay_dsp_init(&s->dsp);
     return 0;
 }
 
@@ -876,5 +1016,6 @@ AVFilter ff_vf_overlay = {
     .process_command = process_command,
     .inputs        = avfilter_vf_overlay_inputs,
     .outputs       = avfilter_vf_overlay_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,48 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_OVERLAY_H
+#define AVFILTER_OVERLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct OverlayDSPContext {
+    /**
+     * Blend w 8-bit samples of src into dst, using one alpha sample per
+     * pixel. Returns the number of pixels processed, which may be less
+     * than w; the caller is responsible for the remaining ones.
+     */
+    int (*blend_row_444)(uint8_t *dst, const uint8_t *src,
+                         const uint8_t *alpha, int w);
+
+    /**
+     * Same as blend_row_444(), but for planes subsampled by 2 in both
+     * directions: the alpha of each pixel is the average of a 2x2 block
+     * of the full resolution alpha plane, whose stride is alpha_linesize.
+     * Every block touched must lie entirely within the alpha plane.
+     */
+    int (*blend_row_420)(uint8_t *dst, const uint8_t *src,
+                         const uint8_t *alpha, int w,
+                         ptrdiff_t alpha_linesize);
+} OverlayDSPContext;
+
+void ff_overlay_dsp_init(OverlayDSPContext *dsp);
+void ff_overlay_dsp_init_x86(OverlayDSPContext *dsp);
+
+#endif /* AVFILTER_OVERLAY_H */
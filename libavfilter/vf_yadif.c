@@ -31,14 +31,6 @@
 #include "video.h"
 #include "yadif.h"
 
-typedef struct ThreadData {
-    AVFrame *frame;
-    int plane;
-    int w, h;
-    int parity;
-    int tff;
-} ThreadData;
-
 #define CHECK(j)\
     {   int score = FFABS(cur[mrefs - 1 + (j)] - cur[prefs - 1 - (j)])\
                   + FFABS(cur[mrefs  +(j)] - cur[prefs  -(j)])\
@@ -183,69 +175,125 @@ static void filter_edges_16bit(void *dst1, void *prev1, void *cur1, void *next1,
     FILTER(w - 3, w, 0)
 }
 
-static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+static void filter_plane_slice(YADIFContext *s, const YADIFQueuedFrame *q,
+                               int plane, int w, int h, int jobnr, int nb_jobs)
 {
-    YADIFContext *s = ctx->priv;
-    ThreadData *td  = arg;
-    int refs = s->cur->linesize[td->plane];
-    int df = (s->csp->comp[td->plane].depth + 7) / 8;
+    int refs = q->cur->linesize[plane];
+    int df = (s->csp->comp[plane].depth + 7) / 8;
     int pix_3 = 3 * df;
-    int slice_start = (td->h *  jobnr   ) / nb_jobs;
-    int slice_end   = (td->h * (jobnr+1)) / nb_jobs;
+    int slice_start = (h *  jobnr   ) / nb_jobs;
+    int slice_end   = (h * (jobnr+1)) / nb_jobs;
     int y;
 
     /* filtering reads 3 pixels to the left/right; to avoid invalid reads,
      * we need to call the c variant which avoids this for border pixels
      */
     for (y = slice_start; y < slice_end; y++) {
-        if ((y ^ td->parity) & 1) {
-            uint8_t *prev = &s->prev->data[td->plane][y * refs];
-            uint8_t *cur  = &s->cur ->data[td->plane][y * refs];
-            uint8_t *next = &s->next->data[td->plane][y * refs];
-            uint8_t *dst  = &td->frame->data[td->plane][y * td->frame->linesize[td->plane]];
-            int     mode  = y == 1 || y + 2 == td->h ? 2 : s->mode;
+        if ((y ^ q->parity) & 1) {
+            uint8_t *prev = &q->prev->data[plane][y * refs];
+            uint8_t *cur  = &q->cur ->data[plane][y * refs];
+            uint8_t *next = &q->next->data[plane][y * refs];
+            uint8_t *dst  = &q->out->data[plane][y * q->out->linesize[plane]];
+            int     mode  = y == 1 || y + 2 == h ? 2 : s->mode;
             s->filter_line(dst + pix_3, prev + pix_3, cur + pix_3,
-                           next + pix_3, td->w - (3 + MAX_ALIGN/df-1),
-                           y + 1 < td->h ? refs : -refs,
+                           next + pix_3, w - (3 + MAX_ALIGN/df-1),
+                           y + 1 < h ? refs : -refs,
                            y ? -refs : refs,
-                           td->parity ^ td->tff, mode);
-            s->filter_edges(dst, prev, cur, next, td->w,
-                            y + 1 < td->h ? refs : -refs,
+                           q->parity ^ q->tff, mode);
+            s->filter_edges(dst, prev, cur, next, w,
+                            y + 1 < h ? refs : -refs,
                             y ? -refs : refs,
-                            td->parity ^ td->tff, mode);
+                            q->parity ^ q->tff, mode);
         } else {
-            memcpy(&td->frame->data[td->plane][y * td->frame->linesize[td->plane]],
-                   &s->cur->data[td->plane][y * refs], td->w * df);
+            memcpy(&q->out->data[plane][y * q->out->linesize[plane]],
+                   &q->cur->data[plane][y * refs], w * df);
+        }
+    }
+}
+
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    YADIFContext *s = ctx->priv;
+    int i, plane;
+
+    for (i = 0; i < s->nb_queued; i++) {
+        const YADIFQueuedFrame *q = &s->queued[i];
+
+        for (plane = 0; plane < s->csp->nb_components; plane++) {
+            int w = q->out->width;
+            int h = q->out->height;
+
+            if (plane == 1 || plane == 2) {
+                w = AV_CEIL_RSHIFT(w, s->csp->log2_chroma_w);
+                h = AV_CEIL_RSHIFT(h, s->csp->log2_chroma_h);
+            }
+
+            filter_plane_slice(s, q, plane, w, h, jobnr, nb_jobs);
         }
     }
     return 0;
 }
 
-static void filter(AVFilterContext *ctx, AVFrame *dstpic,
-                   int parity, int tff)
+static void free_queued_frame(YADIFQueuedFrame *q)
+{
+    av_frame_free(&q->prev);
+    av_frame_free(&q->cur);
+    av_frame_free(&q->next);
+    av_frame_free(&q->out);
+}
+
+/**
+ * Filter all the queued frames with a single call to execute(), so that
+ * the threads only synchronize once for the whole batch, and send them
+ * in order.
+ */
+static int flush_frames(AVFilterContext *ctx)
 {
     YADIFContext *yadif = ctx->priv;
-    ThreadData td = { .frame = dstpic, .parity = parity, .tff = tff };
-    int i;
+    int i, ret = 0;
 
-    for (i = 0; i < yadif->csp->nb_components; i++) {
-        int w = dstpic->width;
-        int h = dstpic->height;
+    if (!yadif->nb_queued)
+        return 0;
 
-        if (i == 1 || i == 2) {
-            w = AV_CEIL_RSHIFT(w, yadif->csp->log2_chroma_w);
-            h = AV_CEIL_RSHIFT(h, yadif->csp->log2_chroma_h);
-        }
+    ctx->internal->execute(ctx, filter_slice, NULL, NULL,
+                           FFMIN(yadif->queued[0].out->height,
+                                 ff_filter_get_nb_threads(ctx)));
+    emms_c();
+
+    for (i = 0; i < yadif->nb_queued; i++) {
+        YADIFQueuedFrame *q = &yadif->queued[i];
 
+        if (ret >= 0) {
+            ret = ff_filter_frame(ctx->outputs[0], q->out);
+            q->out = NULL;
+        }
+        free_queued_frame(q);
+    }
+    yadif->nb_queued = 0;
 
-        td.w       = w;
-        td.h       = h;
-        td.plane   = i;
+    return ret;
+}
 
-        ctx->internal->execute(ctx, filter_slice, &td, NULL, FFMIN(h, ff_filter_get_nb_threads(ctx)));
+static int filter(AVFilterContext *ctx, AVFrame *dstpic,
+                  int parity, int tff)
+{
+    YADIFContext *yadif = ctx->priv;
+    YADIFQueuedFrame *q = &yadif->queued[yadif->nb_queued];
+
+    q->out    = dstpic;
+    q->parity = parity;
+    q->tff    = tff;
+    q->prev   = av_frame_clone(yadif->prev);
+    q->cur    = av_frame_clone(yadif->cur);
+    q->next   = av_frame_clone(yadif->next);
+    if (!q->prev || !q->cur || !q->next) {
+        free_queued_frame(q);
+        return AVERROR(ENOMEM);
     }
 
-    emms_c();
+    if (++yadif->nb_queued < yadif->batch)
+        return 0;
+    return flush_frames(ctx);
 }
 
 static int return_frame(AVFilterContext *ctx, int is_second)
@@ -270,8 +318,6 @@ static int return_frame(AVFilterContext *ctx, int is_second)
         yadif->out->interlaced_frame = 0;
     }
 
-    filter(ctx, yadif->out, tff ^ !is_second, tff);
-
     if (is_second) {
         int64_t cur_pts  = yadif->cur->pts;
         int64_t next_pts = yadif->next->pts;
@@ -282,7 +328,8 @@ static int return_frame(AVFilterContext *ctx, int is_second)
             yadif->out->pts = AV_NOPTS_VALUE;
         }
     }
-    ret = ff_filter_frame(ctx->outputs[0], yadif->out);
+    ret = filter(ctx, yadif->out, tff ^ !is_second, tff);
+    yadif->out = NULL;
 
     yadif->frame_pending = (yadif->mode&1) && !is_second;
     return ret;
@@ -352,6 +399,10 @@ static int filter_frame(AVFilterLink *link, AVFrame *frame)
         (yadif->deint && !yadif->prev->interlaced_frame && yadif->prev->repeat_pict) ||
         (yadif->deint && !yadif->next->interlaced_frame && yadif->next->repeat_pict)
     ) {
+        int ret = flush_frames(ctx);
+        if (ret < 0)
+            return ret;
+
         yadif->out  = av_frame_clone(yadif->cur);
         if (!yadif->out)
             return AVERROR(ENOMEM);
@@ -382,12 +433,18 @@ static int request_frame(AVFilterLink *link)
     int ret;
 
     if (yadif->frame_pending) {
-        return_frame(ctx, 1);
-        return 0;
+        ret = return_frame(ctx, 1);
+        /* keep requesting input while the batch is not complete */
+        if (ret < 0 || !yadif->nb_queued)
+            return ret;
+        if (yadif->eof)
+            return flush_frames(ctx);
     }
 
-    if (yadif->eof)
-        return AVERROR_EOF;
+    if (yadif->eof) {
+        ret = flush_frames(ctx);
+        return ret < 0 ? ret : AVERROR_EOF;
+    }
 
     ret  = ff_request_frame(ctx->inputs[0]);
 
@@ -401,6 +458,7 @@ static int request_frame(AVFilterLink *link)
 
         filter_frame(ctx->inputs[0], next);
         yadif->eof = 1;
+        return flush_frames(ctx);
     } else if (ret < 0) {
         return ret;
     }
@@ -411,10 +469,15 @@ static int request_frame(AVFilterLink *link)
 static av_cold void uninit(AVFilterContext *ctx)
 {
     YADIFContext *yadif = ctx->priv;
+    int i;
 
     av_frame_free(&yadif->prev);
     av_frame_free(&yadif->cur );
     av_frame_free(&yadif->next);
+
+    for (i = 0; i < yadif->nb_queued; i++)
+        free_queued_frame(&yadif->queued[i]);
+    av_freep(&yadif->queued);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -485,6 +548,12 @@ static int config_props(AVFilterLink *link)
         return AVERROR(EINVAL);
     }
 
+    av_freep(&s->queued);
+    s->nb_queued = 0;
+    s->queued = av_calloc(s->batch, sizeof(*s->queued));
+    if (!s->queued)
+        return AVERROR(ENOMEM);
+
     s->csp = av_pix_fmt_desc_get(link->format);
     if (s->csp->comp[0].depth > 8) {
         s->filter_line  = filter_line_c_16bit;
@@ -522,6 +591,8 @@ static const AVOption yadif_options[] = {
     CONST("all",        "deinterlace all frames",                       YADIF_DEINT_ALL,         "deint"),
     CONST("interlaced", "only deinterlace frames marked as interlaced", YADIF_DEINT_INTERLACED,  "deint"),
 
+    { "batch", "set the number of output frames filtered together", OFFSET(batch), AV_OPT_TYPE_INT, {.i64=1}, 1, 64, FLAGS },
+
     { NULL }
 };
 
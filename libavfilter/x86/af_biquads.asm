@@ -0,0 +1,153 @@
+;*****************************************************************************
+;* x86-optimized functions for biquad filters
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; load one sample of each of the two channels into the doubles of %1
+%macro LOAD 2 ; dst, offset
+%ifidn TYPE, flt
+    movss           %1, [s0q + %2]
+    movss           m7, [s1q + %2]
+    unpcklps        %1, m7
+    cvtps2pd        %1, %1
+%else
+    movsd           %1, [s0q + %2]
+    movhpd          %1, [s1q + %2]
+%endif
+%endmacro
+
+%macro STORE 2 ; offset, src
+%ifidn TYPE, flt
+    cvtpd2ps        m7, %2
+    movss  [d0q + %1], m7
+    psrlq           m7, 32
+    movss  [d1q + %1], m7
+%else
+    movsd  [d0q + %1], %2
+    movhpd [d1q + %1], %2
+%endif
+%endmacro
+
+; Two channels are filtered at once, one per double of the registers, as the
+; recursion leaves nothing to vectorize within a channel. The order of the
+; operations is the one of the C code, so that the output is bitexact.
+; m0 = in, m1 = i1, m2 = i2, m3 = o1, m4 = o2, m8-m12 = b0, b1, b2, a1, a2
+%macro BIQUAD 2 ; type, log2 of the sample size
+%define TYPE %1
+; int ff_biquad_%1(type **dst, const type **src, int nb_channels, int len,
+;                  double *state, const double *coeffs)
+cglobal biquad_%1, 6, 12, 13, dst, src, nb, len, state, coeffs, ch, x, s0, s1, d0, d1
+    movsxdifnidn   nbq, nbd
+    movsxdifnidn  lenq, lend
+    movddup         m8, [coeffsq]
+    movddup         m9, [coeffsq +  8]
+    movddup        m10, [coeffsq + 16]
+    movddup        m11, [coeffsq + 24]
+    movddup        m12, [coeffsq + 32]
+    DEFINE_ARGS dst, src, nb, len, state, state2, ch, x, s0, s1, d0, d1
+    shl            nbq, 3
+    lea        state2q, [stateq + 2 * nbq]
+    xor            chq, chq
+
+.chloop:
+    lea             xq, [chq + 16]
+    cmp             xq, nbq
+    jg .end
+    mov            s0q, [srcq + chq]
+    mov            s1q, [srcq + chq + 8]
+    mov            d0q, [dstq + chq]
+    mov            d1q, [dstq + chq + 8]
+    movu            m1, [stateq  + chq]
+    movu            m2, [stateq  + nbq + chq]
+    movu            m3, [state2q + chq]
+    movu            m4, [state2q + nbq + chq]
+    mov             xq, lenq
+    and             xq, ~1
+    shl             xq, %2
+    add            s0q, xq
+    add            s1q, xq
+    add            d0q, xq
+    add            d1q, xq
+    neg             xq
+    jz .tail
+
+    .loop:
+        ; o = i2 * b2 + i1 * b1 + in * b0 - o2 * a2 - o1 * a1
+        LOAD            m0, xq
+        mulpd           m5, m2, m10
+        mulpd           m6, m1, m9
+        addpd           m5, m6
+        mulpd           m6, m0, m8
+        addpd           m5, m6
+        mulpd           m6, m4, m12
+        subpd           m5, m6
+        mulpd           m6, m3, m11
+        subpd           m5, m6
+        STORE           xq, m5
+        mova            m2, m1
+        mova            m1, m0
+        mova            m4, m3
+        mova            m3, m5
+        add             xq, 1 << %2
+    jl .loop
+
+.tail:
+    ; o = in * b0 + i1 * b1 + i2 * b2 - o1 * a1 - o2 * a2
+    test          lend, 1
+    jz .next
+    LOAD            m0, 0
+    mulpd           m5, m0, m8
+    mulpd           m6, m1, m9
+    addpd           m5, m6
+    mulpd           m6, m2, m10
+    addpd           m5, m6
+    mulpd           m6, m3, m11
+    subpd           m5, m6
+    mulpd           m6, m4, m12
+    subpd           m5, m6
+    STORE            0, m5
+    mova            m2, m1
+    mova            m1, m0
+    mova            m4, m3
+    mova            m3, m5
+
+.next:
+    movu [stateq  + chq], m1
+    movu [stateq  + nbq + chq], m2
+    movu [state2q + chq], m3
+    movu [state2q + nbq + chq], m4
+    add            chq, 16
+    jmp .chloop
+
+.end:
+    shr            chq, 3
+    mov            eax, chd
+    RET
+%endmacro
+
+INIT_XMM sse3
+BIQUAD flt, 2
+BIQUAD dbl, 3
+
+%endif ; ARCH_X86_64
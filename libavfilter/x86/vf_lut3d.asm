@@ -0,0 +1,199 @@
+;*****************************************************************************
+;* x86-optimized functions for the lut3d filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+; offsets of the next point along r, g and b, in floats
+pd_stride_r: times 8 dd 64 * 64 * 3
+pd_stride_g: times 8 dd 64 * 3
+pd_stride_b: times 8 dd 3
+pf_1:        times 8 dd 1.0
+
+SECTION .text
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+
+%macro GATHER 3 ; dst, index, component
+    pcmpeqd        m15, m15
+    vgatherdps      %1, [lutq + %2 * 4 + %3 * 4], m15
+%endmacro
+
+; Load the coordinates of 8 points and compute, for each one, the offset of
+; the previous point in m3, the fractional parts in m0-m2 and the offsets to
+; the next point along r, g and b in m6-m8, which are 0 on the last point.
+%macro LOAD_COORDS 0
+    movu            m0, [rq + wq]
+    movu            m1, [gq + wq]
+    movu            m2, [bq + wq]
+    movd          xm15, sized
+    vpbroadcastd   m15, xm15
+    cvttps2dq       m3, m0
+    cvttps2dq       m4, m1
+    cvttps2dq       m5, m2
+    cvtdq2ps        m6, m3
+    cvtdq2ps        m7, m4
+    cvtdq2ps        m8, m5
+    subps           m0, m6
+    subps           m1, m7
+    subps           m2, m8
+    pcmpgtd         m6, m15, m3
+    pcmpgtd         m7, m15, m4
+    pcmpgtd         m8, m15, m5
+    pand            m6, [pd_stride_r]
+    pand            m7, [pd_stride_g]
+    pand            m8, [pd_stride_b]
+    pslld           m3, 12
+    pslld           m4, 6
+    paddd           m3, m4
+    paddd           m3, m5
+    paddd           m4, m3, m3
+    paddd           m3, m4
+%endmacro
+
+; lerp(%1, %2, %3) = %1 + (%2 - %1) * %3, in %1
+%macro LERP 3
+    subps           %2, %1
+    mulps           %2, %3
+    addps           %1, %2
+%endmacro
+
+; The operations are the ones of the C code, in the same order, so that the
+; output is bitexact.
+INIT_YMM avx2
+; void ff_lut3d_interp_trilinear(float *r, float *g, float *b, int w,
+;                                const float *lut, int lutsize)
+cglobal lut3d_interp_trilinear, 6, 6, 16, r, g, b, w, lut, size
+    movsxdifnidn    wq, wd
+    dec          sized
+    shl             wq, 2
+    add             rq, wq
+    add             gq, wq
+    add             bq, wq
+    neg             wq
+
+.loop:
+    LOAD_COORDS
+    ; indices of the 8 vertices of the cube
+    paddd           m4, m3, m6  ; 100
+    paddd           m5, m3, m7  ; 010
+    paddd           m9, m4, m7  ; 110
+    paddd          m10, m3, m8  ; 001
+    paddd           m6, m4, m8  ; 101
+    paddd           m7, m5, m8  ; 011
+    paddd           m8, m9      ; 111
+
+%macro TRILINEAR 2 ; component, dst
+    GATHER         m11, m3, %1
+    GATHER         m12, m4, %1
+    LERP           m11, m12, m0
+    GATHER         m12, m5, %1
+    GATHER         m13, m9, %1
+    LERP           m12, m13, m0
+    LERP           m11, m12, m1
+    GATHER         m12, m10, %1
+    GATHER         m13, m6, %1
+    LERP           m12, m13, m0
+    GATHER         m13, m7, %1
+    GATHER         m14, m8, %1
+    LERP           m13, m14, m0
+    LERP           m12, m13, m1
+    LERP           m11, m12, m2
+    movu     [%2 + wq], m11
+%endmacro
+
+    TRILINEAR        0, rq
+    TRILINEAR        1, gq
+    TRILINEAR        2, bq
+    add             wq, mmsize
+    jl .loop
+    RET
+
+; Branchless version of the tetrahedral interpolation: with a1 >= a2 >= a3
+; the sorted fractional parts, the point is interpolated from the previous
+; point, the point one step further along the a1 axis, the point one step
+; further along the a1 and a2 axes and the next point.
+; void ff_lut3d_interp_tetrahedral(float *r, float *g, float *b, int w,
+;                                  const float *lut, int lutsize)
+cglobal lut3d_interp_tetrahedral, 6, 6, 16, r, g, b, w, lut, size
+    movsxdifnidn    wq, wd
+    dec          sized
+    shl             wq, 2
+    add             rq, wq
+    add             gq, wq
+    add             bq, wq
+    neg             wq
+
+.loop:
+    LOAD_COORDS
+    maxps           m9, m0, m1
+    minps          m10, m0, m1
+    maxps          m11, m9, m2  ; a1
+    minps           m9, m2
+    maxps           m9, m10     ; a2
+    minps          m10, m2      ; a3
+
+    ; step along the a1 axis
+    cmpps          m12, m1, m11, 0
+    blendvps       m13, m8, m7, m12
+    cmpps          m12, m0, m11, 0
+    blendvps       m13, m13, m6, m12
+    ; steps along all the axes but the a3 one
+    cmpps          m12, m1, m10, 0
+    blendvps       m14, m8, m7, m12
+    cmpps          m12, m0, m10, 0
+    blendvps       m14, m14, m6, m12
+    paddd           m6, m7
+    paddd           m6, m8
+    psubd          m14, m6, m14
+    paddd          m13, m3
+    paddd          m14, m3
+    paddd           m6, m3
+
+    ; weights
+    subps           m0, m11, m9     ; a1 - a2
+    subps           m1, m9, m10     ; a2 - a3
+    mova            m9, [pf_1]
+    subps          m11, m9, m11     ; 1 - a1
+
+%macro TETRAHEDRAL 2 ; component, dst
+    GATHER          m2, m3, %1
+    mulps           m2, m11
+    GATHER          m4, m13, %1
+    mulps           m4, m0
+    addps           m2, m4
+    GATHER          m4, m14, %1
+    mulps           m4, m1
+    addps           m2, m4
+    GATHER          m4, m6, %1
+    mulps           m4, m10
+    addps           m2, m4
+    movu     [%2 + wq], m2
+%endmacro
+
+    TETRAHEDRAL      0, rq
+    TETRAHEDRAL      1, gq
+    TETRAHEDRAL      2, bq
+    add             wq, mmsize
+    jl .loop
+    RET
+
+%endif
@@ -0,0 +1,119 @@
+;*****************************************************************************
+;* x86-optimized functions for overlay filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pw_128: times 8 dw 128
+pw_255: times 8 dw 255
+pw_257: times 8 dw 257
+
+SECTION .text
+
+; m0 = src words, m1 = dst words, m2 = alpha words
+; dst = FAST_DIV255(dst * (255 - alpha) + src * alpha), packed into the low half of m0
+%macro BLEND 0
+    pmullw          m0, m2
+    pxor            m2, m4
+    pmullw          m1, m2
+    paddw           m0, m1
+    paddw           m0, m5
+    pmulhuw         m0, m6
+    packuswb        m0, m0
+%endmacro
+
+INIT_XMM sse2
+; int ff_overlay_row_444(uint8_t *dst, const uint8_t *src, const uint8_t *alpha, int w)
+cglobal overlay_row_444, 4, 5, 7, dst, src, alpha, w, x
+    movsxdifnidn    wq, wd
+    and             wq, ~(mmsize / 2 - 1)
+    jz .end
+    pxor            m3, m3
+    mova            m4, [pw_255]
+    mova            m5, [pw_128]
+    mova            m6, [pw_257]
+    add           dstq, wq
+    add           srcq, wq
+    add         alphaq, wq
+    mov             xq, wq
+    neg             xq
+
+    .loop:
+        movh            m0, [srcq + xq]
+        movh            m1, [dstq + xq]
+        movh            m2, [alphaq + xq]
+        punpcklbw       m0, m3
+        punpcklbw       m1, m3
+        punpcklbw       m2, m3
+        BLEND
+        movh   [dstq + xq], m0
+        add             xq, mmsize / 2
+    jl .loop
+
+.end:
+    mov            eax, wd
+    RET
+
+; int ff_overlay_row_420(uint8_t *dst, const uint8_t *src, const uint8_t *alpha, int w,
+;                        ptrdiff_t alpha_linesize)
+cglobal overlay_row_420, 5, 6, 8, dst, src, alpha, w, alpha2, x
+    movsxdifnidn    wq, wd
+    and             wq, ~(mmsize / 2 - 1)
+    jz .end
+    pxor            m7, m7
+    mova            m4, [pw_255]
+    mova            m5, [pw_128]
+    mova            m6, [pw_257]
+    add        alpha2q, alphaq
+    add           dstq, wq
+    add           srcq, wq
+    lea         alphaq, [alphaq + 2 * wq]
+    lea        alpha2q, [alpha2q + 2 * wq]
+    mov             xq, wq
+    neg             xq
+
+    .loop:
+        ; average each 2x2 block of alpha samples
+        movu            m2, [alphaq + 2 * xq]
+        movu            m3, [alpha2q + 2 * xq]
+        mova            m0, m2
+        mova            m1, m3
+        psrlw           m2, 8
+        psrlw           m3, 8
+        pand            m0, m4
+        pand            m1, m4
+        paddw           m2, m3
+        paddw           m0, m1
+        paddw           m2, m0
+        psrlw           m2, 2
+
+        movh            m0, [srcq + xq]
+        movh            m1, [dstq + xq]
+        punpcklbw       m0, m7
+        punpcklbw       m1, m7
+        BLEND
+        movh   [dstq + xq], m0
+        add             xq, mmsize / 2
+    jl .loop
+
+.end:
+    mov            eax, wd
+    RET
@@ -40,15 +40,32 @@ enum YADIFDeint {
     YADIF_DEINT_INTERLACED = 1, ///< only deinterlace frames marked as interlaced
 };
 
+/**
+ * Output frame waiting to be filtered, with references to the input frames
+ * it is interpolated from.
+ */
+typedef struct YADIFQueuedFrame {
+    AVFrame *prev;
+    AVFrame *cur;
+    AVFrame *next;
+    AVFrame *out;
+    int parity;
+    int tff;
+} YADIFQueuedFrame;
+
 typedef struct YADIFContext {
     const AVClass *class;
 
     int mode;           ///< YADIFMode
     int parity;         ///< YADIFParity
     int deint;          ///< YADIFDeint
+    int batch;          ///< number of output frames filtered together
 
     int frame_pending;
 
+    YADIFQueuedFrame *queued;
+    int nb_queued;
+
     AVFrame *cur;
     AVFrame *next;
     AVFrame *prev;
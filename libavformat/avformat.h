@@ -1895,6 +1895,11 @@ typedef struct AVFormatContext {
      * additional internal format contexts. Thus the AVFormatContext pointer
      * passed to this callback may be different from the one facing the caller.
      * It will, however, have the same 'opaque' field.
+     *
+     * @note Some formats call this callback and io_close() from their own
+     * threads when configured to do so, e.g. the hls demuxer with the
+     * prefetch_segments option or the hls muxer with the hls_segment_writers
+     * option. The callbacks must be thread safe then.
      */
     int (*io_open)(struct AVFormatContext *s, AVIOContext **pb, const char *url,
                    int flags, AVDictionary **options);
@@ -1917,6 +1922,15 @@ typedef struct AVFormatContext {
      * - decoding: set by user
      */
     int max_streams;
+
+    /**
+     * Number of threads used to decode the packets read by
+     * avformat_find_stream_info(), 0 for automatic. With more than one
+     * thread, the packets of different streams are decoded concurrently.
+     * - encoding: unused
+     * - decoding: set by user
+     */
+    int probe_threads;
 } AVFormatContext;
 
 /**
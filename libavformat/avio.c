@@ -57,6 +57,7 @@ static const AVOption options[] = {
     {"protocol_whitelist", "List of protocols that are allowed to be used", OFFSET(protocol_whitelist), AV_OPT_TYPE_STRING, { .str = NULL },  CHAR_MIN, CHAR_MAX, D },
     {"protocol_blacklist", "List of protocols that are not allowed to be used", OFFSET(protocol_blacklist), AV_OPT_TYPE_STRING, { .str = NULL },  CHAR_MIN, CHAR_MAX, D },
     {"rw_timeout", "Timeout for IO operations (in microseconds)", offsetof(URLContext, rw_timeout), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, AV_OPT_FLAG_ENCODING_PARAM | AV_OPT_FLAG_DECODING_PARAM },
+    {"async_write_depth", "Number of buffers queued for writing by a background thread", OFFSET(async_write_depth), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 64, E },
     { NULL }
 };
 
@@ -650,6 +651,13 @@ int ffurl_get_short_seek(URLContext *h)
     return h->prot->url_get_short_seek(h);
 }
 
+int ffurl_get_buffer(URLContext *h, int64_t pos, int size, AVBufferRef **buf)
+{
+    if (!h->prot->url_get_buffer)
+        return AVERROR(ENOSYS);
+    return h->prot->url_get_buffer(h, pos, size, buf);
+}
+
 int ffurl_shutdown(URLContext *h, int flags)
 {
     if (!h->prot->url_shutdown)
@@ -53,6 +53,21 @@ int ffio_init_context(AVIOContext *s,
  */
 int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsigned char **data);
 
+/**
+ * Read size bytes from AVIOContext as a reference to memory owned by the
+ * underlying protocol, without copying them. This is only possible if the
+ * protocol has the data in memory anyway, see ffurl_get_buffer(). Nothing is
+ * read if the function fails, so the caller can then fall back to a regular
+ * read.
+ *
+ * @param buf set to the new reference on success, followed by at least
+ *            AV_INPUT_BUFFER_PADDING_SIZE readable bytes, zeroed unless
+ *            the protocol was told not to require it
+ * @return size on success, AVERROR(ENOSYS) if the data is not available
+ *         this way, another negative error code on failure
+ */
+int ffio_read_buffer_ref(AVIOContext *s, AVBufferRef **buf, int size);
+
 void ffio_fill(AVIOContext *s, int b, int count);
 
 static av_always_inline void ffio_wfourcc(AVIOContext *pb, const uint8_t *s)
@@ -132,6 +147,15 @@ int ffio_open_dyn_packet_buf(AVIOContext **s, int max_packet_size);
  */
 int ffio_fdopen(AVIOContext **s, URLContext *h);
 
+/**
+ * Return the URLContext associated with the AVIOContext
+ *
+ * @param s IO context
+ * @return pointer to URLContext or NULL if the AVIOContext was not opened
+ * with ffio_fdopen(), e.g. when a custom io_open callback is used.
+ */
+URLContext *ffio_geturlcontext(AVIOContext *s);
+
 /**
  * Open a write-only fake memory stream. The written data is not stored
  * anywhere - this is only used for measuring the amount of data
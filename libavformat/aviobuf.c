@@ -26,6 +26,7 @@
 #include "libavutil/log.h"
 #include "libavutil/opt.h"
 #include "libavutil/avassert.h"
+#include "libavutil/thread.h"
 #include "avformat.h"
 #include "avio.h"
 #include "avio_internal.h"
@@ -42,8 +43,31 @@
  */
 #define SHORT_SEEK_THRESHOLD 4096
 
+typedef struct AVIOWriteBuffer {
+    uint8_t *data;
+    unsigned int alloc_size;
+    int size;
+} AVIOWriteBuffer;
+
 typedef struct AVIOInternal {
     URLContext *h;
+#if HAVE_THREADS
+    /**
+     * Asynchronous writing: the data passed to write_packet is copied into
+     * one of nb_buffers buffers and written out by a background thread.
+     * Buffers [first_buffer, first_buffer + nb_queued) are waiting.
+     */
+    AVIOWriteBuffer *buffers;
+    int nb_buffers;
+    int first_buffer;
+    int nb_queued;
+    int write_error;
+    int write_exit;
+    pthread_t write_thread;
+    pthread_mutex_t write_mutex;
+    pthread_cond_t write_cond;  ///< signaled when a buffer is queued
+    pthread_cond_t done_cond;   ///< signaled when a buffer is written out
+#endif
 } AVIOInternal;
 
 static void *ff_avio_child_next(void *obj, void *prev)
@@ -77,6 +101,10 @@ const AVClass ff_avio_class = {
 
 static void fill_buffer(AVIOContext *s);
 static int url_resetbuf(AVIOContext *s, int flags);
+#if HAVE_THREADS
+static int io_write_packet_async(void *opaque, uint8_t *buf, int buf_size);
+static int async_write_wait(AVIOInternal *internal);
+#endif
 
 int ffio_init_context(AVIOContext *s,
                   unsigned char *buffer,
@@ -233,14 +261,31 @@ void avio_write(AVIOContext *s, const unsigned char *buf, int size)
     }
 }
 
-void avio_flush(AVIOContext *s)
+/**
+ * Write out the buffer.
+ * @param wait if set and writing asynchronously, also wait for the queued
+ *             data to reach the protocol, as when writing synchronously
+ */
+static void flush_buffer_seekback(AVIOContext *s, int wait)
 {
     int seekback = s->write_flag ? FFMIN(0, s->buf_ptr - s->buf_ptr_max) : 0;
     flush_buffer(s);
+#if HAVE_THREADS
+    if (wait && s->write_packet == io_write_packet_async) {
+        int ret = async_write_wait(s->opaque);
+        if (ret < 0 && !s->error)
+            s->error = ret;
+    }
+#endif
     if (seekback)
         avio_seek(s, seekback, SEEK_CUR);
 }
 
+void avio_flush(AVIOContext *s)
+{
+    flush_buffer_seekback(s, 1);
+}
+
 int64_t avio_seek(AVIOContext *s, int64_t offset, int whence)
 {
     int64_t offset1;
@@ -498,8 +543,9 @@ void avio_wb24(AVIOContext *s, unsigned int val)
 void avio_write_marker(AVIOContext *s, int64_t time, enum AVIODataMarkerType type)
 {
     if (type == AVIO_DATA_MARKER_FLUSH_POINT) {
+        /* hand the data to the writing thread, but do not wait for it */
         if (s->buf_ptr - s->buffer >= s->min_packet_size)
-            avio_flush(s);
+            flush_buffer_seekback(s, 0);
         return;
     }
     if (!s->write_data_type)
@@ -913,11 +959,209 @@ static int64_t io_read_seek(void *opaque, int stream_index, int64_t timestamp, i
     return internal->h->prot->url_read_seek(internal->h, stream_index, timestamp, flags);
 }
 
+#if HAVE_THREADS
+static void *async_write_thread(void *arg)
+{
+    AVIOInternal *internal = arg;
+
+    pthread_mutex_lock(&internal->write_mutex);
+    for (;;) {
+        AVIOWriteBuffer *buf;
+        int ret = 0;
+
+        while (!internal->nb_queued && !internal->write_exit)
+            pthread_cond_wait(&internal->write_cond, &internal->write_mutex);
+        if (!internal->nb_queued)
+            break;
+
+        /* after an error, the remaining data is dropped */
+        buf = &internal->buffers[internal->first_buffer];
+        if (!internal->write_error) {
+            pthread_mutex_unlock(&internal->write_mutex);
+            ret = ffurl_write(internal->h, buf->data, buf->size);
+            pthread_mutex_lock(&internal->write_mutex);
+        }
+        if (ret < 0)
+            internal->write_error = ret;
+        internal->first_buffer = (internal->first_buffer + 1) % internal->nb_buffers;
+        internal->nb_queued--;
+        pthread_cond_signal(&internal->done_cond);
+    }
+    pthread_mutex_unlock(&internal->write_mutex);
+
+    return NULL;
+}
+
+static int async_write_init(AVIOInternal *internal, int nb_buffers)
+{
+    int ret;
+
+    internal->buffers = av_mallocz_array(nb_buffers, sizeof(*internal->buffers));
+    if (!internal->buffers)
+        return AVERROR(ENOMEM);
+    internal->nb_buffers = nb_buffers;
+
+    pthread_mutex_init(&internal->write_mutex, NULL);
+    pthread_cond_init(&internal->write_cond, NULL);
+    pthread_cond_init(&internal->done_cond, NULL);
+
+    ret = pthread_create(&internal->write_thread, NULL, async_write_thread, internal);
+    if (ret) {
+        pthread_mutex_destroy(&internal->write_mutex);
+        pthread_cond_destroy(&internal->write_cond);
+        pthread_cond_destroy(&internal->done_cond);
+        av_freep(&internal->buffers);
+        internal->nb_buffers = 0;
+        return AVERROR(ret);
+    }
+    return 0;
+}
+
+/**
+ * Write out the queued data and stop the writing thread.
+ * @return the first write error, if any
+ */
+static int async_write_uninit(AVIOInternal *internal)
+{
+    int i;
+
+    if (!internal->nb_buffers)
+        return 0;
+
+    pthread_mutex_lock(&internal->write_mutex);
+    internal->write_exit = 1;
+    pthread_cond_signal(&internal->write_cond);
+    pthread_mutex_unlock(&internal->write_mutex);
+    pthread_join(internal->write_thread, NULL);
+
+    pthread_mutex_destroy(&internal->write_mutex);
+    pthread_cond_destroy(&internal->write_cond);
+    pthread_cond_destroy(&internal->done_cond);
+    for (i = 0; i < internal->nb_buffers; i++)
+        av_freep(&internal->buffers[i].data);
+    av_freep(&internal->buffers);
+    internal->nb_buffers = 0;
+
+    return internal->write_error;
+}
+
+/**
+ * Wait for the queued data to be written out.
+ * @return the first write error, if any
+ */
+static int async_write_wait(AVIOInternal *internal)
+{
+    int ret;
+
+    pthread_mutex_lock(&internal->write_mutex);
+    while (internal->nb_queued)
+        pthread_cond_wait(&internal->done_cond, &internal->write_mutex);
+    ret = internal->write_error;
+    pthread_mutex_unlock(&internal->write_mutex);
+
+    return ret;
+}
+
+static int io_write_packet_async(void *opaque, uint8_t *buf, int buf_size)
+{
+    AVIOInternal *internal = opaque;
+    AVIOWriteBuffer *wbuf;
+    int ret;
+
+    pthread_mutex_lock(&internal->write_mutex);
+    while (internal->nb_queued == internal->nb_buffers && !internal->write_error)
+        pthread_cond_wait(&internal->done_cond, &internal->write_mutex);
+    ret  = internal->write_error;
+    wbuf = &internal->buffers[(internal->first_buffer + internal->nb_queued) %
+                              internal->nb_buffers];
+    pthread_mutex_unlock(&internal->write_mutex);
+    if (ret < 0)
+        return ret;
+
+    /* the buffer is not used by the writing thread until it is queued */
+    av_fast_malloc(&wbuf->data, &wbuf->alloc_size, buf_size);
+    if (!wbuf->data)
+        return AVERROR(ENOMEM);
+    memcpy(wbuf->data, buf, buf_size);
+    wbuf->size = buf_size;
+
+    pthread_mutex_lock(&internal->write_mutex);
+    internal->nb_queued++;
+    pthread_cond_signal(&internal->write_cond);
+    pthread_mutex_unlock(&internal->write_mutex);
+
+    return buf_size;
+}
+
+static int64_t io_seek_async(void *opaque, int64_t offset, int whence)
+{
+    AVIOInternal *internal = opaque;
+    int ret = async_write_wait(internal);
+
+    if (ret < 0)
+        return ret;
+    return ffurl_seek(internal->h, offset, whence);
+}
+#endif
+
+URLContext *ffio_geturlcontext(AVIOContext *s)
+{
+    AVIOInternal *internal;
+
+    if (!s)
+        return NULL;
+
+    internal = s->opaque;
+    if (internal && s->read_packet == io_read_packet)
+        return internal->h;
+    return NULL;
+}
+
+int ffio_read_buffer_ref(AVIOContext *s, AVBufferRef **buf, int size)
+{
+    AVIOInternal *internal;
+    int64_t pos, end;
+    int ret;
+
+    /* only plain URL contexts can be bypassed */
+    if (s->read_packet != io_read_packet || s->write_flag ||
+        s->update_checksum || size <= 0)
+        return AVERROR(ENOSYS);
+    internal = s->opaque;
+
+    pos = avio_tell(s);
+    if (pos < 0)
+        return pos;
+    ret = ffurl_get_buffer(internal->h, pos, size, buf);
+    if (ret < 0)
+        return ret;
+
+    /* skip the data as avio_seek() would, but never read it into the
+     * buffer on the way */
+    end = pos + size;
+    if (end <= s->pos) {
+        s->buf_ptr += size;
+    } else {
+        int64_t res = s->seek(s->opaque, end, SEEK_SET);
+        if (res < 0) {
+            av_buffer_unref(buf);
+            return res;
+        }
+        s->bytes_read += end - s->pos;
+        s->buf_end = s->buf_ptr = s->buf_ptr_max = s->buffer;
+        s->pos = end;
+    }
+    s->eof_reached = 0;
+    return size;
+}
+
 int ffio_fdopen(AVIOContext **s, URLContext *h)
 {
     AVIOInternal *internal = NULL;
     uint8_t *buffer = NULL;
     int buffer_size, max_packet_size;
+    int (*write_packet)(void *opaque, uint8_t *buf, int buf_size) = io_write_packet;
+    int64_t (*seek)(void *opaque, int64_t offset, int whence)     = io_seek;
 
     max_packet_size = h->max_packet_size;
     if (max_packet_size) {
@@ -935,8 +1179,18 @@ int ffio_fdopen(AVIOContext **s, URLContext *h)
 
     internal->h = h;
 
+#if HAVE_THREADS
+    if (h->async_write_depth > 0 &&
+        (h->flags & AVIO_FLAG_READ_WRITE) == AVIO_FLAG_WRITE) {
+        if (async_write_init(internal, h->async_write_depth) < 0)
+            goto fail;
+        write_packet = io_write_packet_async;
+        seek         = io_seek_async;
+    }
+#endif
+
     *s = avio_alloc_context(buffer, buffer_size, h->flags & AVIO_FLAG_WRITE,
-                            internal, io_read_packet, io_write_packet, io_seek);
+                            internal, io_read_packet, write_packet, seek);
     if (!*s)
         goto fail;
 
@@ -966,6 +1220,10 @@ int ffio_fdopen(AVIOContext **s, URLContext *h)
     (*s)->av_class = &ff_avio_class;
     return 0;
 fail:
+#if HAVE_THREADS
+    if (internal)
+        async_write_uninit(internal);
+#endif
     av_freep(&internal);
     av_freep(&buffer);
     return AVERROR(ENOMEM);
@@ -1113,6 +1371,7 @@ int avio_close(AVIOContext *s)
 {
     AVIOInternal *internal;
     URLContext *h;
+    int write_ret = 0, ret;
 
     if (!s)
         return 0;
@@ -1120,6 +1379,9 @@ int avio_close(AVIOContext *s)
     avio_flush(s);
     internal = s->opaque;
     h        = internal->h;
+#if HAVE_THREADS
+    write_ret = async_write_uninit(internal);
+#endif
 
     av_freep(&s->opaque);
     av_freep(&s->buffer);
@@ -1131,7 +1393,8 @@ int avio_close(AVIOContext *s)
 
     avio_context_free(&s);
 
-    return ffurl_close(h);
+    ret = ffurl_close(h);
+    return write_ret < 0 ? write_ret : ret;
 }
 
 int avio_closep(AVIOContext **s)
@@ -38,9 +38,13 @@
 #include "internal.h"
 #include "isom.h"
 #include "os_support.h"
+#include "segindex.h"
 #include "url.h"
 #include "dash.h"
 
+#define DASH_INDEX_TAG MKBETAG('D', 'S', 'H', 'I')
+#define DASH_INDEX_VERSION 1
+
 typedef struct Segment {
     char file[1024];
     int64_t start_pos;
@@ -63,6 +67,11 @@ typedef struct OutputStream {
     Segment **segments;
     int64_t first_pts, start_pts, max_pts;
     int64_t last_dts;
+    int64_t resume_pts, pts_offset;
+    int segment_started;
+    int64_t segment_start_pos;
+    char segment_file[1024], segment_path[1024], segment_temp_path[1024];
+    int64_t chunk_duration;
     int bit_rate;
     char bandwidth_str[64];
 
@@ -90,6 +99,8 @@ typedef struct DASHContext {
     AVRational min_frame_rate, max_frame_rate;
     int ambiguous_frame_rate;
     const char *utc_timing_url;
+    int resume_index;
+    int streaming;
 } DASHContext;
 
 static int dash_write(void *opaque, uint8_t *buf, int buf_size)
@@ -188,7 +199,8 @@ static void dash_free(AVFormatContext *s)
     av_freep(&c->streams);
 }
 
-static void output_segment_list(OutputStream *os, AVIOContext *out, DASHContext *c)
+static void output_segment_list(OutputStream *os, AVIOContext *out, DASHContext *c,
+                                int final)
 {
     int i, start_index = 0, start_number = 1;
     if (c->window_size) {
@@ -201,6 +213,14 @@ static void output_segment_list(OutputStream *os, AVIOContext *out, DASHContext
         avio_printf(out, "\t\t\t\t<SegmentTemplate timescale=\"%d\" ", timescale);
         if (!c->use_timeline)
             avio_printf(out, "duration=\"%"PRId64"\" ", c->last_duration);
+        // Segments can be requested as soon as their first chunk is written,
+        // the last one is still incomplete until the manifest becomes static
+        if (c->streaming && c->last_duration > os->chunk_duration) {
+            avio_printf(out, "availabilityTimeOffset=\"%.3f\" ",
+                        (double)(c->last_duration - os->chunk_duration) / AV_TIME_BASE);
+            if (!final)
+                avio_printf(out, "availabilityTimeComplete=\"false\" ");
+        }
         avio_printf(out, "initialization=\"%s\" media=\"%s\" startNumber=\"%d\">\n", c->init_seg_name, c->media_seg_name, c->use_timeline ? start_number : 1);
         if (c->use_timeline) {
             int64_t cur_time = 0;
@@ -411,7 +431,7 @@ static int write_manifest(AVFormatContext *s, int final)
                 avio_printf(out, " frameRate=\"%d/%d\"", st->avg_frame_rate.num, st->avg_frame_rate.den);
             avio_printf(out, ">\n");
 
-            output_segment_list(&c->streams[i], out, c);
+            output_segment_list(&c->streams[i], out, c, final);
             avio_printf(out, "\t\t\t</Representation>\n");
         }
         avio_printf(out, "\t\t</AdaptationSet>\n");
@@ -427,7 +447,7 @@ static int write_manifest(AVFormatContext *s, int final)
 
             avio_printf(out, "\t\t\t<Representation id=\"%d\" mimeType=\"audio/mp4\" codecs=\"%s\"%s audioSamplingRate=\"%d\">\n", i, os->codec_str, os->bandwidth_str, st->codecpar->sample_rate);
             avio_printf(out, "\t\t\t\t<AudioChannelConfiguration schemeIdUri=\"urn:mpeg:dash:23003:3:audio_channel_configuration:2011\" value=\"%d\" />\n", st->codecpar->channels);
-            output_segment_list(&c->streams[i], out, c);
+            output_segment_list(&c->streams[i], out, c, final);
             avio_printf(out, "\t\t\t</Representation>\n");
         }
         avio_printf(out, "\t\t</AdaptationSet>\n");
@@ -443,6 +463,181 @@ static int write_manifest(AVFormatContext *s, int final)
     return 0;
 }
 
+static int add_segment(OutputStream *os, const char *file,
+                       int64_t time, int duration,
+                       int64_t start_pos, int64_t range_length,
+                       int64_t index_length)
+{
+    int err;
+    Segment *seg;
+    if (os->nb_segments >= os->segments_size) {
+        os->segments_size = (os->segments_size + 1) * 2;
+        if ((err = av_reallocp(&os->segments, sizeof(*os->segments) *
+                               os->segments_size)) < 0) {
+            os->segments_size = 0;
+            os->nb_segments = 0;
+            return err;
+        }
+    }
+    seg = av_mallocz(sizeof(*seg));
+    if (!seg)
+        return AVERROR(ENOMEM);
+    av_strlcpy(seg->file, file, sizeof(seg->file));
+    seg->time = time;
+    seg->duration = duration;
+    if (seg->time < 0) { // If pts<0, it is expected to be cut away with an edit list
+        seg->duration += seg->time;
+        seg->time = 0;
+    }
+    seg->start_pos = start_pos;
+    seg->range_length = range_length;
+    seg->index_length = index_length;
+    os->segments[os->nb_segments++] = seg;
+    os->segment_index++;
+    return 0;
+}
+
+/* Write the segment lists of all representations to <manifest>.idx,
+ * to be picked up by read_segment_index() when restarting. */
+static int write_segment_index(AVFormatContext *s)
+{
+    DASHContext *c = s->priv_data;
+    AVIOContext *out;
+    char index_filename[sizeof(s->filename) + 4], temp_filename[sizeof(s->filename) + 8];
+    const char *proto = avio_find_protocol_name(s->filename);
+    int use_rename = proto && !strcmp(proto, "file");
+    int ret, i, j;
+
+    snprintf(index_filename, sizeof(index_filename), "%s.idx", s->filename);
+    snprintf(temp_filename, sizeof(temp_filename), use_rename ? "%s.tmp" : "%s", index_filename);
+    ret = s->io_open(s, &out, temp_filename, AVIO_FLAG_WRITE, NULL);
+    if (ret < 0) {
+        av_log(s, AV_LOG_ERROR, "Unable to open %s for writing\n", temp_filename);
+        return ret;
+    }
+
+    avio_wb32(out, DASH_INDEX_TAG);
+    avio_wb32(out, DASH_INDEX_VERSION);
+    ff_segindex_write_string(out, c->availability_start_time);
+    avio_wb64(out, c->last_duration);
+    avio_wb32(out, s->nb_streams);
+    for (i = 0; i < s->nb_streams; i++) {
+        OutputStream *os = &c->streams[i];
+        AVRational time_base = os->ctx->streams[0]->time_base;
+
+        avio_wb32(out, os->segment_index);
+        avio_wb32(out, time_base.num);
+        avio_wb32(out, time_base.den);
+        avio_wb32(out, os->nb_segments);
+        for (j = 0; j < os->nb_segments; j++) {
+            Segment *seg = os->segments[j];
+            avio_wb64(out, seg->time);
+            avio_wb32(out, seg->duration);
+            avio_wb64(out, seg->start_pos);
+            avio_wb32(out, seg->range_length);
+            avio_wb32(out, seg->index_length);
+            ff_segindex_write_string(out, seg->file);
+        }
+    }
+    avio_flush(out);
+    ret = out->error;
+    ff_format_io_close(s, &out);
+
+    if (ret >= 0 && use_rename)
+        ret = avpriv_io_move(temp_filename, index_filename);
+    return ret;
+}
+
+/* Restore the segment lists from the index written by a previous run, so
+ * that the manifest keeps listing them and segment numbering continues. */
+static int read_segment_index(AVFormatContext *s)
+{
+    DASHContext *c = s->priv_data;
+    AVIOContext *in;
+    char index_filename[sizeof(s->filename) + 4];
+    int ret, i, j;
+
+    snprintf(index_filename, sizeof(index_filename), "%s.idx", s->filename);
+    ret = s->io_open(s, &in, index_filename, AVIO_FLAG_READ, NULL);
+    if (ret < 0)
+        return ret == AVERROR(ENOENT) ? 0 : ret;
+
+    if (avio_rb32(in) != DASH_INDEX_TAG || avio_rb32(in) != DASH_INDEX_VERSION ||
+        (ret = ff_segindex_read_string(in, c->availability_start_time,
+                                 sizeof(c->availability_start_time))) < 0) {
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
+    }
+    c->last_duration = avio_rb64(in);
+    if (avio_rb32(in) != s->nb_streams) {
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
+    }
+    for (i = 0; i < s->nb_streams; i++) {
+        OutputStream *os = &c->streams[i];
+        AVRational time_base = os->ctx->streams[0]->time_base, index_time_base;
+        int segment_index = avio_rb32(in), nb_segments;
+
+        index_time_base.num = avio_rb32(in);
+        index_time_base.den = avio_rb32(in);
+        nb_segments = avio_rb32(in);
+        if (index_time_base.num <= 0 || index_time_base.den <= 0 ||
+            nb_segments < 0 || nb_segments > SEGINDEX_MAX_ENTRIES ||
+            segment_index < nb_segments || avio_feof(in)) {
+            ret = AVERROR_INVALIDDATA;
+            goto fail;
+        }
+        for (j = 0; j < nb_segments; j++) {
+            char file[sizeof(os->segments[0]->file)];
+            int64_t time = avio_rb64(in), start_pos;
+            int duration = avio_rb32(in), range_length, index_length;
+
+            start_pos    = avio_rb64(in);
+            range_length = avio_rb32(in);
+            index_length = avio_rb32(in);
+            if ((ret = ff_segindex_read_string(in, file, sizeof(file))) < 0)
+                goto fail;
+            if (av_cmp_q(time_base, index_time_base)) {
+                time     = av_rescale_q(time,     index_time_base, time_base);
+                duration = av_rescale_q(duration, index_time_base, time_base);
+            }
+            if ((ret = add_segment(os, file, time, duration, start_pos,
+                                   range_length, index_length)) < 0)
+                goto fail;
+        }
+        os->segment_index = segment_index;
+        if (os->nb_segments) {
+            Segment *seg = os->segments[os->nb_segments - 1];
+            os->resume_pts = seg->time + seg->duration;
+            c->total_duration = FFMAX(c->total_duration,
+                                      av_rescale_q(os->resume_pts - os->segments[0]->time,
+                                                   time_base, AV_TIME_BASE_Q));
+        }
+    }
+    if (avio_feof(in)) {
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
+    }
+    av_log(s, AV_LOG_VERBOSE, "Resumed the segment lists from %s\n", index_filename);
+
+fail:
+    ff_format_io_close(s, &in);
+    if (ret < 0) {
+        for (i = 0; i < s->nb_streams; i++) {
+            OutputStream *os = &c->streams[i];
+            for (j = 0; j < os->nb_segments; j++)
+                av_freep(&os->segments[j]);
+            os->nb_segments = 0;
+            os->segment_index = 1;
+            os->resume_pts = AV_NOPTS_VALUE;
+        }
+        c->availability_start_time[0] = '\0';
+        c->last_duration = 0;
+        c->total_duration = 0;
+    }
+    return ret;
+}
+
 static int set_bitrate(AVFormatContext *s)
 {
     DASHContext *c = s->priv_data;
@@ -550,7 +745,8 @@ static int dash_init(AVFormatContext *s)
             return ret;
         os->init_start_pos = 0;
 
-        av_dict_set(&opts, "movflags", "frag_custom+dash+delay_moov", 0);
+        av_dict_set(&opts, "movflags", c->streaming ? "frag_custom+dash+delay_moov+skip_sidx" :
+                                                      "frag_custom+dash+delay_moov", 0);
         if ((ret = avformat_init_output(ctx, &opts)) < 0)
             return ret;
         os->ctx_inited = 1;
@@ -583,6 +779,7 @@ static int dash_init(AVFormatContext *s)
         os->first_pts = AV_NOPTS_VALUE;
         os->max_pts = AV_NOPTS_VALUE;
         os->last_dts = AV_NOPTS_VALUE;
+        os->resume_pts = AV_NOPTS_VALUE;
         os->segment_index = 1;
     }
 
@@ -590,6 +787,17 @@ static int dash_init(AVFormatContext *s)
         av_log(s, AV_LOG_WARNING, "no video stream and no min seg duration set\n");
         return AVERROR(EINVAL);
     }
+
+    if (c->resume_index) {
+        if (c->single_file) {
+            av_log(s, AV_LOG_WARNING, "resume_index is not supported with single_file, "
+                   "the segment lists will not be resumed\n");
+            c->resume_index = 0;
+        } else if ((ret = read_segment_index(s)) < 0) {
+            av_log(s, AV_LOG_WARNING, "Could not read the segment index of %s: %s, "
+                   "starting new segment lists\n", s->filename, av_err2str(ret));
+        }
+    }
     return 0;
 }
 
@@ -610,48 +818,15 @@ static int dash_write_header(AVFormatContext *s)
     return ret;
 }
 
-static int add_segment(OutputStream *os, const char *file,
-                       int64_t time, int duration,
-                       int64_t start_pos, int64_t range_length,
-                       int64_t index_length)
-{
-    int err;
-    Segment *seg;
-    if (os->nb_segments >= os->segments_size) {
-        os->segments_size = (os->segments_size + 1) * 2;
-        if ((err = av_reallocp(&os->segments, sizeof(*os->segments) *
-                               os->segments_size)) < 0) {
-            os->segments_size = 0;
-            os->nb_segments = 0;
-            return err;
-        }
-    }
-    seg = av_mallocz(sizeof(*seg));
-    if (!seg)
-        return AVERROR(ENOMEM);
-    av_strlcpy(seg->file, file, sizeof(seg->file));
-    seg->time = time;
-    seg->duration = duration;
-    if (seg->time < 0) { // If pts<0, it is expected to be cut away with an edit list
-        seg->duration += seg->time;
-        seg->time = 0;
-    }
-    seg->start_pos = start_pos;
-    seg->range_length = range_length;
-    seg->index_length = index_length;
-    os->segments[os->nb_segments++] = seg;
-    os->segment_index++;
-    return 0;
-}
-
-static void write_styp(AVIOContext *pb)
+static void write_styp(AVIOContext *pb, int sidx)
 {
-    avio_wb32(pb, 24);
+    avio_wb32(pb, sidx ? 24 : 20);
     ffio_wfourcc(pb, "styp");
     ffio_wfourcc(pb, "msdh");
     avio_wb32(pb, 0); /* minor */
     ffio_wfourcc(pb, "msdh");
-    ffio_wfourcc(pb, "msix");
+    if (sidx)
+        ffio_wfourcc(pb, "msix");
 }
 
 static void find_index_range(AVFormatContext *s, const char *full_path,
@@ -700,22 +875,52 @@ static int update_stream_extradata(AVFormatContext *s, OutputStream *os,
     return 0;
 }
 
+/* Write the init segment if needed, and open the file of the next media
+ * segment of os. */
+static int start_segment(AVFormatContext *s, OutputStream *os, int i)
+{
+    DASHContext *c = s->priv_data;
+    const char *proto = avio_find_protocol_name(s->filename);
+    // In streaming mode, segments are read while they are being written
+    int use_rename = !c->streaming && proto && !strcmp(proto, "file");
+    int ret;
+
+    if (!os->init_range_length) {
+        av_write_frame(os->ctx, NULL);
+        os->init_range_length = avio_tell(os->ctx->pb);
+        if (!c->single_file)
+            ff_format_io_close(s, &os->out);
+    }
+
+    os->segment_start_pos = avio_tell(os->ctx->pb);
+
+    if (!c->single_file) {
+        ff_dash_fill_tmpl_params(os->segment_file, sizeof(os->segment_file), c->media_seg_name, i, os->segment_index, os->bit_rate, os->start_pts);
+        snprintf(os->segment_path, sizeof(os->segment_path), "%s%s", c->dirname, os->segment_file);
+        snprintf(os->segment_temp_path, sizeof(os->segment_temp_path), use_rename ? "%s.tmp" : "%s", os->segment_path);
+        ret = s->io_open(s, &os->out, os->segment_temp_path, AVIO_FLAG_WRITE, NULL);
+        if (ret < 0)
+            return ret;
+        write_styp(os->ctx->pb, !c->streaming);
+    } else {
+        os->segment_file[0] = '\0';
+        snprintf(os->segment_path, sizeof(os->segment_path), "%s%s", c->dirname, os->initfile);
+    }
+    os->segment_started = 1;
+    return 0;
+}
+
 static int dash_flush(AVFormatContext *s, int final, int stream)
 {
     DASHContext *c = s->priv_data;
     int i, ret = 0;
 
-    const char *proto = avio_find_protocol_name(s->filename);
-    int use_rename = proto && !strcmp(proto, "file");
-
     int cur_flush_segment_index = 0;
     if (stream >= 0)
         cur_flush_segment_index = c->streams[stream].segment_index;
 
     for (i = 0; i < s->nb_streams; i++) {
         OutputStream *os = &c->streams[i];
-        char filename[1024] = "", full_path[1024], temp_path[1024];
-        int64_t start_pos;
         int range_length, index_length = 0;
 
         if (!os->packets_written)
@@ -733,45 +938,28 @@ static int dash_flush(AVFormatContext *s, int final, int stream)
                 continue;
         }
 
-        if (!os->init_range_length) {
-            av_write_frame(os->ctx, NULL);
-            os->init_range_length = avio_tell(os->ctx->pb);
-            if (!c->single_file)
-                ff_format_io_close(s, &os->out);
-        }
-
-        start_pos = avio_tell(os->ctx->pb);
-
-        if (!c->single_file) {
-            ff_dash_fill_tmpl_params(filename, sizeof(filename), c->media_seg_name, i, os->segment_index, os->bit_rate, os->start_pts);
-            snprintf(full_path, sizeof(full_path), "%s%s", c->dirname, filename);
-            snprintf(temp_path, sizeof(temp_path), use_rename ? "%s.tmp" : "%s", full_path);
-            ret = s->io_open(s, &os->out, temp_path, AVIO_FLAG_WRITE, NULL);
-            if (ret < 0)
-                break;
-            write_styp(os->ctx->pb);
-        } else {
-            snprintf(full_path, sizeof(full_path), "%s%s", c->dirname, os->initfile);
-        }
+        if (!os->segment_started && (ret = start_segment(s, os, i)) < 0)
+            break;
 
         av_write_frame(os->ctx, NULL);
         avio_flush(os->ctx->pb);
         os->packets_written = 0;
+        os->segment_started = 0;
 
-        range_length = avio_tell(os->ctx->pb) - start_pos;
+        range_length = avio_tell(os->ctx->pb) - os->segment_start_pos;
         if (c->single_file) {
-            find_index_range(s, full_path, start_pos, &index_length);
+            find_index_range(s, os->segment_path, os->segment_start_pos, &index_length);
         } else {
             ff_format_io_close(s, &os->out);
 
-            if (use_rename) {
-                ret = avpriv_io_move(temp_path, full_path);
+            if (strcmp(os->segment_temp_path, os->segment_path)) {
+                ret = avpriv_io_move(os->segment_temp_path, os->segment_path);
                 if (ret < 0)
                     break;
             }
         }
-        add_segment(os, filename, os->start_pts, os->max_pts - os->start_pts, start_pos, range_length, index_length);
-        av_log(s, AV_LOG_VERBOSE, "Representation %d media segment %d written to: %s\n", i, os->segment_index, full_path);
+        add_segment(os, os->segment_file, os->start_pts, os->max_pts - os->start_pts, os->segment_start_pos, range_length, index_length);
+        av_log(s, AV_LOG_VERBOSE, "Representation %d media segment %d written to: %s\n", i, os->segment_index, os->segment_path);
     }
 
     if (c->window_size || (final && c->remove_at_exit)) {
@@ -796,6 +984,8 @@ static int dash_flush(AVFormatContext *s, int final, int stream)
 
     if (ret >= 0)
         ret = write_manifest(s, final);
+    if (ret >= 0 && c->resume_index)
+        ret = write_segment_index(s);
     return ret;
 }
 
@@ -828,8 +1018,37 @@ static int dash_write_packet(AVFormatContext *s, AVPacket *pkt)
         pkt->dts  = 0;
     }
 
-    if (os->first_pts == AV_NOPTS_VALUE)
-        os->first_pts = pkt->pts;
+    // When resuming, continue the restored timeline rather than going back
+    // in time if the new timestamps start earlier. Note that the rewritten
+    // init segment has no edit list for an initial negative pts (encoder
+    // delay) any more, so the restored segments of such streams are then
+    // presented that much later than listed in the timeline.
+    if (os->first_pts == AV_NOPTS_VALUE && os->resume_pts != AV_NOPTS_VALUE &&
+        pkt->pts != AV_NOPTS_VALUE) {
+        if (pkt->pts < os->resume_pts) {
+            os->pts_offset = os->resume_pts - pkt->pts;
+            // Keep the mp4 muxer from shifting the timestamps back to 0.
+            if (os->ctx->avoid_negative_ts == AVFMT_AVOID_NEG_TS_MAKE_ZERO)
+                os->ctx->avoid_negative_ts = AVFMT_AVOID_NEG_TS_MAKE_NON_NEGATIVE;
+        }
+        // The fragments continue an earlier stream, have the mp4 muxer start
+        // the decode times at the first timestamp instead of at 0.
+        if ((ret = av_opt_set(os->ctx->priv_data, "movflags", "+frag_discont", 0)) < 0)
+            return ret;
+    }
+    if (os->pts_offset) {
+        pkt->pts += os->pts_offset;
+        if (pkt->dts != AV_NOPTS_VALUE)
+            pkt->dts += os->pts_offset;
+    }
+
+    if (os->first_pts == AV_NOPTS_VALUE) {
+        // Count the duration from the start of the restored timeline.
+        if (os->resume_pts != AV_NOPTS_VALUE && os->nb_segments)
+            os->first_pts = os->segments[0]->time;
+        else
+            os->first_pts = pkt->pts;
+    }
 
     if ((!c->has_video || st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) &&
         pkt->flags & AV_PKT_FLAG_KEY && os->packets_written &&
@@ -871,7 +1090,20 @@ static int dash_write_packet(AVFormatContext *s, AVPacket *pkt)
     else
         os->max_pts = FFMAX(os->max_pts, pkt->pts + pkt->duration);
     os->packets_written++;
-    return ff_write_chained(os->ctx, 0, pkt, s, 0);
+    if ((ret = ff_write_chained(os->ctx, 0, pkt, s, 0)) < 0)
+        return ret;
+
+    if (c->streaming) {
+        // Write out every frame as a separate moof/mdat chunk of the segment
+        os->chunk_duration = FFMAX(os->chunk_duration,
+                                   av_rescale_q(pkt->duration, st->time_base, AV_TIME_BASE_Q));
+        if (!os->segment_started && (ret = start_segment(s, os, pkt->stream_index)) < 0)
+            return ret;
+        av_write_frame(os->ctx, NULL);
+        avio_flush(os->ctx->pb);
+        avio_flush(os->out);
+    }
+    return 0;
 }
 
 static int dash_write_trailer(AVFormatContext *s)
@@ -903,6 +1135,11 @@ static int dash_write_trailer(AVFormatContext *s)
             unlink(filename);
         }
         unlink(s->filename);
+        if (c->resume_index) {
+            char index_filename[sizeof(s->filename) + 4];
+            snprintf(index_filename, sizeof(index_filename), "%s.idx", s->filename);
+            unlink(index_filename);
+        }
     }
 
     return 0;
@@ -945,6 +1182,8 @@ static const AVOption options[] = {
     { "init_seg_name", "DASH-templated name to used for the initialization segment", OFFSET(init_seg_name), AV_OPT_TYPE_STRING, {.str = "init-stream$RepresentationID$.m4s"}, 0, 0, E },
     { "media_seg_name", "DASH-templated name to used for the media segments", OFFSET(media_seg_name), AV_OPT_TYPE_STRING, {.str = "chunk-stream$RepresentationID$-$Number%05d$.m4s"}, 0, 0, E },
     { "utc_timing_url", "URL of the page that will return the UTC timestamp in ISO format", OFFSET(utc_timing_url), AV_OPT_TYPE_STRING, { 0 }, 0, 0, E },
+    { "streaming", "Write each frame as a separate chunk of the segment as soon as it is muxed", OFFSET(streaming), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, E },
+    { "resume_index", "Keep a binary index of the segments next to the manifest and resume from it on restart", OFFSET(resume_index), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, E },
     { NULL },
 };
 
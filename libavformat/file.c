@@ -20,6 +20,7 @@
  */
 
 #include "libavutil/avstring.h"
+#include "libavutil/buffer.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "avformat.h"
@@ -33,6 +34,9 @@
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
 #include <sys/stat.h>
 #include <stdlib.h>
 #include "os_support.h"
@@ -73,6 +77,12 @@ typedef struct FileContext {
     int trunc;
     int blocksize;
     int follow;
+    int use_mmap;
+    int mmap_nonzero_padding;
+    AVBufferRef *map;     /* whole file mapping, if use_mmap */
+    uint8_t *map_data;
+    int64_t map_size;
+    int64_t map_end;      /* end of the last mapped page */
 #if HAVE_DIRENT_H
     DIR *dir;
 #endif
@@ -82,6 +92,8 @@ static const AVOption file_options[] = {
     { "truncate", "truncate existing files on write", offsetof(FileContext, trunc), AV_OPT_TYPE_BOOL, { .i64 = 1 }, 0, 1, AV_OPT_FLAG_ENCODING_PARAM },
     { "blocksize", "set I/O operation maximum block size", offsetof(FileContext, blocksize), AV_OPT_TYPE_INT, { .i64 = INT_MAX }, 1, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM },
     { "follow", "Follow a file as it is being written", offsetof(FileContext, follow), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
+    { "mmap", "map the file in memory and read packets without copying them", offsetof(FileContext, use_mmap), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
+    { "mmap_nonzero_padding", "also reference mapped packets whose padding is not zeroed", offsetof(FileContext, mmap_nonzero_padding), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { NULL }
 };
 
@@ -199,6 +211,89 @@ static int file_move(URLContext *h_src, URLContext *h_dst)
 
 #if CONFIG_FILE_PROTOCOL
 
+#if HAVE_MMAP
+static void file_unmap(void *opaque, uint8_t *data)
+{
+    munmap(data, *(size_t *)opaque);
+    av_free(opaque);
+}
+
+static int file_map(URLContext *h)
+{
+    FileContext *c = h->priv_data;
+    struct stat st;
+    size_t *size;
+    void *ptr;
+    long page_size = 4096;
+
+    if (fstat(c->fd, &st) < 0)
+        return AVERROR(errno);
+    if (!S_ISREG(st.st_mode) || st.st_size <= 0 || st.st_size > SIZE_MAX)
+        return AVERROR(EINVAL);
+
+    size = av_malloc(sizeof(*size));
+    if (!size)
+        return AVERROR(ENOMEM);
+    *size = st.st_size;
+
+    /* private and writable, so that nothing done to the packets can make it
+     * back to the file */
+    ptr = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, c->fd, 0);
+    if (ptr == MAP_FAILED) {
+        int ret = AVERROR(errno);
+        av_free(size);
+        return ret;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(ptr, *size, MADV_SEQUENTIAL);
+#endif
+
+    /* the mapping outlives the protocol context as long as packets
+     * reference it; they may not write to it */
+    c->map = av_buffer_create(ptr, FFMIN(*size, INT_MAX), file_unmap, size,
+                              AV_BUFFER_FLAG_READONLY);
+    if (!c->map) {
+        munmap(ptr, *size);
+        av_free(size);
+        return AVERROR(ENOMEM);
+    }
+#if HAVE_SYSCONF && defined(_SC_PAGESIZE)
+    page_size = sysconf(_SC_PAGESIZE);
+#endif
+    c->map_data = ptr;
+    c->map_size = *size;
+    c->map_end  = page_size > 0 ? FFALIGN(c->map_size, (int64_t)page_size) : c->map_size;
+    return 0;
+}
+#endif
+
+static int file_get_buffer(URLContext *h, int64_t pos, int size,
+                           AVBufferRef **buf)
+{
+    FileContext *c = h->priv_data;
+    int64_t end = pos + size, i;
+
+    /* The packet padding must be readable, which the mapping guarantees up
+     * to the end of the last page, zero filled past the end of the file.
+     * Unless allowed otherwise, it must also be zeroed, so the data
+     * following the packet has to be zero already; otherwise let the caller
+     * copy the packet. */
+    if (!c->map || pos < 0 || end > c->map_size ||
+        end + AV_INPUT_BUFFER_PADDING_SIZE > c->map_end)
+        return AVERROR(ENOSYS);
+    if (!c->mmap_nonzero_padding)
+        for (i = end; i < FFMIN(end + AV_INPUT_BUFFER_PADDING_SIZE, c->map_size); i++)
+            if (c->map_data[i])
+                return AVERROR(ENOSYS);
+
+    *buf = av_buffer_ref(c->map);
+    if (!*buf)
+        return AVERROR(ENOMEM);
+    (*buf)->data = c->map_data + pos;
+    (*buf)->size = size;
+    return 0;
+}
+
 static int file_open(URLContext *h, const char *filename, int flags)
 {
     FileContext *c = h->priv_data;
@@ -234,6 +329,17 @@ static int file_open(URLContext *h, const char *filename, int flags)
     if (!h->is_streamed && flags & AVIO_FLAG_WRITE)
         h->min_packet_size = h->max_packet_size = 262144;
 
+    if (c->use_mmap) {
+        int ret = AVERROR(ENOSYS);
+#if HAVE_MMAP
+        if (!h->is_streamed && !(flags & AVIO_FLAG_WRITE) && !c->follow)
+            ret = file_map(h);
+#endif
+        if (ret < 0)
+            av_log(h, AV_LOG_WARNING, "Cannot map '%s' in memory (%s), "
+                   "reading it normally\n", filename, av_err2str(ret));
+    }
+
     return 0;
 }
 
@@ -257,6 +363,7 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
 static int file_close(URLContext *h)
 {
     FileContext *c = h->priv_data;
+    av_buffer_unref(&c->map);
     return close(c->fd);
 }
 
@@ -352,6 +459,7 @@ const URLProtocol ff_file_protocol = {
     .url_seek            = file_seek,
     .url_close           = file_close,
     .url_get_file_handle = file_get_handle,
+    .url_get_buffer      = file_get_buffer,
     .url_check           = file_check,
     .url_delete          = file_delete,
     .url_move            = file_move,
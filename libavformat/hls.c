@@ -33,9 +33,11 @@
 #include "libavutil/opt.h"
 #include "libavutil/dict.h"
 #include "libavutil/time.h"
+#include "libavutil/thread.h"
 #include "avformat.h"
 #include "internal.h"
 #include "avio_internal.h"
+#include "http.h"
 #include "id3v2.h"
 
 #define INITIAL_BUFFER_SIZE 32768
@@ -46,6 +48,8 @@
 #define MPEG_TIME_BASE 90000
 #define MPEG_TIME_BASE_Q (AVRational){1, MPEG_TIME_BASE}
 
+#define PREFETCH_CHUNK_SIZE 32768
+
 /*
  * An apple http stream consists of a playlist with media segment files,
  * played sequentially. There may be several playlists with the same
@@ -77,6 +81,7 @@ struct segment {
 };
 
 struct rendition;
+struct prefetch;
 
 enum PlaylistType {
     PLS_TYPE_UNSPECIFIED,
@@ -153,6 +158,17 @@ struct playlist {
      * playlist, if any. */
     int n_init_sections;
     struct segment **init_sections;
+
+    /* Segment currently read from memory instead of input, if any */
+    struct prefetch *cur_prefetch;
+#if HAVE_THREADS
+    pthread_t prefetch_thread;
+    pthread_mutex_t prefetch_lock;
+    pthread_cond_t prefetch_cond;
+    int prefetch_running;
+    int prefetch_abort;
+    struct prefetch *prefetch_queue;   /* ordered by sequence number */
+#endif
 };
 
 /*
@@ -200,12 +216,14 @@ typedef struct HLSContext {
     AVIOInterruptCB *interrupt_callback;
     char *user_agent;                    ///< holds HTTP user agent set as an AVOption to the HTTP protocol context
     char *cookies;                       ///< holds HTTP cookie values set in either the initial response or as an AVOption to the HTTP protocol context
+    AVMutex cookies_lock;                ///< protects cookies against the prefetch threads
     char *headers;                       ///< holds HTTP headers set as an AVOption to the HTTP protocol context
     char *http_proxy;                    ///< holds the address of the HTTP proxy server
     AVDictionary *avio_opts;
     int strict_std_compliance;
     char *allowed_extensions;
     int max_reload;
+    int prefetch_segments;
 } HLSContext;
 
 static int read_chomp_line(AVIOContext *s, char *buf, int maxlen)
@@ -648,12 +666,14 @@ static int open_url(AVFormatContext *s, AVIOContext **pb, const char *url,
         if (!(s->flags & AVFMT_FLAG_CUSTOM_IO))
             av_opt_get(*pb, "cookies", AV_OPT_SEARCH_CHILDREN, (uint8_t**)&new_cookies);
 
+        ff_mutex_lock(&c->cookies_lock);
         if (new_cookies) {
             av_free(c->cookies);
             c->cookies = new_cookies;
         }
 
         av_dict_set(&opts, "cookies", c->cookies, 0);
+        ff_mutex_unlock(&c->cookies_lock);
     }
 
     av_dict_free(&tmp);
@@ -873,6 +893,347 @@ static struct segment *current_segment(struct playlist *pls)
     return pls->segments[pls->cur_seq_no - pls->start_seq_no];
 }
 
+#if HAVE_THREADS
+/*
+ * Segments are downloaded ahead of the demuxer by one thread per playlist,
+ * which keeps a single persistent HTTP connection open and issues the
+ * requests one after another on it. The demuxer reads the data from memory
+ * while it is being received.
+ *
+ * The segments are opened and closed from that thread, through the io_open
+ * and io_close callbacks of the demuxer context, which must therefore be
+ * thread safe. The cookies shared with the demuxer are protected by
+ * cookies_lock.
+ */
+struct prefetch {
+    int seq_no;
+    char *url;
+    int64_t size;
+    AVDictionary *opts;
+    uint8_t *buf;
+    unsigned int buf_size;
+    int buf_len;            /* bytes received so far */
+    int buf_pos;            /* bytes consumed by the demuxer */
+    int ret;                /* result of the download, once done */
+    int started;
+    int done;
+    int cancelled;          /* not wanted anymore, freed once done */
+    struct prefetch *next;
+};
+
+static void free_prefetch(struct prefetch *p)
+{
+    av_freep(&p->url);
+    av_dict_free(&p->opts);
+    av_freep(&p->buf);
+    av_free(p);
+}
+
+/* Check that a connection opened for url can be used to request
+ * new_url: the protocol, host and port must be the same. */
+static int same_http_server(const char *url, const char *new_url)
+{
+    char proto1[10], proto2[10], host1[1024], host2[1024];
+    int port1, port2;
+
+    av_url_split(proto1, sizeof(proto1), NULL, 0, host1, sizeof(host1),
+                 &port1, NULL, 0, url);
+    av_url_split(proto2, sizeof(proto2), NULL, 0, host2, sizeof(host2),
+                 &port2, NULL, 0, new_url);
+    return !strcmp(proto1, proto2) && port1 == port2 && !strcmp(host1, host2);
+}
+
+/* Open the request for a prefetched segment, reusing the connection of the
+ * previous one if possible. conn_url is the url the connection was opened
+ * for, *reuse is cleared for good when the server does not keep the
+ * connection alive. */
+static int prefetch_open(struct playlist *pls, struct prefetch *p,
+                         AVIOContext **conn, const char *conn_url, int *reuse)
+{
+    HLSContext *c = pls->parent->priv_data;
+#if CONFIG_HTTP_PROTOCOL
+    URLContext *uc;
+    int ret;
+
+    if (*conn && *reuse && conn_url && same_http_server(conn_url, p->url) &&
+        (uc = ffio_geturlcontext(*conn)) &&
+        (!strcmp(uc->prot->name, "http") || !strcmp(uc->prot->name, "https"))) {
+        AVDictionary *opts = NULL;
+
+        if ((ret = av_dict_copy(&opts, p->opts, 0)) < 0) {
+            av_dict_free(&opts);
+            return ret;
+        }
+        (*conn)->eof_reached = 0;
+        ret = ff_http_do_new_request2(uc, p->url, &opts);
+        av_dict_free(&opts);
+        /* the server did answer, do not ask again on a new connection */
+        if (ret >= 0 || ret == AVERROR_HTTP_NOT_FOUND || ret == AVERROR_HTTP_FORBIDDEN ||
+            ret == AVERROR_HTTP_UNAUTHORIZED || ret == AVERROR_HTTP_BAD_REQUEST ||
+            ret == AVERROR_HTTP_OTHER_4XX) {
+            if (ret < 0)
+                ff_format_io_close(pls->parent, conn);
+            return ret;
+        }
+        av_log(pls->parent, AV_LOG_VERBOSE, "Could not reuse HTTP connection for '%s', "
+               "not keeping connections alive anymore\n", p->url);
+        *reuse = -1;
+    }
+#endif
+    ff_format_io_close(pls->parent, conn);
+
+    return open_url(pls->parent, conn, p->url, c->avio_opts, p->opts, NULL);
+}
+
+static void *prefetch_thread(void *arg)
+{
+    struct playlist *pls = arg;
+    AVIOContext *conn = NULL;
+    char *conn_url = NULL;
+    struct prefetch *p;
+    int reuse = 0, drained, ret, len;
+
+    pthread_mutex_lock(&pls->prefetch_lock);
+    while (!pls->prefetch_abort) {
+        for (p = pls->prefetch_queue; p && (p->done || p->cancelled); p = p->next)
+            ;
+        if (!p) {
+            pthread_cond_wait(&pls->prefetch_cond, &pls->prefetch_lock);
+            continue;
+        }
+        p->started = 1;
+        pthread_mutex_unlock(&pls->prefetch_lock);
+
+        av_log(pls->parent, AV_LOG_VERBOSE, "HLS prefetch of url '%s', playlist %d\n",
+               p->url, pls->index);
+        ret = prefetch_open(pls, p, &conn, conn_url, &reuse);
+        if (ret >= 0) {
+            av_free(conn_url);
+            conn_url = av_strdup(p->url);
+        }
+        /* the connection can only be used for the next request once the
+         * whole response is read, a failed attempt disables reuse for the
+         * whole playlist */
+        if (reuse >= 0)
+            reuse = 0;
+        drained = 1;
+
+        pthread_mutex_lock(&pls->prefetch_lock);
+        while (ret >= 0 && !pls->prefetch_abort && !p->cancelled) {
+            len = PREFETCH_CHUNK_SIZE;
+            if (p->size >= 0)
+                len = FFMIN(len, p->size - p->buf_len);
+            if (!len) {
+                /* the byte range is complete, check that the server did
+                 * not send more than it was asked for */
+                uint8_t extra;
+
+                pthread_mutex_unlock(&pls->prefetch_lock);
+                drained = avio_read(conn, &extra, 1) <= 0;
+                pthread_mutex_lock(&pls->prefetch_lock);
+                ret = AVERROR_EOF;
+                break;
+            }
+            if (p->buf_len + len > INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE) {
+                ret = AVERROR(ENOMEM);
+                break;
+            }
+            if (p->buf_size < p->buf_len + len) {
+                uint8_t *buf = av_fast_realloc(p->buf, &p->buf_size, p->buf_len + len);
+                if (!buf) {
+                    ret = AVERROR(ENOMEM);
+                    break;
+                }
+                p->buf = buf;
+            }
+            pthread_mutex_unlock(&pls->prefetch_lock);
+
+            ret = avio_read(conn, p->buf + p->buf_len, len);
+
+            pthread_mutex_lock(&pls->prefetch_lock);
+            if (ret > 0) {
+                p->buf_len += ret;
+                pthread_cond_broadcast(&pls->prefetch_cond);
+            } else if (!ret) {
+                ret = AVERROR_EOF;
+            }
+        }
+        if (ret == AVERROR_EOF && drained && reuse >= 0)
+            reuse = 1;
+        if (ret != AVERROR_EOF && !pls->prefetch_abort && !p->cancelled)
+            av_log(pls->parent, AV_LOG_WARNING, "Failed to prefetch segment '%s' of playlist %d\n",
+                   p->url, pls->index);
+        p->ret  = ret;
+        p->done = 1;
+        pthread_cond_broadcast(&pls->prefetch_cond);
+    }
+    pthread_mutex_unlock(&pls->prefetch_lock);
+
+    ff_format_io_close(pls->parent, &conn);
+    av_free(conn_url);
+    return NULL;
+}
+
+/* Unlink a prefetched segment, or let the thread finish it first.
+ * Must be called with prefetch_lock held. */
+static void prefetch_drop(struct playlist *pls, struct prefetch *p)
+{
+    struct prefetch **pp;
+
+    if (p->started && !p->done) {
+        p->cancelled = 1;
+        return;
+    }
+    for (pp = &pls->prefetch_queue; *pp != p; pp = &(*pp)->next)
+        ;
+    *pp = p->next;
+    free_prefetch(p);
+}
+
+/*
+ * Queue the current and the following segments of the playlist for
+ * prefetching. Returns 1 if the current segment is read from the prefetch
+ * thread, 0 if it has to be opened directly.
+ */
+static int prefetch_input(HLSContext *c, struct playlist *pls)
+{
+    struct prefetch *p, **pp;
+    struct segment *seg;
+    int seq_no, ret;
+
+    if (!pls->prefetch_running) {
+        pthread_mutex_init(&pls->prefetch_lock, NULL);
+        pthread_cond_init(&pls->prefetch_cond, NULL);
+        pls->prefetch_abort = 0;
+        if ((ret = pthread_create(&pls->prefetch_thread, NULL, prefetch_thread, pls))) {
+            av_log(pls->parent, AV_LOG_ERROR, "Failed to start prefetch thread: %s\n",
+                   av_err2str(AVERROR(ret)));
+            pthread_cond_destroy(&pls->prefetch_cond);
+            pthread_mutex_destroy(&pls->prefetch_lock);
+            c->prefetch_segments = 0;
+            return 0;
+        }
+        pls->prefetch_running = 1;
+    }
+
+    pthread_mutex_lock(&pls->prefetch_lock);
+
+    /* keep the segments following the current one, e.g. not after a seek */
+    seq_no = pls->cur_seq_no;
+    pp     = &pls->prefetch_queue;
+    while ((p = *pp)) {
+        if (!p->cancelled && p->seq_no != seq_no)
+            p->cancelled = 1;
+        if (p->cancelled && (p->done || !p->started)) {
+            *pp = p->next;
+            free_prefetch(p);
+            continue;
+        }
+        if (!p->cancelled)
+            seq_no++;
+        pp = &p->next;
+    }
+
+    while (seq_no <= pls->cur_seq_no + c->prefetch_segments &&
+           seq_no <  pls->start_seq_no + pls->n_segments) {
+        seg = pls->segments[seq_no - pls->start_seq_no];
+        /* only plain HTTP segments are worth a persistent connection */
+        if (seg->key_type != KEY_NONE || !av_strstart(seg->url, "http", NULL))
+            break;
+
+        if (!(p = av_mallocz(sizeof(*p))) || !(p->url = av_strdup(seg->url))) {
+            if (p)
+                free_prefetch(p);
+            break;
+        }
+        p->seq_no = seq_no++;
+        p->size   = seg->size;
+        av_dict_set(&p->opts, "user_agent", c->user_agent, 0);
+        ff_mutex_lock(&c->cookies_lock);
+        av_dict_set(&p->opts, "cookies", c->cookies, 0);
+        ff_mutex_unlock(&c->cookies_lock);
+        av_dict_set(&p->opts, "headers", c->headers, 0);
+        av_dict_set(&p->opts, "http_proxy", c->http_proxy, 0);
+        av_dict_set(&p->opts, "seekable", "0", 0);
+        av_dict_set(&p->opts, "multiple_requests", "1", 0);
+        if (seg->size >= 0) {
+            av_dict_set_int(&p->opts, "offset", seg->url_offset, 0);
+            av_dict_set_int(&p->opts, "end_offset", seg->url_offset + seg->size, 0);
+        }
+        *pp = p;
+        pp  = &p->next;
+    }
+    pthread_cond_broadcast(&pls->prefetch_cond);
+
+    for (p = pls->prefetch_queue; p && p->cancelled; p = p->next)
+        ;
+    if (p && p->seq_no == pls->cur_seq_no) {
+        pls->cur_prefetch   = p;
+        pls->cur_seg_offset = 0;
+    }
+
+    pthread_mutex_unlock(&pls->prefetch_lock);
+
+    return !!pls->cur_prefetch;
+}
+
+static int prefetch_read(struct playlist *pls, uint8_t *buf, int buf_size)
+{
+    struct prefetch *p = pls->cur_prefetch;
+    int ret;
+
+    pthread_mutex_lock(&pls->prefetch_lock);
+    while (p->buf_pos == p->buf_len && !p->done)
+        pthread_cond_wait(&pls->prefetch_cond, &pls->prefetch_lock);
+    if (p->buf_pos < p->buf_len) {
+        ret = FFMIN(buf_size, p->buf_len - p->buf_pos);
+        memcpy(buf, p->buf + p->buf_pos, ret);
+        p->buf_pos += ret;
+    } else {
+        ret = p->ret;
+    }
+    pthread_mutex_unlock(&pls->prefetch_lock);
+
+    return ret;
+}
+
+static void prefetch_stop(struct playlist *pls)
+{
+    struct prefetch *p;
+
+    if (!pls->prefetch_running)
+        return;
+
+    pthread_mutex_lock(&pls->prefetch_lock);
+    pls->prefetch_abort = 1;
+    pthread_cond_broadcast(&pls->prefetch_cond);
+    pthread_mutex_unlock(&pls->prefetch_lock);
+    pthread_join(pls->prefetch_thread, NULL);
+
+    while ((p = pls->prefetch_queue)) {
+        pls->prefetch_queue = p->next;
+        free_prefetch(p);
+    }
+    pls->cur_prefetch = NULL;
+    pthread_cond_destroy(&pls->prefetch_cond);
+    pthread_mutex_destroy(&pls->prefetch_lock);
+    pls->prefetch_running = 0;
+}
+#endif
+
+static void close_input(struct playlist *pls)
+{
+#if HAVE_THREADS
+    if (pls->cur_prefetch) {
+        pthread_mutex_lock(&pls->prefetch_lock);
+        prefetch_drop(pls, pls->cur_prefetch);
+        pthread_mutex_unlock(&pls->prefetch_lock);
+        pls->cur_prefetch = NULL;
+    }
+#endif
+    ff_format_io_close(pls->parent, &pls->input);
+}
+
 enum ReadFromURLMode {
     READ_NORMAL,
     READ_COMPLETE,
@@ -888,6 +1249,11 @@ static int read_from_url(struct playlist *pls, struct segment *seg,
     if (seg->size >= 0)
         buf_size = FFMIN(buf_size, seg->size - pls->cur_seg_offset);
 
+#if HAVE_THREADS
+    if (pls->cur_prefetch)
+        ret = prefetch_read(pls, buf, buf_size);
+    else
+#endif
     if (mode == READ_COMPLETE) {
         ret = avio_read(pls->input, buf, buf_size);
         if (ret != buf_size)
@@ -1106,7 +1472,9 @@ static int open_input(HLSContext *c, struct playlist *pls, struct segment *seg)
 
     // broker prior HTTP options that should be consistent across requests
     av_dict_set(&opts, "user_agent", c->user_agent, 0);
+    ff_mutex_lock(&c->cookies_lock);
     av_dict_set(&opts, "cookies", c->cookies, 0);
+    ff_mutex_unlock(&c->cookies_lock);
     av_dict_set(&opts, "headers", c->headers, 0);
     av_dict_set(&opts, "http_proxy", c->http_proxy, 0);
     av_dict_set(&opts, "seekable", "0", 0);
@@ -1270,7 +1638,7 @@ restart:
     if (!v->needed)
         return AVERROR_EOF;
 
-    if (!v->input) {
+    if (!v->input && !v->cur_prefetch) {
         int64_t reload_interval;
         struct segment *seg;
 
@@ -1336,7 +1704,13 @@ reload:
         if (ret)
             return ret;
 
-        ret = open_input(c, v, seg);
+        ret = 0;
+#if HAVE_THREADS
+        if (c->prefetch_segments)
+            ret = prefetch_input(c, v);
+#endif
+        if (!ret)
+            ret = open_input(c, v, seg);
         if (ret < 0) {
             if (ff_check_interrupt(c->interrupt_callback))
                 return AVERROR_EXIT;
@@ -1366,7 +1740,7 @@ reload:
 
         return ret;
     }
-    ff_format_io_close(v->parent, &v->input);
+    close_input(v);
     v->cur_seq_no++;
 
     c->cur_seq_no = v->cur_seq_no;
@@ -1621,12 +1995,18 @@ static void update_noheader_flag(AVFormatContext *s)
 static int hls_close(AVFormatContext *s)
 {
     HLSContext *c = s->priv_data;
+#if HAVE_THREADS
+    int i;
 
+    for (i = 0; i < c->n_playlists; i++)
+        prefetch_stop(c->playlists[i]);
+#endif
     free_playlist_list(c);
     free_variant_list(c);
     free_rendition_list(c);
 
     av_dict_free(&c->avio_opts);
+    ff_mutex_destroy(&c->cookies_lock);
 
     return 0;
 }
@@ -1640,6 +2020,7 @@ static int hls_read_header(AVFormatContext *s)
 
     c->ctx                = s;
     c->interrupt_callback = &s->interrupt_callback;
+    ff_mutex_init(&c->cookies_lock, NULL);
     c->strict_std_compliance = s->strict_std_compliance;
 
     c->first_packet = 1;
@@ -1867,8 +2248,7 @@ static int recheck_discard_flags(AVFormatContext *s, int first)
             }
             av_log(s, AV_LOG_INFO, "Now receiving playlist %d, segment %d\n", i, pls->cur_seq_no);
         } else if (first && !pls->cur_needed && pls->needed) {
-            if (pls->input)
-                ff_format_io_close(pls->parent, &pls->input);
+            close_input(pls);
             pls->needed = 0;
             changed = 1;
             av_log(s, AV_LOG_INFO, "No longer receiving playlist %d\n", i);
@@ -2101,8 +2481,7 @@ static int hls_read_seek(AVFormatContext *s, int stream_index,
     for (i = 0; i < c->n_playlists; i++) {
         /* Reset reading */
         struct playlist *pls = c->playlists[i];
-        if (pls->input)
-            ff_format_io_close(pls->parent, &pls->input);
+        close_input(pls);
         av_packet_unref(&pls->pkt);
         reset_packet(&pls->pkt);
         pls->pb.eof_reached = 0;
@@ -2157,6 +2536,8 @@ static const AVOption hls_options[] = {
         INT_MIN, INT_MAX, FLAGS},
     {"max_reload", "Maximum number of times a insufficient list is attempted to be reloaded",
         OFFSET(max_reload), AV_OPT_TYPE_INT, {.i64 = 1000}, 0, INT_MAX, FLAGS},
+    {"prefetch_segments", "Number of HTTP segments to download ahead on a persistent connection",
+        OFFSET(prefetch_segments), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, FLAGS},
     {NULL}
 };
 
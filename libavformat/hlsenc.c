@@ -21,6 +21,9 @@
 
 #include "config.h"
 #include <float.h>
+#if HAVE_THREADS
+#include <stdatomic.h>
+#endif
 #include <stdint.h>
 #if HAVE_UNISTD_H
 #include <unistd.h>
@@ -36,16 +39,19 @@
 #include "libavutil/mathematics.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/avstring.h"
+#include "libavutil/intfloat.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/random_seed.h"
 #include "libavutil/opt.h"
 #include "libavutil/log.h"
 #include "libavutil/time_internal.h"
+#include "libavutil/thread.h"
 
 #include "avformat.h"
 #include "avio_internal.h"
 #include "internal.h"
 #include "os_support.h"
+#include "segindex.h"
 
 typedef enum {
   HLS_START_SEQUENCE_AS_START_NUMBER = 0,
@@ -56,6 +62,8 @@ typedef enum {
 #define KEYSIZE 16
 #define LINE_BUFFER_SIZE 1024
 #define HLS_MICROSECOND_UNIT   1000000
+#define HLS_INDEX_TAG MKBETAG('H', 'L', 'S', 'I')
+#define HLS_INDEX_VERSION 1
 
 typedef struct HLSSegment {
     char filename[1024];
@@ -71,6 +79,24 @@ typedef struct HLSSegment {
     struct HLSSegment *next;
 } HLSSegment;
 
+#if HAVE_THREADS
+/* A segment muxed and written out by its own thread, with its own muxer */
+typedef struct HLSSegmentWrite {
+    AVFormatContext *s;
+    pthread_t thread;
+    atomic_int done;
+    int ret;
+    char *url;              // URL the segment is opened with, may carry a crypto: prefix
+    char *filename;         // temporary file to rename once written, if any
+    AVDictionary *options;
+    int discontinuity;      // not the first segment, the continuity counters restart
+    AVPacketList *pkts;     // packets of the segment, queued until it is complete
+    AVPacketList *last_pkt;
+    HLSSegment *en;         // playlist entry, published once the segment is written
+    struct HLSSegmentWrite *next;
+} HLSSegmentWrite;
+#endif
+
 typedef enum HLSFlags {
     // Generate a single media file and use byte ranges in the playlist.
     HLS_SINGLE_FILE = (1 << 0),
@@ -86,6 +112,7 @@ typedef enum HLSFlags {
     HLS_SECOND_LEVEL_SEGMENT_SIZE = (1 << 10), // include segment size (bytes) in segment filenames when use_localtime  e.g.: %%014s
     HLS_TEMP_FILE = (1 << 11),
     HLS_PERIODIC_REKEY = (1 << 12),
+    HLS_RESUME_INDEX = (1 << 13), // keep a binary index of the playlist entries next to it, and resume from it
 } HLSFlags;
 
 typedef enum {
@@ -175,6 +202,14 @@ typedef struct HLSContext {
     double initial_prog_date_time;
     char current_segment_final_filename_fmt[1024]; // when renaming segments
     char *user_agent;
+
+    int nb_segment_writers; // Set by a private option.
+    int nb_writes;          // segments written asynchronously, not yet in the playlist
+#if HAVE_THREADS
+    HLSSegmentWrite *writes;
+    HLSSegmentWrite *last_write;
+    HLSSegmentWrite *cur_write; // segment whose packets are being queued
+#endif
 } HLSContext;
 
 static int get_int_from_double(double val)
@@ -527,19 +562,16 @@ static int read_chomp_line(AVIOContext *s, char *buf, int maxlen)
     return len;
 }
 
-static int hls_mux_init(AVFormatContext *s)
+static int hls_alloc_segment_muxer(AVFormatContext *s, AVFormatContext **poc)
 {
-    AVDictionary *options = NULL;
     HLSContext *hls = s->priv_data;
     AVFormatContext *oc;
-    AVFormatContext *vtt_oc = NULL;
-    int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
-    int i, ret;
+    int ret;
 
-    ret = avformat_alloc_output_context2(&hls->avf, hls->oformat, NULL, NULL);
+    ret = avformat_alloc_output_context2(poc, hls->oformat, NULL, NULL);
     if (ret < 0)
         return ret;
-    oc = hls->avf;
+    oc = *poc;
 
     oc->filename[0]        = '\0';
     oc->oformat            = hls->oformat;
@@ -549,6 +581,43 @@ static int hls_mux_init(AVFormatContext *s)
     oc->io_open            = s->io_open;
     oc->io_close           = s->io_close;
     av_dict_copy(&oc->metadata, s->metadata, 0);
+    return 0;
+}
+
+/* Add a copy of the stream ist to the muxer loc, with tags valid for the segment format */
+static int hls_add_stream(AVFormatContext *loc, AVOutputFormat *ofmt, AVStream *ist)
+{
+    AVStream *st;
+
+    if (!(st = avformat_new_stream(loc, NULL)))
+        return AVERROR(ENOMEM);
+    avcodec_parameters_copy(st->codecpar, ist->codecpar);
+    if (!ofmt->codec_tag ||
+        av_codec_get_id (ofmt->codec_tag, ist->codecpar->codec_tag) == st->codecpar->codec_id ||
+        av_codec_get_tag(ofmt->codec_tag, ist->codecpar->codec_id) <= 0) {
+        st->codecpar->codec_tag = ist->codecpar->codec_tag;
+    } else {
+        st->codecpar->codec_tag = 0;
+    }
+
+    st->sample_aspect_ratio = ist->sample_aspect_ratio;
+    st->time_base = ist->time_base;
+    av_dict_copy(&st->metadata, ist->metadata, 0);
+    return 0;
+}
+
+static int hls_mux_init(AVFormatContext *s)
+{
+    AVDictionary *options = NULL;
+    HLSContext *hls = s->priv_data;
+    AVFormatContext *oc;
+    AVFormatContext *vtt_oc = NULL;
+    int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
+    int i, ret;
+
+    if ((ret = hls_alloc_segment_muxer(s, &hls->avf)) < 0)
+        return ret;
+    oc = hls->avf;
 
     if(hls->vtt_oformat) {
         ret = avformat_alloc_output_context2(&hls->vtt_avf, hls->vtt_oformat, NULL, NULL);
@@ -560,27 +629,14 @@ static int hls_mux_init(AVFormatContext *s)
     }
 
     for (i = 0; i < s->nb_streams; i++) {
-        AVStream *st;
         AVFormatContext *loc;
         if (s->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_SUBTITLE)
             loc = vtt_oc;
         else
             loc = oc;
 
-        if (!(st = avformat_new_stream(loc, NULL)))
-            return AVERROR(ENOMEM);
-        avcodec_parameters_copy(st->codecpar, s->streams[i]->codecpar);
-        if (!oc->oformat->codec_tag ||
-            av_codec_get_id (oc->oformat->codec_tag, s->streams[i]->codecpar->codec_tag) == st->codecpar->codec_id ||
-            av_codec_get_tag(oc->oformat->codec_tag, s->streams[i]->codecpar->codec_id) <= 0) {
-            st->codecpar->codec_tag = s->streams[i]->codecpar->codec_tag;
-        } else {
-            st->codecpar->codec_tag = 0;
-        }
-
-        st->sample_aspect_ratio = s->streams[i]->sample_aspect_ratio;
-        st->time_base = s->streams[i]->time_base;
-        av_dict_copy(&st->metadata, s->streams[i]->metadata, 0);
+        if ((ret = hls_add_stream(loc, oc->oformat, s->streams[i])) < 0)
+            return ret;
     }
     hls->start_pos = 0;
     hls->new_start = 1;
@@ -781,11 +837,49 @@ static int sls_flag_use_localtime_filename(AVFormatContext *oc, HLSContext *c)
     return 0;
 }
 
+/* Link a segment into the playlist, sliding the window if needed */
+static int hls_add_segment_entry(AVFormatContext *s, HLSContext *hls, HLSSegment *en)
+{
+    int ret;
+
+    if (!hls->segments)
+        hls->segments = en;
+    else
+        hls->last_segment->next = en;
+
+    hls->last_segment = en;
+
+    // EVENT or VOD playlists imply sliding window cannot be used
+    if (hls->pl_type != PLAYLIST_TYPE_NONE)
+        hls->max_nb_segments = 0;
+
+    if (hls->max_nb_segments && hls->nb_entries >= hls->max_nb_segments) {
+        en = hls->segments;
+        hls->initial_prog_date_time += en->duration;
+        hls->segments = en->next;
+        if (en && hls->flags & HLS_DELETE_SEGMENTS &&
+#if FF_API_HLS_WRAP
+                !(hls->flags & HLS_SINGLE_FILE || hls->wrap)) {
+#else
+                !(hls->flags & HLS_SINGLE_FILE)) {
+#endif
+            en->next = hls->old_segments;
+            hls->old_segments = en;
+            if ((ret = hls_delete_old_segments(s, hls)) < 0)
+                return ret;
+        } else
+            av_free(en);
+    } else
+        hls->nb_entries++;
+
+    return 0;
+}
+
 /* Create a new segment and append it to the segment list */
 static int hls_append_segment(struct AVFormatContext *s, HLSContext *hls, double duration,
                               int64_t pos, int64_t size)
 {
-    HLSSegment *en = av_malloc(sizeof(*en));
+    HLSSegment *en = av_mallocz(sizeof(*en));
     const char  *filename;
     int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
     int ret;
@@ -830,41 +924,211 @@ static int hls_append_segment(struct AVFormatContext *s, HLSContext *hls, double
         av_strlcpy(en->iv_string, hls->iv_string, sizeof(en->iv_string));
     }
 
-    if (!hls->segments)
-        hls->segments = en;
+#if HAVE_THREADS
+    /* The segment is still being written, publish it once it is complete */
+    if (hls->last_write && !hls->last_write->en)
+        hls->last_write->en = en;
     else
-        hls->last_segment->next = en;
+#endif
+    if ((ret = hls_add_segment_entry(s, hls, en)) < 0)
+        return ret;
 
-    hls->last_segment = en;
+    if (hls->max_seg_size > 0) {
+        return 0;
+    }
+    hls->sequence++;
 
-    // EVENT or VOD playlists imply sliding window cannot be used
-    if (hls->pl_type != PLAYLIST_TYPE_NONE)
-        hls->max_nb_segments = 0;
+    return 0;
+}
 
-    if (hls->max_nb_segments && hls->nb_entries >= hls->max_nb_segments) {
-        en = hls->segments;
-        hls->initial_prog_date_time += en->duration;
-        hls->segments = en->next;
-        if (en && hls->flags & HLS_DELETE_SEGMENTS &&
-#if FF_API_HLS_WRAP
-                !(hls->flags & HLS_SINGLE_FILE || hls->wrap)) {
-#else
-                !(hls->flags & HLS_SINGLE_FILE)) {
+#if HAVE_THREADS
+static void *segment_mux_thread(void *arg)
+{
+    HLSSegmentWrite *w = arg;
+    AVFormatContext *s = w->s;
+    HLSContext *hls = s->priv_data;
+    AVFormatContext *oc = NULL;
+    AVDictionary *options = NULL;
+    AVPacketList *pktl;
+    char *final_filename, period[21];
+    int i, ret;
+
+    if ((ret = hls_alloc_segment_muxer(s, &oc)) < 0)
+        goto end;
+    for (i = 0; i < s->nb_streams; i++)
+        if ((ret = hls_add_stream(oc, oc->oformat, s->streams[i])) < 0)
+            goto end;
+
+    /* We only require one PAT/PMT per segment. As each segment has its own
+     * muxer, the continuity counters restart, which is signalled. */
+    snprintf(period, sizeof(period), "%d", (INT_MAX / 2) - 1);
+    av_opt_set(oc->priv_data, "sdt_period", period, 0);
+    av_opt_set(oc->priv_data, "pat_period", period, 0);
+    if (w->discontinuity)
+        av_opt_set(oc->priv_data, "mpegts_flags", "+initial_discontinuity", 0);
+
+    if ((ret = s->io_open(s, &oc->pb, w->url, AVIO_FLAG_WRITE, &w->options)) < 0)
+        goto end;
+    av_dict_copy(&options, hls->format_options, 0);
+    if ((ret = avformat_write_header(oc, &options)) < 0)
+        goto end;
+
+    while ((pktl = w->pkts)) {
+        w->pkts = pktl->next;
+        ret = ff_write_chained(oc, pktl->pkt.stream_index, &pktl->pkt, s, 0);
+        av_packet_unref(&pktl->pkt);
+        av_free(pktl);
+        if (ret < 0)
+            goto end;
+    }
+    w->last_pkt = NULL;
+    ret = av_write_trailer(oc);
+
+end:
+    av_dict_free(&options);
+    if (oc) {
+        ff_format_io_close(s, &oc->pb);
+        avformat_free_context(oc);
+    }
+
+    if (ret < 0) {
+        av_log(s, AV_LOG_ERROR, "Failed to write segment '%s'\n", w->url);
+    } else if (w->filename) {
+        final_filename = av_strndup(w->filename, strlen(w->filename) - 4);
+        if (final_filename)
+            ff_rename(w->filename, final_filename, s);
+        else
+            ret = AVERROR(ENOMEM);
+        av_free(final_filename);
+    }
+
+    w->ret = ret;
+    atomic_store(&w->done, 1);
+    return NULL;
+}
+
+static void hls_free_segment_write(HLSSegmentWrite *w)
+{
+    AVPacketList *pktl;
+
+    while ((pktl = w->pkts)) {
+        w->pkts = pktl->next;
+        av_packet_unref(&pktl->pkt);
+        av_free(pktl);
+    }
+    av_free(w->url);
+    av_free(w->filename);
+    av_dict_free(&w->options);
+    av_free(w->en);
+    av_free(w);
+}
+
+static int hls_queue_packet(HLSSegmentWrite *w, AVPacket *pkt)
+{
+    AVPacketList *pktl = av_mallocz(sizeof(*pktl));
+    int ret;
+
+    if (!pktl)
+        return AVERROR(ENOMEM);
+    if ((ret = av_packet_ref(&pktl->pkt, pkt)) < 0) {
+        av_free(pktl);
+        return ret;
+    }
+    if (w->last_pkt)
+        w->last_pkt->next = pktl;
+    else
+        w->pkts = pktl;
+    w->last_pkt = pktl;
+    return 0;
+}
 #endif
-            en->next = hls->old_segments;
-            hls->old_segments = en;
-            if ((ret = hls_delete_old_segments(s, hls)) < 0)
-                return ret;
-        } else
-            av_free(en);
-    } else
-        hls->nb_entries++;
 
-    if (hls->max_seg_size > 0) {
+/* Join finished segment writers, in order, and publish their playlist entries */
+static int hls_reap_segment_writes(AVFormatContext *s, int flush)
+{
+    int ret = 0;
+#if HAVE_THREADS
+    HLSContext *hls = s->priv_data;
+    HLSSegmentWrite *w;
+    int err;
+
+    while ((w = hls->writes) &&
+           (flush || hls->nb_writes > hls->nb_segment_writers || atomic_load(&w->done))) {
+        pthread_join(w->thread, NULL);
+        hls->writes = w->next;
+        if (!hls->writes)
+            hls->last_write = NULL;
+        hls->nb_writes--;
+
+        if (w->ret < 0 && ret >= 0)
+            ret = w->ret;
+        if (w->en && ret >= 0) {
+            err = hls_add_segment_entry(s, hls, w->en);
+            w->en = NULL;
+            if (err < 0)
+                ret = err;
+        }
+        hls_free_segment_write(w);
+    }
+#endif
+    return ret;
+}
+
+static int hls_open_segment(AVFormatContext *s, const char *url, AVDictionary **options)
+{
+    HLSContext *c = s->priv_data;
+    AVFormatContext *oc = c->avf;
+
+#if HAVE_THREADS
+    if (c->nb_segment_writers) {
+        HLSSegmentWrite *w = av_mallocz(sizeof(*w));
+
+        if (!w)
+            return AVERROR(ENOMEM);
+        w->s             = s;
+        w->discontinuity = c->number > 1;
+        atomic_init(&w->done, 0);
+        if (!(w->url = av_strdup(url)) ||
+            ((c->flags & HLS_TEMP_FILE) && !(w->filename = av_strdup(oc->filename))) ||
+            av_dict_copy(&w->options, *options, 0) < 0) {
+            hls_free_segment_write(w);
+            return AVERROR(ENOMEM);
+        }
+        c->cur_write = w;
         return 0;
     }
-    hls->sequence++;
+#endif
+    return s->io_open(s, &oc->pb, url, AVIO_FLAG_WRITE, options);
+}
+
+static int hls_close_segment(AVFormatContext *s, AVFormatContext *oc)
+{
+#if HAVE_THREADS
+    HLSContext *c = s->priv_data;
+    HLSSegmentWrite *w = c->cur_write;
+    int ret;
 
+    if (c->nb_segment_writers) {
+        if (!w)
+            return 0;
+        c->cur_write = NULL;
+        if ((ret = pthread_create(&w->thread, NULL, segment_mux_thread, w))) {
+            av_log(s, AV_LOG_ERROR, "Failed to start segment writer thread: %s\n",
+                   av_err2str(AVERROR(ret)));
+            hls_free_segment_write(w);
+            return AVERROR(ret);
+        }
+
+        if (c->last_write)
+            c->last_write->next = w;
+        else
+            c->writes = w;
+        c->last_write = w;
+        c->nb_writes++;
+        return 0;
+    }
+#endif
+    ff_format_io_close(s, &oc->pb);
     return 0;
 }
 
@@ -980,6 +1244,124 @@ static void set_http_options(AVFormatContext *s, AVDictionary **options, HLSCont
 
 }
 
+/* Write the playlist entries to <playlist>.idx, to be picked up by
+ * read_segment_index() when restarting. */
+static int write_segment_index(AVFormatContext *s)
+{
+    HLSContext *hls = s->priv_data;
+    HLSSegment *en;
+    AVIOContext *out = NULL;
+    AVDictionary *options = NULL;
+    char index_filename[sizeof(s->filename) + 4], temp_filename[sizeof(s->filename) + 8];
+    const char *proto = avio_find_protocol_name(s->filename);
+    int use_rename = proto && !strcmp(proto, "file");
+    int ret;
+
+    snprintf(index_filename, sizeof(index_filename), "%s.idx", s->filename);
+    snprintf(temp_filename, sizeof(temp_filename), use_rename ? "%s.tmp" : "%s", index_filename);
+    set_http_options(s, &options, hls);
+    ret = s->io_open(s, &out, temp_filename, AVIO_FLAG_WRITE, &options);
+    av_dict_free(&options);
+    if (ret < 0)
+        return ret;
+
+    avio_wb32(out, HLS_INDEX_TAG);
+    avio_wb32(out, HLS_INDEX_VERSION);
+    avio_wb64(out, hls->sequence - hls->nb_writes); // segments still being written are not listed
+    avio_wb64(out, av_double2int(hls->initial_prog_date_time));
+    avio_wb32(out, hls->nb_entries);
+    for (en = hls->segments; en; en = en->next) {
+        avio_wb64(out, av_double2int(en->duration));
+        avio_w8(out, en->discont);
+        avio_wb64(out, en->pos);
+        avio_wb64(out, en->size);
+        ff_segindex_write_string(out, en->filename);
+        ff_segindex_write_string(out, en->sub_filename);
+        ff_segindex_write_string(out, en->key_uri);
+        ff_segindex_write_string(out, en->iv_string);
+    }
+    avio_flush(out);
+    ret = out->error;
+    ff_format_io_close(s, &out);
+
+    if (ret >= 0 && use_rename)
+        ret = ff_rename(temp_filename, index_filename, s);
+    return ret;
+}
+
+/* Restore the playlist entries from the index written by a previous run.
+ * Returns 1 if they were restored, 0 if there is no index. */
+static int read_segment_index(AVFormatContext *s)
+{
+    HLSContext *hls = s->priv_data;
+    AVIOContext *in;
+    HLSSegment *en;
+    char index_filename[sizeof(s->filename) + 4];
+    int64_t sequence;
+    unsigned nb_entries, i;
+    int ret;
+
+    snprintf(index_filename, sizeof(index_filename), "%s.idx", s->filename);
+    if ((ret = ffio_open_whitelist(&in, index_filename, AVIO_FLAG_READ,
+                                   &s->interrupt_callback, NULL,
+                                   s->protocol_whitelist, s->protocol_blacklist)) < 0)
+        return ret == AVERROR(ENOENT) ? 0 : ret;
+
+    if (avio_rb32(in) != HLS_INDEX_TAG || avio_rb32(in) != HLS_INDEX_VERSION) {
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
+    }
+    sequence = avio_rb64(in);
+    hls->initial_prog_date_time = av_int2double(avio_rb64(in));
+    nb_entries = avio_rb32(in);
+    if (nb_entries > SEGINDEX_MAX_ENTRIES || avio_feof(in)) {
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
+    }
+    for (i = 0; i < nb_entries; i++) {
+        if (!(en = av_mallocz(sizeof(*en)))) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        en->duration = av_int2double(avio_rb64(in));
+        en->discont  = avio_r8(in);
+        en->pos      = avio_rb64(in);
+        en->size     = avio_rb64(in);
+        if ((ret = ff_segindex_read_string(in, en->filename,    sizeof(en->filename)))    < 0 ||
+            (ret = ff_segindex_read_string(in, en->sub_filename, sizeof(en->sub_filename))) < 0 ||
+            (ret = ff_segindex_read_string(in, en->key_uri,     sizeof(en->key_uri)))     < 0 ||
+            (ret = ff_segindex_read_string(in, en->iv_string,   sizeof(en->iv_string)))   < 0) {
+            av_free(en);
+            goto fail;
+        }
+        if ((ret = hls_add_segment_entry(s, hls, en)) < 0)
+            goto fail;
+    }
+    if (avio_feof(in)) {
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
+    }
+
+    if (sequence < hls->sequence)
+        av_log(hls, AV_LOG_VERBOSE, "Index sequence number %"PRId64" is smaller "
+               "than the start sequence number %"PRId64", omitting\n",
+               sequence, hls->sequence);
+    else
+        hls->sequence = sequence;
+    av_log(s, AV_LOG_VERBOSE, "Resumed %u segments from %s\n", nb_entries, index_filename);
+    ret = 1;
+
+fail:
+    avio_close(in);
+    if (ret < 0) {
+        hls_free_segments(hls->segments);
+        hls->segments = hls->last_segment = NULL;
+        hls->nb_entries = 0;
+        hls->initial_prog_date_time = 0;
+    }
+    return ret;
+}
+
 static void write_m3u8_head_block(HLSContext *hls, AVIOContext *out, int version,
                                   int target_duration, int64_t sequence)
 {
@@ -995,12 +1377,15 @@ static void write_m3u8_head_block(HLSContext *hls, AVIOContext *out, int version
 
 static void hls_rename_temp_file(AVFormatContext *s, AVFormatContext *oc)
 {
+    HLSContext *hls = s->priv_data;
     size_t len = strlen(oc->filename);
     char final_filename[sizeof(oc->filename)];
 
     av_strlcpy(final_filename, oc->filename, len);
     final_filename[len-4] = '\0';
-    ff_rename(oc->filename, final_filename, s);
+    /* segment writers rename the file themselves once it is complete */
+    if (!hls->nb_segment_writers)
+        ff_rename(oc->filename, final_filename, s);
     oc->filename[len-4] = '\0';
 }
 
@@ -1013,7 +1398,7 @@ static int hls_window(AVFormatContext *s, int last)
     AVIOContext *out = NULL;
     AVIOContext *sub_out = NULL;
     char temp_filename[1024];
-    int64_t sequence = FFMAX(hls->start_sequence, hls->sequence - hls->nb_entries);
+    int64_t sequence = FFMAX(hls->start_sequence, hls->sequence - hls->nb_entries - hls->nb_writes);
     int version = 3;
     const char *proto = avio_find_protocol_name(s->filename);
     int use_rename = proto && !strcmp(proto, "file");
@@ -1148,6 +1533,8 @@ fail:
     ff_format_io_close(s, &sub_out);
     if (ret >= 0 && use_rename)
         ff_rename(temp_filename, s->filename, s);
+    if (ret >= 0 && hls->flags & HLS_RESUME_INDEX)
+        ret = write_segment_index(s);
     return ret;
 }
 
@@ -1264,13 +1651,13 @@ static int hls_start(AVFormatContext *s)
             err = AVERROR(ENOMEM);
             goto fail;
         }
-        err = s->io_open(s, &oc->pb, filename, AVIO_FLAG_WRITE, &options);
+        err = hls_open_segment(s, filename, &options);
         av_free(filename);
         av_dict_free(&options);
         if (err < 0)
             return err;
     } else
-        if ((err = s->io_open(s, &oc->pb, oc->filename, AVIO_FLAG_WRITE, &options)) < 0)
+        if ((err = hls_open_segment(s, oc->filename, &options)) < 0)
             goto fail;
     if (c->vtt_basename) {
         set_http_options(s, &options, c);
@@ -1334,6 +1721,7 @@ static int hls_write_header(AVFormatContext *s)
     AVDictionary *options = NULL;
     int basename_size;
     int vtt_basename_size;
+    int resumed = 0;
 
     if (hls->segment_type == SEGMENT_TYPE_FMP4) {
         pattern = "%d.m4s";
@@ -1515,11 +1903,38 @@ static int hls_write_header(AVFormatContext *s)
         }
     }
 
+    if (hls->nb_segment_writers) {
+        if (!HAVE_THREADS) {
+            av_log(s, AV_LOG_WARNING, "hls_segment_writers requires threading support, "
+                   "writing segments synchronously\n");
+            hls->nb_segment_writers = 0;
+        } else if ((hls->flags & HLS_SINGLE_FILE) || hls->max_seg_size > 0 ||
+                   hls->segment_type == SEGMENT_TYPE_FMP4 || hls->has_subtitle ||
+                   (hls->flags & (HLS_SECOND_LEVEL_SEGMENT_SIZE | HLS_SECOND_LEVEL_SEGMENT_DURATION))) {
+            av_log(s, AV_LOG_WARNING, "hls_segment_writers is only supported with one mpegts "
+                   "file per segment and no subtitles, writing segments synchronously\n");
+            hls->nb_segment_writers = 0;
+        }
+    }
+
     if ((ret = hls_mux_init(s)) < 0)
         goto fail;
 
-    if (hls->flags & HLS_APPEND_LIST) {
-        parse_playlist(s, s->filename);
+    if (hls->flags & HLS_RESUME_INDEX) {
+        if (hls->flags & HLS_SINGLE_FILE || hls->max_seg_size > 0) {
+            av_log(s, AV_LOG_WARNING, "resume_index is not supported with byte range "
+                   "playlists, the playlist will not be resumed\n");
+            hls->flags &= ~HLS_RESUME_INDEX;
+        } else if ((resumed = read_segment_index(s)) < 0) {
+            av_log(s, AV_LOG_WARNING, "Could not read the segment index of %s: %s, "
+                   "starting a new playlist\n", s->filename, av_err2str(resumed));
+            resumed = 0;
+        }
+    }
+
+    if (resumed || hls->flags & HLS_APPEND_LIST) {
+        if (!resumed)
+            parse_playlist(s, s->filename);
         hls->discontinuity = 1;
         if (hls->init_time > 0) {
             av_log(s, AV_LOG_WARNING, "append_list mode does not support hls_init_time,"
@@ -1535,7 +1950,12 @@ static int hls_write_header(AVFormatContext *s)
     }
 
     av_dict_copy(&options, hls->format_options, 0);
-    ret = avformat_write_header(hls->avf, &options);
+    /* with segment writers, each segment is muxed by its own muxer, this one
+     * only checks the options and sets the stream time bases */
+    if (hls->nb_segment_writers)
+        ret = FFMIN(avformat_init_output(hls->avf, &options), 0);
+    else
+        ret = avformat_write_header(hls->avf, &options);
     if (av_dict_count(options)) {
         av_log(s, AV_LOG_ERROR, "Some of provided format options in '%s' are not recognized\n", hls->format_options_str);
         ret = AVERROR(EINVAL);
@@ -1592,11 +2012,16 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
     int is_ref_pkt = 1;
     int ret = 0, can_split = 1;
     int stream_index = 0;
+    int nb_entries = hls->nb_entries + hls->nb_writes;
 
-    if (hls->sequence - hls->nb_entries > hls->start_sequence && hls->init_time > 0) {
+    /* count the segments still being written as if they were already listed */
+    if (hls->max_nb_segments && hls->pl_type == PLAYLIST_TYPE_NONE)
+        nb_entries = FFMIN(nb_entries, hls->max_nb_segments);
+
+    if (hls->sequence - nb_entries > hls->start_sequence && hls->init_time > 0) {
         /* reset end_pts, hls->recording_time at end of the init hls list */
-        int init_list_dur = hls->init_time * hls->nb_entries * AV_TIME_BASE;
-        int after_init_list_dur = (hls->sequence - hls->nb_entries ) * hls->time * AV_TIME_BASE;
+        int init_list_dur = hls->init_time * nb_entries * AV_TIME_BASE;
+        int after_init_list_dur = (hls->sequence - nb_entries ) * hls->time * AV_TIME_BASE;
         hls->recording_time = hls->time * AV_TIME_BASE;
         end_pts = init_list_dur + after_init_list_dur ;
     }
@@ -1647,13 +2072,20 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
             return AVERROR(ENOMEM);
         }
 
-        av_write_frame(hls->avf, NULL); /* Flush any buffered data */
-
-        new_start_pos = avio_tell(hls->avf->pb);
+        if (!hls->nb_segment_writers) {
+            av_write_frame(hls->avf, NULL); /* Flush any buffered data */
+            new_start_pos = avio_tell(hls->avf->pb);
+        } else {
+            /* the segment is muxed later by its own muxer, its size is not known */
+            new_start_pos = 0;
+        }
         hls->size = new_start_pos - hls->start_pos;
 
         if (!byterange_mode) {
-            ff_format_io_close(s, &oc->pb);
+            if ((ret = hls_close_segment(s, oc)) < 0) {
+                av_free(old_filename);
+                return ret;
+            }
             if (hls->vtt_avf) {
                 ff_format_io_close(s, &hls->vtt_avf->pb);
             }
@@ -1705,12 +2137,19 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
             return ret;
         }
 
+        if ((ret = hls_reap_segment_writes(s, 0)) < 0)
+            return ret;
+
         if (!hls->fmp4_init_mode || byterange_mode)
             if ((ret = hls_window(s, 0)) < 0) {
                 return ret;
             }
     }
 
+#if HAVE_THREADS
+    if (hls->cur_write)
+        return hls_queue_packet(hls->cur_write, pkt);
+#endif
     ret = ff_write_chained(oc, stream_index, pkt, s, 0);
 
     return ret;
@@ -1722,23 +2161,36 @@ static int hls_write_trailer(struct AVFormatContext *s)
     AVFormatContext *oc = hls->avf;
     AVFormatContext *vtt_oc = hls->vtt_avf;
     char *old_filename = av_strdup(hls->avf->filename);
+    int segment_open = !!oc->pb;
+    int ret = 0, err;
 
     if (!old_filename) {
         return AVERROR(ENOMEM);
     }
 
-
-    av_write_trailer(oc);
-    if (oc->pb) {
-        hls->size = avio_tell(hls->avf->pb) - hls->start_pos;
-        ff_format_io_close(s, &oc->pb);
+#if HAVE_THREADS
+    segment_open |= !!hls->cur_write;
+#endif
+    if (!hls->nb_segment_writers)
+        av_write_trailer(oc);
+    if (segment_open) {
+        if (oc->pb)
+            hls->size = avio_tell(hls->avf->pb) - hls->start_pos;
+        ret = hls_close_segment(s, oc);
 
         if ((hls->flags & HLS_TEMP_FILE) && oc->filename[0]) {
             hls_rename_temp_file(s, oc);
         }
 
         /* after av_write_trailer, then duration + 1 duration per packet */
-        hls_append_segment(s, hls, hls->duration + hls->dpp, hls->start_pos, hls->size);
+        if (ret >= 0)
+            hls_append_segment(s, hls, hls->duration + hls->dpp, hls->start_pos, hls->size);
+    }
+
+    if ((err = hls_reap_segment_writes(s, 1)) < 0) {
+        av_log(s, AV_LOG_ERROR, "Failed to write all segments, the playlist is incomplete\n");
+        if (ret >= 0)
+            ret = err;
     }
 
     sls_flag_file_rename(hls, old_filename);
@@ -1767,7 +2219,28 @@ static int hls_write_trailer(struct AVFormatContext *s)
     hls_free_segments(hls->segments);
     hls_free_segments(hls->old_segments);
     av_free(old_filename);
-    return 0;
+    return ret;
+}
+
+static void hls_deinit(AVFormatContext *s)
+{
+#if HAVE_THREADS
+    HLSContext *hls = s->priv_data;
+    HLSSegmentWrite *w;
+
+    /* segments still being muxed when the trailer was not written */
+    while ((w = hls->writes)) {
+        pthread_join(w->thread, NULL);
+        hls->writes = w->next;
+        hls_free_segment_write(w);
+    }
+    hls->last_write = NULL;
+    hls->nb_writes  = 0;
+    if (hls->cur_write) {
+        hls_free_segment_write(hls->cur_write);
+        hls->cur_write = NULL;
+    }
+#endif
 }
 
 #define OFFSET(x) offsetof(HLSContext, x)
@@ -1810,6 +2283,7 @@ static const AVOption options[] = {
     {"second_level_segment_duration", "include segment duration in segment filenames when use_localtime", 0, AV_OPT_TYPE_CONST, {.i64 = HLS_SECOND_LEVEL_SEGMENT_DURATION }, 0, UINT_MAX,   E, "flags"},
     {"second_level_segment_size", "include segment size in segment filenames when use_localtime", 0, AV_OPT_TYPE_CONST, {.i64 = HLS_SECOND_LEVEL_SEGMENT_SIZE }, 0, UINT_MAX,   E, "flags"},
     {"periodic_rekey", "reload keyinfo file periodically for re-keying", 0, AV_OPT_TYPE_CONST, {.i64 = HLS_PERIODIC_REKEY }, 0, UINT_MAX,   E, "flags"},
+    {"resume_index", "keep a binary index of the playlist entries and resume from it on restart", 0, AV_OPT_TYPE_CONST, {.i64 = HLS_RESUME_INDEX }, 0, UINT_MAX,   E, "flags"},
     {"use_localtime", "set filename expansion with strftime at segment creation", OFFSET(use_localtime), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, E },
     {"use_localtime_mkdir", "create last directory component in strftime-generated filename", OFFSET(use_localtime_mkdir), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, E },
     {"hls_playlist_type", "set the HLS playlist type", OFFSET(pl_type), AV_OPT_TYPE_INT, {.i64 = PLAYLIST_TYPE_NONE }, 0, PLAYLIST_TYPE_NB-1, E, "pl_type" },
@@ -1821,6 +2295,7 @@ static const AVOption options[] = {
     {"epoch", "seconds since epoch", 0, AV_OPT_TYPE_CONST, {.i64 = HLS_START_SEQUENCE_AS_SECONDS_SINCE_EPOCH }, INT_MIN, INT_MAX, E, "start_sequence_source_type" },
     {"datetime", "current datetime as YYYYMMDDhhmmss", 0, AV_OPT_TYPE_CONST, {.i64 = HLS_START_SEQUENCE_AS_FORMATTED_DATETIME }, INT_MIN, INT_MAX, E, "start_sequence_source_type" },
     {"http_user_agent", "override User-Agent field in HTTP header", OFFSET(user_agent), AV_OPT_TYPE_STRING, {.str = NULL},  0, 0,    E},
+    {"hls_segment_writers", "set the number of segments written concurrently in the background", OFFSET(nb_segment_writers), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, E},
     { NULL },
 };
 
@@ -1844,5 +2319,6 @@ AVOutputFormat ff_hls_muxer = {
     .write_header   = hls_write_header,
     .write_packet   = hls_write_packet,
     .write_trailer  = hls_write_trailer,
+    .deinit         = hls_deinit,
     .priv_class     = &hls_class,
 };
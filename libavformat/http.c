@@ -300,6 +300,11 @@ fail:
 }
 
 int ff_http_do_new_request(URLContext *h, const char *uri)
+{
+    return ff_http_do_new_request2(h, uri, NULL);
+}
+
+int ff_http_do_new_request2(URLContext *h, const char *uri, AVDictionary **opts)
 {
     HTTPContext *s = h->priv_data;
     AVDictionary *options = NULL;
@@ -312,6 +317,12 @@ int ff_http_do_new_request(URLContext *h, const char *uri)
     if (!s->location)
         return AVERROR(ENOMEM);
 
+    if (opts) {
+        s->end_off = 0;
+        if ((ret = av_opt_set_dict(s, opts)) < 0)
+            return ret;
+    }
+
     ret = http_open_cnx(h, &options);
     av_dict_free(&options);
     return ret;
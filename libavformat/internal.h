@@ -196,6 +196,14 @@ struct AVStreamInternal {
      * Whether the internal avctx needs to be updated from codecpar (after a late change to codecpar)
      */
     int need_context_update;
+
+    /**
+     * Packets whose decoding avformat_find_stream_info() deferred, to
+     * decode them concurrently with the packets of the other streams.
+     */
+    struct FFProbePacket *probe_pkts;
+    int nb_probe_pkts;
+    unsigned int probe_pkts_size;
 };
 
 #ifdef __GNUC__
@@ -448,6 +456,17 @@ int ff_framehash_write_header(AVFormatContext *s);
  */
 int ff_read_packet(AVFormatContext *s, AVPacket *pkt);
 
+/**
+ * Like av_get_packet(), but let the packet reference the data directly if
+ * the underlying protocol can provide it without copying, e.g. the file
+ * protocol with the mmap option.
+ *
+ * Such packets are not writable, so this must only be used by demuxers
+ * which do not modify the packet data in place. Their padding is only
+ * guaranteed to be readable if the user allowed non-zero padding.
+ */
+int ff_get_packet_ref(AVIOContext *s, AVPacket *pkt, int size);
+
 /**
  * Interleave a packet per dts in an output media file.
  *
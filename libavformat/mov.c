@@ -6526,7 +6526,13 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
             goto retry;
         }
 
-        ret = av_get_packet(sc->pb, pkt, sample->size);
+        /* decryption and DV audio extraction work on the packet data in
+         * place, otherwise it can be referenced directly */
+        if (mov->aax_mode || sc->cenc.aes_ctr ||
+            (mov->dv_demux && sc->dv_audio_container))
+            ret = av_get_packet(sc->pb, pkt, sample->size);
+        else
+            ret = ff_get_packet_ref(sc->pb, pkt, sample->size);
         if (ret < 0) {
             if (should_retry(sc->pb, ret)) {
                 mov_current_sample_dec(sc);
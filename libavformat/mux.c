@@ -559,6 +559,7 @@ int avformat_write_header(AVFormatContext *s, AVDictionary **options)
 fail:
     if (s->oformat->deinit)
         s->oformat->deinit(s);
+    s->internal->initialized = 0;
     return ret;
 }
 
@@ -3122,7 +3122,7 @@ static int mxf_read_packet_old(AVFormatContext *s, AVPacket *pkt)
                     return ret;
                 }
             } else {
-                ret = av_get_packet(s->pb, pkt, klv.length);
+                ret = ff_get_packet_ref(s->pb, pkt, klv.length);
                 if (ret < 0)
                     return ret;
             }
@@ -3206,7 +3206,7 @@ static int mxf_read_packet(AVFormatContext *s, AVPacket *pkt)
     if ((ret64 = avio_seek(s->pb, pos, SEEK_SET)) < 0)
         return ret64;
 
-    if ((size = av_get_packet(s->pb, pkt, size)) < 0)
+    if ((size = ff_get_packet_ref(s->pb, pkt, size)) < 0)
         return size;
 
     pkt->stream_index = st->index;
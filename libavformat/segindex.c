@@ -0,0 +1,42 @@
+/*
+ * Segment index helpers for the segmenting muxers
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/error.h"
+#include "segindex.h"
+
+void ff_segindex_write_string(AVIOContext *pb, const char *str)
+{
+    int len = strlen(str);
+    avio_wb16(pb, len);
+    avio_write(pb, str, len);
+}
+
+int ff_segindex_read_string(AVIOContext *pb, char *buf, int size)
+{
+    int len = avio_rb16(pb);
+    /* at the end of the file avio_rb16() returns 0, which would be
+     * taken for an empty string */
+    if (avio_feof(pb) || len >= size || avio_read(pb, buf, len) != len)
+        return AVERROR_INVALIDDATA;
+    buf[len] = '\0';
+    return 0;
+}
@@ -0,0 +1,45 @@
+/*
+ * Segment index helpers for the segmenting muxers
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_SEGINDEX_H
+#define AVFORMAT_SEGINDEX_H
+
+#include "avio.h"
+
+/**
+ * Maximum number of segments accepted per list when reading an index.
+ */
+#define SEGINDEX_MAX_ENTRIES (1 << 20)
+
+/**
+ * Write a string to a segment index, as its 16-bit length followed by
+ * its characters.
+ */
+void ff_segindex_write_string(AVIOContext *pb, const char *str);
+
+/**
+ * Read a string written by ff_segindex_write_string() into buf.
+ *
+ * @return 0 on success, AVERROR_INVALIDDATA if the string does not fit
+ *         into size bytes or the index is truncated
+ */
+int ff_segindex_read_string(AVIOContext *pb, char *buf, int size);
+
+#endif /* AVFORMAT_SEGINDEX_H */
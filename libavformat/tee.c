@@ -19,10 +19,18 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "config.h"
+
+#if HAVE_THREADS
+#include <stdatomic.h>
+#endif
 
 #include "libavutil/avutil.h"
 #include "libavutil/avstring.h"
 #include "libavutil/opt.h"
+#include "libavutil/thread.h"
+#include "libavutil/threadmessage.h"
+#include "libavutil/time.h"
 #include "internal.h"
 #include "avformat.h"
 #include "avio_internal.h"
@@ -35,6 +43,12 @@ typedef enum {
 
 #define DEFAULT_SLAVE_FAILURE_POLICY ON_SLAVE_FAILURE_ABORT
 
+typedef struct TeeMessage {
+    AVPacket pkt;
+    int flush;          ///< flush the slave instead of writing pkt
+    int64_t time;       ///< time the packet was given to the tee muxer
+} TeeMessage;
+
 typedef struct {
     AVFormatContext *avf;
     AVBSFContext **bsfs; ///< bitstream filters per stream
@@ -47,6 +61,24 @@ typedef struct {
      * disabled output streams are set to -1 */
     int *stream_map;
     int header_written;
+
+#if HAVE_THREADS
+    /* parallel mode: packets are written by a thread per slave */
+    pthread_t thread;
+    AVThreadMessageQueue *queue;
+    atomic_int nb_queued;
+    int thread_ret;
+#endif
+
+    /* parallel mode statistics */
+    int queue_size;
+    int max_queued;
+    int64_t nb_blocked;
+    int64_t blocked_time;
+    int64_t nb_packets;
+    int64_t bytes;
+    int64_t total_lag;
+    int64_t max_lag;
 } TeeSlave;
 
 typedef struct TeeContext {
@@ -57,6 +89,8 @@ typedef struct TeeContext {
     int use_fifo;
     AVDictionary *fifo_options;
     char *fifo_options_str;
+    int parallel;
+    int queue_size;
 } TeeContext;
 
 static const char *const slave_delim     = "|";
@@ -69,6 +103,10 @@ static const AVOption options[] = {
          OFFSET(use_fifo), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM},
         {"fifo_options", "fifo pseudo-muxer options", OFFSET(fifo_options_str),
          AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM},
+        {"parallel", "Write to each slave in its own thread",
+         OFFSET(parallel), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM},
+        {"queue_size", "Maximum number of packets queued for each slave in parallel mode",
+         OFFSET(queue_size), AV_OPT_TYPE_INT, {.i64 = 64}, 1, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM},
         {NULL}
 };
 
@@ -119,18 +157,51 @@ static int parse_slave_fifo_options(const char *use_fifo,
     return ret;
 }
 
+static void log_slave_stats(TeeSlave *tee_slave)
+{
+    av_log(tee_slave->avf, AV_LOG_VERBOSE,
+           "%"PRId64" packets, %"PRId64" bytes written, "
+           "max queue %d/%d, blocked %"PRId64" times for %.3fs, "
+           "lag avg %.3fms max %.3fms\n",
+           tee_slave->nb_packets, tee_slave->bytes,
+           tee_slave->max_queued, tee_slave->queue_size,
+           tee_slave->nb_blocked, tee_slave->blocked_time / 1000000.0,
+           tee_slave->nb_packets ? tee_slave->total_lag / 1000.0 / tee_slave->nb_packets : 0,
+           tee_slave->max_lag / 1000.0);
+}
+
+static void stop_slave_thread(TeeSlave *tee_slave)
+{
+#if HAVE_THREADS
+    if (tee_slave->queue)
+        av_thread_message_queue_set_err_recv(tee_slave->queue, AVERROR_EOF);
+#endif
+}
+
 static int close_slave(TeeSlave *tee_slave)
 {
     AVFormatContext *avf;
     unsigned i;
-    int ret = 0;
+    int ret = 0, thread_ret = 0;
 
     avf = tee_slave->avf;
     if (!avf)
         return 0;
 
+#if HAVE_THREADS
+    if (tee_slave->queue) {
+        stop_slave_thread(tee_slave);
+        pthread_join(tee_slave->thread, NULL);
+        av_thread_message_queue_free(&tee_slave->queue);
+        thread_ret = tee_slave->thread_ret;
+        log_slave_stats(tee_slave);
+    }
+#endif
+
     if (tee_slave->header_written)
         ret = av_write_trailer(avf);
+    if (thread_ret < 0)
+        ret = thread_ret;
 
     if (tee_slave->bsfs) {
         for (i = 0; i < avf->nb_streams; ++i)
@@ -422,6 +493,141 @@ static void log_slave(TeeSlave *slave, void *log_ctx, int log_level)
     }
 }
 
+/**
+ * Filter pkt through the bitstream filters of its stream and write the
+ * result to the slave. Takes ownership of pkt.
+ */
+static int write_slave_packet(TeeSlave *tee_slave, AVPacket *pkt)
+{
+    AVFormatContext *avf2 = tee_slave->avf;
+    int s2 = pkt->stream_index;
+    AVBSFContext *bsfs = tee_slave->bsfs[s2];
+    int ret;
+
+    ret = av_bsf_send_packet(bsfs, pkt);
+    if (ret < 0) {
+        av_log(avf2, AV_LOG_ERROR, "Error while sending packet to bitstream filter: %s\n",
+               av_err2str(ret));
+        av_packet_unref(pkt);
+        return ret;
+    }
+
+    while(1) {
+        ret = av_bsf_receive_packet(bsfs, pkt);
+        if (ret == AVERROR(EAGAIN))
+            return 0;
+        else if (ret < 0)
+            return ret;
+
+        av_packet_rescale_ts(pkt, bsfs->time_base_out,
+                             avf2->streams[s2]->time_base);
+        ret = av_interleaved_write_frame(avf2, pkt);
+        if (ret < 0)
+            return ret;
+    }
+}
+
+#if HAVE_THREADS
+static void free_message(void *msg)
+{
+    TeeMessage *m = msg;
+    av_packet_unref(&m->pkt);
+}
+
+static void *slave_write_thread(void *arg)
+{
+    TeeSlave *tee_slave = arg;
+    TeeMessage msg;
+    int ret;
+
+    while ((ret = av_thread_message_queue_recv(tee_slave->queue, &msg, 0)) >= 0) {
+        atomic_fetch_sub(&tee_slave->nb_queued, 1);
+        if (msg.flush) {
+            ret = av_interleaved_write_frame(tee_slave->avf, NULL);
+        } else {
+            int size = msg.pkt.size;
+            ret = write_slave_packet(tee_slave, &msg.pkt);
+            if (ret >= 0) {
+                int64_t lag = av_gettime_relative() - msg.time;
+                tee_slave->nb_packets++;
+                tee_slave->bytes     += size;
+                tee_slave->total_lag += lag;
+                tee_slave->max_lag    = FFMAX(tee_slave->max_lag, lag);
+            }
+        }
+        if (ret < 0)
+            break;
+    }
+
+    if (ret == AVERROR_EOF)
+        ret = 0;
+    tee_slave->thread_ret = ret;
+    /* make the next packet sent to this slave fail with our error */
+    if (ret < 0)
+        av_thread_message_queue_set_err_send(tee_slave->queue, ret);
+    return NULL;
+}
+#endif
+
+static int start_slave_thread(TeeSlave *tee_slave, int queue_size)
+{
+#if HAVE_THREADS
+    int ret;
+
+    ret = av_thread_message_queue_alloc(&tee_slave->queue, queue_size,
+                                        sizeof(TeeMessage));
+    if (ret < 0)
+        return ret;
+    av_thread_message_queue_set_free_func(tee_slave->queue, free_message);
+    atomic_init(&tee_slave->nb_queued, 0);
+    tee_slave->queue_size = queue_size;
+
+    ret = pthread_create(&tee_slave->thread, NULL, slave_write_thread, tee_slave);
+    if (ret) {
+        av_thread_message_queue_free(&tee_slave->queue);
+        return AVERROR(ret);
+    }
+    return 0;
+#else
+    return AVERROR(ENOSYS);
+#endif
+}
+
+/**
+ * Queue pkt, or a flush request if pkt is NULL, for the slave thread.
+ * Takes ownership of pkt. Blocks while the queue of the slave is full.
+ */
+static int queue_slave_packet(TeeSlave *tee_slave, AVPacket *pkt)
+{
+#if HAVE_THREADS
+    TeeMessage msg = { .time = av_gettime_relative() };
+    int ret, queued;
+
+    if (pkt)
+        av_packet_move_ref(&msg.pkt, pkt);
+    else
+        msg.flush = 1;
+
+    queued = atomic_fetch_add(&tee_slave->nb_queued, 1) + 1;
+    ret = av_thread_message_queue_send(tee_slave->queue, &msg,
+                                       AV_THREAD_MESSAGE_NONBLOCK);
+    if (ret == AVERROR(EAGAIN)) {
+        tee_slave->nb_blocked++;
+        ret = av_thread_message_queue_send(tee_slave->queue, &msg, 0);
+        tee_slave->blocked_time += av_gettime_relative() - msg.time;
+    }
+    if (ret < 0) {
+        atomic_fetch_sub(&tee_slave->nb_queued, 1);
+        av_packet_unref(&msg.pkt);
+        return ret;
+    }
+    tee_slave->max_queued = FFMAX(tee_slave->max_queued, queued);
+    return 0;
+#else
+    return AVERROR(ENOSYS);
+#endif
+}
+
 static int tee_process_slave_failure(AVFormatContext *avf, unsigned slave_idx, int err_n)
 {
     TeeContext *tee = avf->priv_data;
@@ -479,6 +685,12 @@ static int tee_write_header(AVFormatContext *avf)
     }
     tee->nb_slaves = tee->nb_alive = nb_slaves;
 
+    if (tee->parallel && !HAVE_THREADS) {
+        av_log(avf, AV_LOG_WARNING, "Parallel mode requires threads, "
+               "writing to the slaves sequentially.\n");
+        tee->parallel = 0;
+    }
+
     for (i = 0; i < nb_slaves; i++) {
 
         tee->slaves[i].use_fifo = tee->use_fifo;
@@ -486,7 +698,9 @@ static int tee_write_header(AVFormatContext *avf)
         if (ret < 0)
             goto fail;
 
-        if ((ret = open_slave(avf, slaves[i], &tee->slaves[i])) < 0) {
+        if ((ret = open_slave(avf, slaves[i], &tee->slaves[i])) < 0 ||
+            (tee->parallel &&
+             (ret = start_slave_thread(&tee->slaves[i], tee->queue_size)) < 0)) {
             ret = tee_process_slave_failure(avf, i, ret);
             if (ret < 0)
                 goto fail;
@@ -522,6 +736,10 @@ static int tee_write_trailer(AVFormatContext *avf)
     int ret_all = 0, ret;
     unsigned i;
 
+    /* let all the slave threads drain their queues at the same time */
+    for (i = 0; i < tee->nb_slaves; i++)
+        stop_slave_thread(&tee->slaves[i]);
+
     for (i = 0; i < tee->nb_slaves; i++) {
         if ((ret = close_slave(&tee->slaves[i])) < 0) {
             ret = tee_process_slave_failure(avf, i, ret);
@@ -533,23 +751,50 @@ static int tee_write_trailer(AVFormatContext *avf)
     return ret_all;
 }
 
+static void tee_deinit(AVFormatContext *avf)
+{
+    TeeContext *tee = avf->priv_data;
+    unsigned i;
+
+    if (!tee->slaves)
+        return;
+
+    /* the trailer was not written, stop all the slave threads before
+     * closing the slaves */
+    for (i = 0; i < tee->nb_slaves; i++)
+        stop_slave_thread(&tee->slaves[i]);
+    close_slaves(avf);
+}
+
 static int tee_write_packet(AVFormatContext *avf, AVPacket *pkt)
 {
     TeeContext *tee = avf->priv_data;
     AVFormatContext *avf2;
-    AVBSFContext *bsfs;
-    AVPacket pkt2;
+    AVPacket pkt_ref = { 0 }, pkt2;
     int ret_all = 0, ret;
     unsigned i, s;
     int s2;
 
+    /* Make sure the payload is copied at most once, all the slaves then
+     * only get new references to it */
+    if (pkt && !pkt->buf) {
+        if ((ret = av_packet_ref(&pkt_ref, pkt)) < 0)
+            return ret;
+        pkt = &pkt_ref;
+    }
+
     for (i = 0; i < tee->nb_slaves; i++) {
-        if (!(avf2 = tee->slaves[i].avf))
+        TeeSlave *tee_slave = &tee->slaves[i];
+
+        if (!(avf2 = tee_slave->avf))
             continue;
 
         /* Flush slave if pkt is NULL*/
         if (!pkt) {
-            ret = av_interleaved_write_frame(avf2, NULL);
+            if (tee->parallel)
+                ret = queue_slave_packet(tee_slave, NULL);
+            else
+                ret = av_interleaved_write_frame(avf2, NULL);
             if (ret < 0) {
                 ret = tee_process_slave_failure(avf, i, ret);
                 if (!ret_all && ret < 0)
@@ -559,43 +804,22 @@ static int tee_write_packet(AVFormatContext *avf, AVPacket *pkt)
         }
 
         s = pkt->stream_index;
-        s2 = tee->slaves[i].stream_map[s];
+        s2 = tee_slave->stream_map[s];
         if (s2 < 0)
             continue;
 
         memset(&pkt2, 0, sizeof(AVPacket));
-        if ((ret = av_packet_ref(&pkt2, pkt)) < 0)
-            if (!ret_all) {
-                ret_all = ret;
-                continue;
-            }
-        bsfs = tee->slaves[i].bsfs[s2];
-        pkt2.stream_index = s2;
-
-        ret = av_bsf_send_packet(bsfs, &pkt2);
-        if (ret < 0) {
-            av_log(avf, AV_LOG_ERROR, "Error while sending packet to bitstream filter: %s\n",
-                   av_err2str(ret));
-            ret = tee_process_slave_failure(avf, i, ret);
-            if (!ret_all && ret < 0)
+        if ((ret = av_packet_ref(&pkt2, pkt)) < 0) {
+            if (!ret_all)
                 ret_all = ret;
+            continue;
         }
+        pkt2.stream_index = s2;
 
-        while(1) {
-            ret = av_bsf_receive_packet(bsfs, &pkt2);
-            if (ret == AVERROR(EAGAIN)) {
-                ret = 0;
-                break;
-            } else if (ret < 0) {
-                break;
-            }
-
-            av_packet_rescale_ts(&pkt2, bsfs->time_base_out,
-                                 avf2->streams[s2]->time_base);
-            ret = av_interleaved_write_frame(avf2, &pkt2);
-            if (ret < 0)
-                break;
-        };
+        if (tee->parallel)
+            ret = queue_slave_packet(tee_slave, &pkt2);
+        else
+            ret = write_slave_packet(tee_slave, &pkt2);
 
         if (ret < 0) {
             ret = tee_process_slave_failure(avf, i, ret);
@@ -603,6 +827,8 @@ static int tee_write_packet(AVFormatContext *avf, AVPacket *pkt)
                 ret_all = ret;
         }
     }
+
+    av_packet_unref(&pkt_ref);
     return ret_all;
 }
 
@@ -613,6 +839,7 @@ AVOutputFormat ff_tee_muxer = {
     .write_header      = tee_write_header,
     .write_trailer     = tee_write_trailer,
     .write_packet      = tee_write_packet,
+    .deinit            = tee_deinit,
     .priv_class        = &tee_muxer_class,
     .flags             = AVFMT_NOFILE | AVFMT_ALLOW_FLUSH,
 };
@@ -0,0 +1,350 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Demux HLS playlists served by a minimal local HTTP server with
+ * prefetch_segments, and check that the segments are requested over a
+ * single persistent connection, for whole file and byte range segments.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/adler32.h"
+#include "libavutil/avstring.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "libavformat/avformat.h"
+#include "libavformat/network.h"
+
+#define NB_SEGMENTS 8
+#define NB_PACKETS  256
+#define PACKET_SIZE 1024
+
+typedef struct Server {
+    int fd;
+    int port;
+    uint8_t *media;
+    int media_size;
+    int seg_offset[NB_SEGMENTS + 1];
+    char ranges[2048];
+    char files[2048];
+
+    pthread_mutex_t lock;
+    int quit;
+    int nb_connections;
+    int nb_requests;
+} Server;
+
+static int create_media(Server *s, uint32_t *checksum)
+{
+    AVFormatContext *oc;
+    AVStream *st;
+    AVLFG lfg;
+    uint8_t data[PACKET_SIZE];
+    int i, j, ret;
+
+    ret = avformat_alloc_output_context2(&oc, NULL, "nut", NULL);
+    if (ret < 0)
+        return ret;
+    oc->flags |= AVFMT_FLAG_BITEXACT;
+
+    if (!(st = avformat_new_stream(oc, NULL))) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    st->codecpar->codec_type  = AVMEDIA_TYPE_AUDIO;
+    st->codecpar->codec_id    = AV_CODEC_ID_PCM_S16LE;
+    st->codecpar->sample_rate = 8000;
+    st->codecpar->channels    = 1;
+    st->time_base             = (AVRational){ 1, 8000 };
+
+    if ((ret = avio_open_dyn_buf(&oc->pb)) < 0 ||
+        (ret = avformat_write_header(oc, NULL)) < 0)
+        goto end;
+
+    av_lfg_init(&lfg, 1);
+    for (i = 0; i < NB_PACKETS; i++) {
+        AVPacket pkt;
+
+        for (j = 0; j < PACKET_SIZE; j++)
+            data[j] = av_lfg_get(&lfg);
+        *checksum = av_adler32_update(*checksum, data, PACKET_SIZE);
+
+        av_init_packet(&pkt);
+        pkt.data  = data;
+        pkt.size  = PACKET_SIZE;
+        pkt.pts   = pkt.dts = i * PACKET_SIZE / 2;
+        pkt.flags = AV_PKT_FLAG_KEY;
+        if ((ret = av_write_frame(oc, &pkt)) < 0)
+            goto end;
+    }
+    ret = av_write_trailer(oc);
+
+end:
+    if (oc->pb)
+        s->media_size = avio_close_dyn_buf(oc->pb, &s->media);
+    avformat_free_context(oc);
+    return ret;
+}
+
+static void create_playlists(Server *s)
+{
+    static const char header[] = "#EXTM3U\n#EXT-X-VERSION:4\n"
+                                 "#EXT-X-TARGETDURATION:1\n";
+    int i;
+
+    av_strlcpy(s->ranges, header, sizeof(s->ranges));
+    av_strlcpy(s->files,  header, sizeof(s->files));
+    for (i = 0; i <= NB_SEGMENTS; i++)
+        s->seg_offset[i] = (int64_t)s->media_size * i / NB_SEGMENTS;
+    for (i = 0; i < NB_SEGMENTS; i++) {
+        av_strlcatf(s->ranges, sizeof(s->ranges),
+                    "#EXTINF:1,\n#EXT-X-BYTERANGE:%d@%d\nmedia.nut\n",
+                    s->seg_offset[i + 1] - s->seg_offset[i], s->seg_offset[i]);
+        av_strlcatf(s->files, sizeof(s->files), "#EXTINF:1,\nseg%d.nut\n", i);
+    }
+    av_strlcat(s->ranges, "#EXT-X-ENDLIST\n", sizeof(s->ranges));
+    av_strlcat(s->files,  "#EXT-X-ENDLIST\n", sizeof(s->files));
+}
+
+static int send_all(int fd, const void *buf, int size)
+{
+    const char *p = buf;
+
+    while (size > 0) {
+        int ret = send(fd, p, size, 0);
+        if (ret <= 0)
+            return -1;
+        p    += ret;
+        size -= ret;
+    }
+    return 0;
+}
+
+/* Answer the requests of one client until it closes the connection or asks
+ * for it to be closed. Ranges are honoured, as needed by byte range
+ * segments. */
+static void serve_connection(Server *s, int fd)
+{
+    char req[4096];
+    int len = 0;
+
+    req[0] = 0;
+    for (;;) {
+        const uint8_t *body = NULL;
+        char path[256], reply[256], *end, *range;
+        int64_t first = 0, last = -1;
+        int size = 0, seg, ret;
+
+        while (!(end = strstr(req, "\r\n\r\n"))) {
+            if (len >= sizeof(req) - 1)
+                return;
+            ret = recv(fd, req + len, sizeof(req) - 1 - len, 0);
+            if (ret <= 0)
+                return;
+            len += ret;
+            req[len] = 0;
+        }
+        end += 4;
+
+        pthread_mutex_lock(&s->lock);
+        s->nb_requests++;
+        pthread_mutex_unlock(&s->lock);
+
+        if (sscanf(req, "GET %255s", path) != 1)
+            return;
+        if (!strcmp(path, "/ranges.m3u8")) {
+            body = s->ranges;
+            size = strlen(s->ranges);
+        } else if (!strcmp(path, "/files.m3u8")) {
+            body = s->files;
+            size = strlen(s->files);
+        } else if (!strcmp(path, "/media.nut")) {
+            body = s->media;
+            size = s->media_size;
+        } else if (sscanf(path, "/seg%d.nut", &seg) == 1 &&
+                   seg >= 0 && seg < NB_SEGMENTS) {
+            body = s->media + s->seg_offset[seg];
+            size = s->seg_offset[seg + 1] - s->seg_offset[seg];
+        }
+
+        if ((range = av_stristr(req, "\r\nRange: bytes=")))
+            sscanf(range + 15, "%"SCNd64"-%"SCNd64, &first, &last);
+        if (last < 0 || last >= size)
+            last = size - 1;
+
+        if (!body || first > last) {
+            snprintf(reply, sizeof(reply),
+                     "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+            first = last = 0;
+        } else if (range) {
+            snprintf(reply, sizeof(reply),
+                     "HTTP/1.1 206 Partial Content\r\n"
+                     "Content-Range: bytes %"PRId64"-%"PRId64"/%d\r\n"
+                     "Content-Length: %"PRId64"\r\n\r\n",
+                     first, last, size, last - first + 1);
+        } else {
+            snprintf(reply, sizeof(reply),
+                     "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n", size);
+        }
+        if (send_all(fd, reply, strlen(reply)) < 0 ||
+            (body && send_all(fd, body + first, last - first + 1) < 0))
+            return;
+
+        if (av_stristr(req, "\r\nConnection: close"))
+            return;
+        len -= end - req;
+        memmove(req, end, len + 1);
+    }
+}
+
+static void *server_thread(void *arg)
+{
+    Server *s = arg;
+
+    for (;;) {
+        struct pollfd p = { s->fd, POLLIN, 0 };
+        int quit, fd;
+
+        pthread_mutex_lock(&s->lock);
+        quit = s->quit;
+        pthread_mutex_unlock(&s->lock);
+        if (quit)
+            break;
+
+        if (poll(&p, 1, 100) <= 0)
+            continue;
+        if ((fd = accept(s->fd, NULL, NULL)) < 0)
+            continue;
+
+        pthread_mutex_lock(&s->lock);
+        s->nb_connections++;
+        pthread_mutex_unlock(&s->lock);
+        serve_connection(s, fd);
+        closesocket(fd);
+    }
+    return NULL;
+}
+
+static int server_open(Server *s)
+{
+    struct sockaddr_in addr = { 0 };
+    socklen_t addr_len = sizeof(addr);
+
+    if ((s->fd = ff_socket(AF_INET, SOCK_STREAM, 0)) < 0)
+        return ff_neterrno();
+
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(s->fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(s->fd, 4) ||
+        getsockname(s->fd, (struct sockaddr *)&addr, &addr_len)) {
+        int ret = ff_neterrno();
+        closesocket(s->fd);
+        return ret;
+    }
+    s->port = ntohs(addr.sin_port);
+    return 0;
+}
+
+static int demux(Server *s, const char *name, uint32_t expected)
+{
+    AVFormatContext *ic = NULL;
+    AVDictionary *opts = NULL;
+    AVPacket pkt;
+    uint32_t checksum = 1;
+    char url[64];
+    int nb_packets = 0, ret;
+
+    pthread_mutex_lock(&s->lock);
+    s->nb_connections = s->nb_requests = 0;
+    pthread_mutex_unlock(&s->lock);
+
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/%s.m3u8", s->port, name);
+    av_dict_set(&opts, "prefetch_segments", "2", 0);
+    ret = avformat_open_input(&ic, url, av_find_input_format("hls"), &opts);
+    av_dict_free(&opts);
+    if (ret < 0) {
+        fprintf(stderr, "Failed to open %s: %s\n", url, av_err2str(ret));
+        return ret;
+    }
+
+    while ((ret = av_read_frame(ic, &pkt)) >= 0) {
+        checksum = av_adler32_update(checksum, pkt.data, pkt.size);
+        nb_packets++;
+        av_packet_unref(&pkt);
+    }
+    avformat_close_input(&ic);
+    if (ret != AVERROR_EOF) {
+        fprintf(stderr, "Failed to read %s: %s\n", url, av_err2str(ret));
+        return ret;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    printf("%s: %d packets, data %s, %d connections, %d requests\n",
+           name, nb_packets, checksum == expected ? "ok" : "corrupt",
+           s->nb_connections, s->nb_requests);
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+int main(void)
+{
+    Server s = { 0 };
+    pthread_t thread;
+    uint32_t checksum = 1;
+    int ret;
+
+    av_register_all();
+    avformat_network_init();
+
+    if ((ret = create_media(&s, &checksum)) < 0) {
+        fprintf(stderr, "Failed to create the media: %s\n", av_err2str(ret));
+        goto end;
+    }
+    create_playlists(&s);
+
+    if ((ret = server_open(&s)) < 0) {
+        fprintf(stderr, "Failed to start the server: %s\n", av_err2str(ret));
+        goto end;
+    }
+    pthread_mutex_init(&s.lock, NULL);
+    if ((ret = pthread_create(&thread, NULL, server_thread, &s))) {
+        ret = AVERROR(ret);
+        pthread_mutex_destroy(&s.lock);
+        closesocket(s.fd);
+        goto end;
+    }
+
+    if ((ret = demux(&s, "files", checksum)) >= 0)
+        ret = demux(&s, "ranges", checksum);
+
+    pthread_mutex_lock(&s.lock);
+    s.quit = 1;
+    pthread_mutex_unlock(&s.lock);
+    pthread_join(thread, NULL);
+    pthread_mutex_destroy(&s.lock);
+    closesocket(s.fd);
+
+end:
+    av_free(s.media);
+    avformat_network_deinit();
+    return ret < 0;
+}
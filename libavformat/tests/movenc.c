@@ -362,6 +362,7 @@ int main(int argc, char **argv)
     uint8_t content[HASH_SIZE];
     int empty_moov_pos;
     int prev_pos;
+    int i;
 
     for (;;) {
         c = getopt(argc, argv, "wh");
@@ -766,6 +767,18 @@ int main(int argc, char **argv)
     clear_duration = 0;
     do_interleave = 0;
 
+    // Test DASH with every frame written as a separate fragment, without
+    // per fragment sidx atoms, as in the low latency mode of the dash muxer.
+    init_out("dash-skip-sidx");
+    av_dict_set(&opts, "movflags", "frag_custom+delay_moov+dash+skip_sidx", 0);
+    init(1, 0);
+    for (i = 0; i < gop_size; i++) {
+        mux_frames(1, 0);
+        av_write_frame(ctx, NULL);
+    }
+    finish();
+    close_out();
+
 
     av_free(md5);
 
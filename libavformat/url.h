@@ -27,6 +27,7 @@
 #include "avio.h"
 #include "libavformat/version.h"
 
+#include "libavutil/buffer.h"
 #include "libavutil/dict.h"
 #include "libavutil/log.h"
 
@@ -49,6 +50,8 @@ typedef struct URLContext {
     const char *protocol_whitelist;
     const char *protocol_blacklist;
     int min_packet_size;        /**< if non zero, the stream is packetized with this min packet size */
+    int async_write_depth;      /**< number of buffers queued for asynchronous writing by the AVIOContext, 0 to write synchronously;
+                                     url_write and the interrupt callback then run on the writing thread */
 } URLContext;
 
 typedef struct URLProtocol {
@@ -86,6 +89,17 @@ typedef struct URLProtocol {
     int (*url_get_multi_file_handle)(URLContext *h, int **handles,
                                      int *numhandles);
     int (*url_get_short_seek)(URLContext *h);
+    /**
+     * Return in *buf a reference to size bytes of the resource starting at
+     * pos, followed by at least AV_INPUT_BUFFER_PADDING_SIZE readable bytes,
+     * without copying them. These bytes are zeroed unless the user allowed
+     * otherwise, e.g. with the mmap_nonzero_padding option of the file
+     * protocol. Fail with AVERROR(ENOSYS) if that padding is not available.
+     * Only meant for protocols which have the data in
+     * memory anyway, e.g. a file mapping.
+     */
+    int (*url_get_buffer)(URLContext *h, int64_t pos, int size,
+                          AVBufferRef **buf);
     int (*url_shutdown)(URLContext *h, int flags);
     int priv_data_size;
     const AVClass *priv_data_class;
@@ -257,6 +271,15 @@ int ffurl_get_multi_file_handle(URLContext *h, int **handles, int *numhandles);
  */
 int ffurl_get_short_seek(URLContext *h);
 
+/**
+ * Get a reference to size bytes of the resource starting at pos without
+ * copying them, see URLProtocol.url_get_buffer.
+ *
+ * @return 0 on success, AVERROR(ENOSYS) if the protocol cannot provide
+ * the data this way, another negative error code on failure.
+ */
+int ffurl_get_buffer(URLContext *h, int64_t pos, int size, AVBufferRef **buf);
+
 /**
  * Signal the URLContext that we are done reading or writing the stream.
  *
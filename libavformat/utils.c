@@ -32,6 +32,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/slicethread.h"
 #include "libavutil/time.h"
 #include "libavutil/time_internal.h"
 #include "libavutil/timestamp.h"
@@ -296,6 +297,22 @@ int av_get_packet(AVIOContext *s, AVPacket *pkt, int size)
     return append_packet_chunked(s, pkt, size);
 }
 
+int ff_get_packet_ref(AVIOContext *s, AVPacket *pkt, int size)
+{
+    av_init_packet(pkt);
+    pkt->data = NULL;
+    pkt->size = 0;
+    pkt->pos  = avio_tell(s);
+
+    if (ffio_read_buffer_ref(s, &pkt->buf, size) == size) {
+        pkt->data = pkt->buf->data;
+        pkt->size = size;
+        return size;
+    }
+
+    return append_packet_chunked(s, pkt, size);
+}
+
 int av_append_packet(AVIOContext *s, AVPacket *pkt, int size)
 {
     if (!pkt->size)
@@ -3037,6 +3054,61 @@ fail:
     return ret;
 }
 
+typedef struct FFProbePacket {
+    AVPacket pkt;
+    /* value of AVStream.codec_info_nb_frames when the packet was read */
+    int codec_info_nb_frames;
+} FFProbePacket;
+
+typedef struct ProbeDecodeContext {
+    AVFormatContext *ic;
+    AVDictionary **options;
+    int orig_nb_streams;
+} ProbeDecodeContext;
+
+static int queue_probe_packet(AVStream *st, const AVPacket *pkt)
+{
+    AVStreamInternal *sti = st->internal;
+    FFProbePacket *pp;
+    int ret;
+
+    pp = av_fast_realloc(sti->probe_pkts, &sti->probe_pkts_size,
+                         (sti->nb_probe_pkts + 1) * sizeof(*pp));
+    if (!pp)
+        return AVERROR(ENOMEM);
+    sti->probe_pkts = pp;
+    pp = &pp[sti->nb_probe_pkts];
+
+    av_init_packet(&pp->pkt);
+    ret = av_packet_ref(&pp->pkt, pkt);
+    if (ret < 0)
+        return ret;
+    pp->codec_info_nb_frames = st->codec_info_nb_frames;
+    sti->nb_probe_pkts++;
+    return 0;
+}
+
+/* Decode the queued packets of one stream, in the state they were read in. */
+static void decode_probe_packets(void *priv, int jobnr, int threadnr,
+                                 int nb_jobs, int nb_threads)
+{
+    ProbeDecodeContext *pd = priv;
+    AVStream *st           = pd->ic->streams[jobnr];
+    AVStreamInternal *sti  = st->internal;
+    int codec_info_nb_frames = st->codec_info_nb_frames;
+    int i;
+
+    for (i = 0; i < sti->nb_probe_pkts; i++) {
+        st->codec_info_nb_frames = sti->probe_pkts[i].codec_info_nb_frames;
+        try_decode_frame(pd->ic, st, &sti->probe_pkts[i].pkt,
+                         (pd->options && jobnr < pd->orig_nb_streams) ?
+                         &pd->options[jobnr] : NULL);
+        av_packet_unref(&sti->probe_pkts[i].pkt);
+    }
+    st->codec_info_nb_frames = codec_info_nb_frames;
+    sti->nb_probe_pkts = 0;
+}
+
 unsigned int ff_codec_get_tag(const AVCodecTag *tags, enum AVCodecID id)
 {
     while (tags->id != AV_CODEC_ID_NONE) {
@@ -3509,6 +3581,9 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
     int64_t probesize = ic->probesize;
     int eof_reached = 0;
     int *missing_streams = av_opt_ptr(ic->iformat->priv_class, ic->priv_data, "missing_streams");
+    AVSliceThread *probe_thread = NULL;
+    ProbeDecodeContext probe_decode = { ic, options, orig_nb_streams };
+    int nb_probe_pkts = 0;
 
     flush_codecs = probesize > 0;
 
@@ -3615,6 +3690,24 @@ FF_ENABLE_DEPRECATION_WARNINGS
         ic->streams[i]->info->fps_last_dts  = AV_NOPTS_VALUE;
     }
 
+    /* With several threads, the packets are queued per stream while reading
+     * and the queues are decoded concurrently once about one packet per
+     * stream has been read, or when reading stops. */
+    if (ic->probe_threads != 1) {
+        ret = avpriv_slicethread_create(&probe_thread, &probe_decode,
+                                        decode_probe_packets, NULL,
+                                        ic->probe_threads);
+        if (ret <= 1) {
+            if (ret < 0 && ret != AVERROR(ENOSYS))
+                av_log(ic, AV_LOG_WARNING, "Failed to create probing threads: %s\n",
+                       av_err2str(ret));
+            avpriv_slicethread_free(&probe_thread);
+        } else {
+            av_log(ic, AV_LOG_DEBUG, "Decoding probe packets with %d threads\n", ret);
+        }
+        ret = 0;
+    }
+
     read_size = 0;
     for (;;) {
         int analyzed_all_streams;
@@ -3666,6 +3759,13 @@ FF_ENABLE_DEPRECATION_WARNINGS
         analyzed_all_streams = 0;
         if (!missing_streams || !*missing_streams)
         if (i == ic->nb_streams) {
+            /* The queued packets may still matter, e.g. for the decoding
+             * delay, decode them before deciding. */
+            if (nb_probe_pkts) {
+                avpriv_slicethread_execute(probe_thread, ic->nb_streams, 0);
+                nb_probe_pkts = 0;
+                continue;
+            }
             analyzed_all_streams = 1;
             /* NOTE: If the format has no header, then we need to read some
              * packets to get most of the streams, so we cannot stop here. */
@@ -3819,14 +3919,34 @@ FF_ENABLE_DEPRECATION_WARNINGS
          * least one frame of codec data, this makes sure the codec initializes
          * the channel configuration and does not only trust the values from
          * the container. */
-        try_decode_frame(ic, st, pkt,
-                         (options && i < orig_nb_streams) ? &options[i] : NULL);
+        if (probe_thread) {
+            ret = queue_probe_packet(st, pkt);
+            if (ret < 0) {
+                if (ic->flags & AVFMT_FLAG_NOBUFFER)
+                    av_packet_unref(pkt);
+                goto find_stream_info_err;
+            }
+            nb_probe_pkts++;
+        } else {
+            try_decode_frame(ic, st, pkt,
+                             (options && i < orig_nb_streams) ? &options[i] : NULL);
+        }
 
         if (ic->flags & AVFMT_FLAG_NOBUFFER)
             av_packet_unref(pkt);
 
         st->codec_info_nb_frames++;
         count++;
+
+        if (nb_probe_pkts >= ic->nb_streams) {
+            avpriv_slicethread_execute(probe_thread, ic->nb_streams, 0);
+            nb_probe_pkts = 0;
+        }
+    }
+
+    if (nb_probe_pkts) {
+        avpriv_slicethread_execute(probe_thread, ic->nb_streams, 0);
+        nb_probe_pkts = 0;
     }
 
     if (eof_reached) {
@@ -4079,7 +4199,13 @@ find_stream_info_err:
         av_freep(&ic->streams[i]->info);
         av_bsf_free(&ic->streams[i]->internal->extract_extradata.bsf);
         av_packet_free(&ic->streams[i]->internal->extract_extradata.pkt);
+        for (j = 0; j < st->internal->nb_probe_pkts; j++)
+            av_packet_unref(&st->internal->probe_pkts[j].pkt);
+        st->internal->nb_probe_pkts = 0;
+        av_freep(&st->internal->probe_pkts);
+        st->internal->probe_pkts_size = 0;
     }
+    avpriv_slicethread_free(&probe_thread);
     if (ic->pb)
         av_log(ic, AV_LOG_DEBUG, "After avformat_find_stream_info() pos: %"PRId64" bytes read:%"PRId64" seeks:%d frames:%d\n",
                avio_tell(ic->pb), ic->pb->bytes_read, ic->pb->seek_count, count);
@@ -4308,6 +4434,10 @@ void avformat_free_context(AVFormatContext *s)
     if (!s)
         return;
 
+    /* muxers freed without writing the trailer */
+    if (s->oformat && s->oformat->deinit && s->internal && s->internal->initialized)
+        s->oformat->deinit(s);
+
     av_opt_free(s);
     if (s->iformat && s->iformat->priv_class && s->priv_data)
         av_opt_free(s->priv_data);
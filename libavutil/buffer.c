@@ -215,6 +215,17 @@ int av_buffer_realloc(AVBufferRef **pbuf, int size)
     return 0;
 }
 
+static void pool_init(AVBufferPool *pool)
+{
+    ff_mutex_init(&pool->mutex, NULL);
+
+    atomic_init(&pool->pool, 0);
+    atomic_init(&pool->refcount, 1);
+    atomic_init(&pool->hits, 0);
+    atomic_init(&pool->misses, 0);
+    atomic_init(&pool->peak, 0);
+}
+
 AVBufferPool *av_buffer_pool_init2(int size, void *opaque,
                                    AVBufferRef* (*alloc)(void *opaque, int size),
                                    void (*pool_free)(void *opaque))
@@ -223,15 +234,13 @@ AVBufferPool *av_buffer_pool_init2(int size, void *opaque,
     if (!pool)
         return NULL;
 
-    ff_mutex_init(&pool->mutex, NULL);
+    pool_init(pool);
 
     pool->size      = size;
     pool->opaque    = opaque;
     pool->alloc2    = alloc;
     pool->pool_free = pool_free;
 
-    atomic_init(&pool->refcount, 1);
-
     return pool;
 }
 
@@ -241,29 +250,36 @@ AVBufferPool *av_buffer_pool_init(int size, AVBufferRef* (*alloc)(int size))
     if (!pool)
         return NULL;
 
-    ff_mutex_init(&pool->mutex, NULL);
+    pool_init(pool);
 
     pool->size     = size;
     pool->alloc    = alloc ? alloc : av_buffer_alloc;
 
-    atomic_init(&pool->refcount, 1);
-
     return pool;
 }
 
+static BufferPoolEntry *pool_entry(AVBufferPool *pool, unsigned index)
+{
+    int chunk = av_log2(index + 1);
+
+    return &pool->entries[chunk][index + 1 - (1U << chunk)];
+}
+
 /*
  * This function gets called when the pool has been uninited and
  * all the buffers returned to it.
  */
 static void buffer_pool_free(AVBufferPool *pool)
 {
-    while (pool->pool) {
-        BufferPoolEntry *buf = pool->pool;
-        pool->pool = buf->next;
+    unsigned i;
+
+    for (i = 0; i < pool->nb_entries; i++) {
+        BufferPoolEntry *buf = pool_entry(pool, i);
 
         buf->free(buf->opaque, buf->data);
-        av_freep(&buf);
     }
+    for (i = 0; i < FF_ARRAY_ELEMS(pool->entries); i++)
+        av_freep(&pool->entries[i]);
     ff_mutex_destroy(&pool->mutex);
 
     if (pool->pool_free)
@@ -285,6 +301,42 @@ void av_buffer_pool_uninit(AVBufferPool **ppool)
         buffer_pool_free(pool);
 }
 
+/*
+ * The free entries form a stack, linked by index. Every push and pop also
+ * increments the change count in the upper half of pool->pool, so a pop that
+ * read the next index of an entry which was popped and pushed back in the
+ * meantime fails its compare-and-swap and retries. Entries are never freed
+ * before the pool, so reading the next index of a stale top is safe.
+ */
+static void pool_push(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    uint64_t top = atomic_load_explicit(&pool->pool, memory_order_relaxed);
+
+    do {
+        atomic_store_explicit(&buf->next, (unsigned)top, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->pool, &top,
+                                                    ((top >> 32) + 1) << 32 | (buf->index + 1),
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+static BufferPoolEntry *pool_pop(AVBufferPool *pool)
+{
+    uint64_t top = atomic_load_explicit(&pool->pool, memory_order_acquire);
+    BufferPoolEntry *buf;
+
+    do {
+        if (!(unsigned)top)
+            return NULL;
+        buf = pool_entry(pool, (unsigned)top - 1);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->pool, &top,
+                                                    ((top >> 32) + 1) << 32 |
+                                                    atomic_load_explicit(&buf->next, memory_order_relaxed),
+                                                    memory_order_acquire,
+                                                    memory_order_acquire));
+    return buf;
+}
+
 static void pool_release_buffer(void *opaque, uint8_t *data)
 {
     BufferPoolEntry *buf = opaque;
@@ -293,37 +345,43 @@ static void pool_release_buffer(void *opaque, uint8_t *data)
     if(CONFIG_MEMORY_POISONING)
         memset(buf->data, FF_MEMORY_POISON, pool->size);
 
-    ff_mutex_lock(&pool->mutex);
-    buf->next = pool->pool;
-    pool->pool = buf;
-    ff_mutex_unlock(&pool->mutex);
+    pool_push(pool, buf);
 
     if (atomic_fetch_add_explicit(&pool->refcount, -1, memory_order_acq_rel) == 1)
         buffer_pool_free(pool);
 }
 
 /* allocate a new buffer and override its free() callback so that
- * it is returned to the pool on free */
+ * it is returned to the pool on free, must be called under pool->mutex */
 static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
 {
     BufferPoolEntry *buf;
     AVBufferRef     *ret;
+    unsigned index = pool->nb_entries;
+    int chunk = av_log2(index + 1);
+
+    /* index + 1 must fit in the low half of pool->pool */
+    if (index == UINT32_MAX)
+        return NULL;
+    if (!pool->entries[chunk]) {
+        pool->entries[chunk] = av_calloc(1U << chunk, sizeof(*pool->entries[chunk]));
+        if (!pool->entries[chunk])
+            return NULL;
+    }
 
     ret = pool->alloc2 ? pool->alloc2(pool->opaque, pool->size) :
                          pool->alloc(pool->size);
     if (!ret)
         return NULL;
 
-    buf = av_mallocz(sizeof(*buf));
-    if (!buf) {
-        av_buffer_unref(&ret);
-        return NULL;
-    }
-
+    buf = pool_entry(pool, index);
     buf->data   = ret->buffer->data;
     buf->opaque = ret->buffer->opaque;
     buf->free   = ret->buffer->free;
     buf->pool   = pool;
+    buf->index  = index;
+    atomic_init(&buf->next, 0);
+    pool->nb_entries++;
 
     ret->buffer->opaque = buf;
     ret->buffer->free   = pool_release_buffer;
@@ -333,25 +391,50 @@ static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
 
 AVBufferRef *av_buffer_pool_get(AVBufferPool *pool)
 {
-    AVBufferRef *ret;
+    AVBufferRef *ret = NULL;
     BufferPoolEntry *buf;
-
-    ff_mutex_lock(&pool->mutex);
-    buf = pool->pool;
+    unsigned outstanding, peak;
+
+    /* the caller holds one reference to the pool until it is uninited */
+    outstanding = atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
+    peak        = atomic_load_explicit(&pool->peak, memory_order_relaxed);
+    while (outstanding > peak &&
+           !atomic_compare_exchange_weak_explicit(&pool->peak, &peak, outstanding,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
+
+    buf = pool_pop(pool);
     if (buf) {
         ret = av_buffer_create(buf->data, pool->size, pool_release_buffer,
                                buf, 0);
-        if (ret) {
-            pool->pool = buf->next;
-            buf->next = NULL;
-        }
+        if (ret)
+            atomic_fetch_add_explicit(&pool->hits, 1, memory_order_relaxed);
+        else
+            pool_push(pool, buf);
     } else {
+        ff_mutex_lock(&pool->mutex);
         ret = pool_alloc_buffer(pool);
+        ff_mutex_unlock(&pool->mutex);
+        if (ret)
+            atomic_fetch_add_explicit(&pool->misses, 1, memory_order_relaxed);
     }
-    ff_mutex_unlock(&pool->mutex);
 
-    if (ret)
-        atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
+    if (!ret)
+        atomic_fetch_add_explicit(&pool->refcount, -1, memory_order_relaxed);
 
     return ret;
 }
+
+AVBufferPoolStats *av_buffer_pool_get_stats(AVBufferPool *pool)
+{
+    AVBufferPoolStats *stats = av_mallocz(sizeof(*stats));
+
+    if (!stats)
+        return NULL;
+    stats->hits             = atomic_load_explicit(&pool->hits,   memory_order_relaxed);
+    stats->misses           = atomic_load_explicit(&pool->misses, memory_order_relaxed);
+    stats->outstanding      = atomic_load_explicit(&pool->refcount, memory_order_relaxed) - 1;
+    stats->peak_outstanding = atomic_load_explicit(&pool->peak,   memory_order_relaxed);
+    return stats;
+}
@@ -284,6 +284,46 @@ void av_buffer_pool_uninit(AVBufferPool **pool);
  */
 AVBufferRef *av_buffer_pool_get(AVBufferPool *pool);
 
+/**
+ * Usage statistics of a buffer pool, returned by av_buffer_pool_get_stats().
+ *
+ * sizeof(AVBufferPoolStats) is not a part of the public ABI, new fields may be
+ * added to the end with a minor bump.
+ */
+typedef struct AVBufferPoolStats {
+    /**
+     * Number of av_buffer_pool_get() calls served with a buffer from the pool.
+     */
+    uint64_t hits;
+    /**
+     * Number of av_buffer_pool_get() calls that had to allocate a new buffer.
+     */
+    uint64_t misses;
+    /**
+     * Number of buffers currently handed out and not yet returned.
+     */
+    unsigned int outstanding;
+    /**
+     * Highest number of buffers handed out at the same time.
+     */
+    unsigned int peak_outstanding;
+} AVBufferPoolStats;
+
+/**
+ * Get usage statistics of a pool.
+ *
+ * This function may be called while other threads use the pool. The counters
+ * are then not a consistent snapshot: each of them is exact on its own, but
+ * e.g. outstanding may be briefly higher than peak_outstanding, or hits and
+ * misses may not count a call yet which outstanding already does. Once no
+ * other thread uses the pool, all of them are exact.
+ *
+ * @param pool the pool to query, it must not have been uninited yet
+ * @return the statistics of the pool, to be freed with av_free(), or NULL
+ *         on allocation failure
+ */
+AVBufferPoolStats *av_buffer_pool_get_stats(AVBufferPool *pool);
+
 /**
  * @}
  */
@@ -70,12 +70,32 @@ typedef struct BufferPoolEntry {
     void (*free)(void *opaque, uint8_t *data);
 
     AVBufferPool *pool;
-    struct BufferPoolEntry *next;
+    unsigned index;         ///< position of the entry in the pool
+    atomic_uint next;       ///< index + 1 of the next free entry, 0 for none
 } BufferPoolEntry;
 
 struct AVBufferPool {
+    /*
+     * The mutex only serializes the allocation of new buffers, since the
+     * alloc callbacks are not required to be reentrant. Free buffers are
+     * kept in a lock-free stack, see buffer.c.
+     */
     AVMutex mutex;
-    BufferPoolEntry *pool;
+
+    /*
+     * All the entries of the pool, never moved nor freed before the pool.
+     * Chunk k holds 1 << k entries, chunks are allocated under mutex.
+     */
+    BufferPoolEntry *entries[32];
+    unsigned nb_entries;    ///< under mutex
+
+    /*
+     * Top of the stack of free entries: index + 1 of the first entry in the
+     * low 32 bits, 0 if the stack is empty, and a count of the changes of the
+     * stack in the high 32 bits, which keeps a pop from succeeding after the
+     * stack was popped and pushed to again.
+     */
+    atomic_uint_least64_t pool;
 
     /*
      * This is used to track when the pool is to be freed.
@@ -88,6 +108,11 @@ struct AVBufferPool {
      */
     atomic_uint refcount;
 
+    /* statistics, see av_buffer_pool_get_stats() */
+    atomic_uint_least64_t hits;
+    atomic_uint_least64_t misses;
+    atomic_uint peak;
+
     int size;
     void *opaque;
     AVBufferRef* (*alloc)(int size);
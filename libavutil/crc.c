@@ -23,6 +23,8 @@
 #include "bswap.h"
 #include "common.h"
 #include "crc.h"
+#include "crc_internal.h"
+#include "thread.h"
 
 #if CONFIG_HARDCODED_TABLES
 static const AVCRC av_crc_table[AV_CRC_MAX][257] = {
@@ -291,7 +293,10 @@ static const AVCRC av_crc_table[AV_CRC_MAX][257] = {
 #else
 #define CRC_TABLE_SIZE 1024
 #endif
-static struct {
+static AVCRC av_crc_table[AV_CRC_MAX][CRC_TABLE_SIZE];
+#endif
+
+static const struct {
     uint8_t  le;
     uint8_t  bits;
     uint32_t poly;
@@ -304,8 +309,9 @@ static struct {
     [AV_CRC_32_IEEE_LE] = { 1, 32, 0xEDB88320 },
     [AV_CRC_16_ANSI_LE] = { 1, 16,     0xA001 },
 };
-static AVCRC av_crc_table[AV_CRC_MAX][CRC_TABLE_SIZE];
-#endif
+
+static FFCRCContext av_crc_ctx[AV_CRC_MAX];
+static AVOnce av_crc_ctx_once = AV_ONCE_INIT;
 
 int av_crc_init(AVCRC *ctx, int le, int bits, uint32_t poly, int ctx_size)
 {
@@ -340,22 +346,8 @@ int av_crc_init(AVCRC *ctx, int le, int bits, uint32_t poly, int ctx_size)
     return 0;
 }
 
-const AVCRC *av_crc_get_table(AVCRCId crc_id)
-{
-#if !CONFIG_HARDCODED_TABLES
-    if (!av_crc_table[crc_id][FF_ARRAY_ELEMS(av_crc_table[crc_id]) - 1])
-        if (av_crc_init(av_crc_table[crc_id],
-                        av_crc_table_params[crc_id].le,
-                        av_crc_table_params[crc_id].bits,
-                        av_crc_table_params[crc_id].poly,
-                        sizeof(av_crc_table[crc_id])) < 0)
-            return NULL;
-#endif
-    return av_crc_table[crc_id];
-}
-
-uint32_t av_crc(const AVCRC *ctx, uint32_t crc,
-                const uint8_t *buffer, size_t length)
+static av_always_inline uint32_t crc_table(const AVCRC *ctx, uint32_t crc,
+                                           const uint8_t *buffer, size_t length)
 {
     const uint8_t *end = buffer + length;
 
@@ -378,3 +370,65 @@ uint32_t av_crc(const AVCRC *ctx, uint32_t crc,
 
     return crc;
 }
+
+static uint32_t crc_update_c(const FFCRCContext *c, uint32_t crc,
+                             const uint8_t *buf, size_t len)
+{
+    return crc_table(c->table, crc, buf, len);
+}
+
+void ff_crc_init(FFCRCContext *c, const AVCRC *table,
+                 int le, int bits, uint32_t poly)
+{
+    c->table  = table;
+    c->update = crc_update_c;
+
+    if (ARCH_X86)
+        ff_crc_init_x86(c, le, bits, poly);
+}
+
+static av_cold void crc_ctx_init(void)
+{
+    int i;
+
+    for (i = 0; i < AV_CRC_MAX; i++)
+        if (av_crc_table_params[i].bits)
+            ff_crc_init(&av_crc_ctx[i], av_crc_table[i],
+                        av_crc_table_params[i].le,
+                        av_crc_table_params[i].bits,
+                        av_crc_table_params[i].poly);
+}
+
+const AVCRC *av_crc_get_table(AVCRCId crc_id)
+{
+#if !CONFIG_HARDCODED_TABLES
+    if (!av_crc_table[crc_id][FF_ARRAY_ELEMS(av_crc_table[crc_id]) - 1])
+        if (av_crc_init(av_crc_table[crc_id],
+                        av_crc_table_params[crc_id].le,
+                        av_crc_table_params[crc_id].bits,
+                        av_crc_table_params[crc_id].poly,
+                        sizeof(av_crc_table[crc_id])) < 0)
+            return NULL;
+#endif
+    ff_thread_once(&av_crc_ctx_once, crc_ctx_init);
+    return av_crc_table[crc_id];
+}
+
+uint32_t av_crc(const AVCRC *ctx, uint32_t crc,
+                const uint8_t *buffer, size_t length)
+{
+    /* Tables from av_crc_get_table() may have a faster implementation,
+     * which is only worth it for large enough buffers. */
+    if (length >= 64 &&
+        (uintptr_t)ctx - (uintptr_t)av_crc_table < sizeof(av_crc_table)) {
+        const FFCRCContext *c = &av_crc_ctx[(ctx - av_crc_table[0]) /
+                                            FF_ARRAY_ELEMS(av_crc_table[0])];
+        size_t blocks = length & ~(size_t)15;
+
+        crc = c->update(c, crc, buffer, blocks);
+        buffer += blocks;
+        length -= blocks;
+    }
+
+    return crc_table(ctx, crc, buffer, length);
+}
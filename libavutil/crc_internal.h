@@ -0,0 +1,57 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_CRC_INTERNAL_H
+#define AVUTIL_CRC_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crc.h"
+#include "mem.h"
+
+/**
+ * Block-wise CRC computation, used by av_crc() for the tables returned by
+ * av_crc_get_table().
+ */
+typedef struct FFCRCContext {
+    /**
+     * Constants used by the SIMD implementations, must stay first.
+     */
+    DECLARE_ALIGNED(16, uint64_t, consts)[8];
+
+    const AVCRC *table;
+
+    /**
+     * Update crc with the len bytes of buf. len must be a multiple of 16
+     * and at least 64. crc is in the same representation as for av_crc().
+     */
+    uint32_t (*update)(const struct FFCRCContext *c, uint32_t crc,
+                       const uint8_t *buf, size_t len);
+} FFCRCContext;
+
+/**
+ * Initialize c for the CRC with the given parameters, as passed to
+ * av_crc_init(), table being the corresponding table.
+ */
+void ff_crc_init(FFCRCContext *c, const AVCRC *table,
+                 int le, int bits, uint32_t poly);
+
+void ff_crc_init_x86(FFCRCContext *c, int le, int bits, uint32_t poly);
+
+#endif /* AVUTIL_CRC_INTERNAL_H */
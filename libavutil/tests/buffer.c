@@ -0,0 +1,138 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+
+#define POOL_SIZE   64
+#define NB_THREADS  4
+#define NB_ROUNDS   30000
+#define NB_HELD     3
+
+static void print_stats(AVBufferPool *pool, const char *when)
+{
+    AVBufferPoolStats *stats = av_buffer_pool_get_stats(pool);
+
+    if (!stats)
+        return;
+    printf("%s: hits %"PRIu64", misses %"PRIu64", outstanding %u, peak %u\n",
+           when, stats->hits, stats->misses, stats->outstanding,
+           stats->peak_outstanding);
+    av_free(stats);
+}
+
+/* Get and release buffers, checking that no buffer is handed out twice:
+ * each thread stamps the buffers it holds and checks the stamps are intact
+ * before releasing them. */
+static void *worker(void *arg)
+{
+    AVBufferPool *pool = arg;
+    AVBufferRef *bufs[NB_HELD], **self = bufs;
+    intptr_t errors = 0;
+    int i, j;
+
+    for (i = 0; i < NB_ROUNDS; i++) {
+        int n = 1 + i % NB_HELD;
+
+        for (j = 0; j < n; j++) {
+            if (!(bufs[j] = av_buffer_pool_get(pool)))
+                return (void *)(intptr_t)1;
+            memset(bufs[j]->data, j, POOL_SIZE);
+            memcpy(bufs[j]->data, &self, sizeof(self));
+        }
+        for (j = 0; j < n; j++) {
+            AVBufferRef **owner;
+
+            memcpy(&owner, bufs[j]->data, sizeof(owner));
+            if (owner != self || bufs[j]->data[POOL_SIZE - 1] != j)
+                errors++;
+            av_buffer_unref(&bufs[j]);
+        }
+    }
+    return (void *)errors;
+}
+
+int main(void)
+{
+    AVBufferPool *pool;
+    AVBufferPoolStats *stats;
+    AVBufferRef *bufs[4];
+    intptr_t errors = 0;
+    int i;
+
+    pool = av_buffer_pool_init(POOL_SIZE, NULL);
+    if (!pool)
+        return 1;
+
+    for (i = 0; i < 3; i++)
+        bufs[i] = av_buffer_pool_get(pool);
+    print_stats(pool, "3 gets");
+    av_buffer_unref(&bufs[0]);
+    av_buffer_unref(&bufs[1]);
+    print_stats(pool, "2 releases");
+    for (i = 0; i < 2; i++)
+        bufs[i] = av_buffer_pool_get(pool);
+    print_stats(pool, "2 gets");
+    bufs[3] = av_buffer_pool_get(pool);
+    print_stats(pool, "1 get");
+    for (i = 0; i < 4; i++)
+        av_buffer_unref(&bufs[i]);
+    print_stats(pool, "4 releases");
+    av_buffer_pool_uninit(&pool);
+
+    pool = av_buffer_pool_init(POOL_SIZE, NULL);
+    if (!pool)
+        return 1;
+#if HAVE_THREADS
+    {
+        pthread_t threads[NB_THREADS];
+        void *ret;
+
+        for (i = 0; i < NB_THREADS; i++)
+            if (pthread_create(&threads[i], NULL, worker, pool))
+                return 1;
+        for (i = 0; i < NB_THREADS; i++) {
+            pthread_join(threads[i], &ret);
+            errors += (intptr_t)ret;
+        }
+    }
+#else
+    for (i = 0; i < NB_THREADS; i++)
+        errors += (intptr_t)worker(pool);
+#endif
+
+    /* how often the free list was empty depends on the scheduling, but
+     * a buffer is only allocated when all the others are handed out */
+    stats = av_buffer_pool_get_stats(pool);
+    if (!stats)
+        return 1;
+    printf("%d threads: buffers %s, gets %s, outstanding %u, misses %s\n",
+           NB_THREADS, errors ? "shared" : "ok",
+           stats->hits + stats->misses == NB_THREADS * NB_ROUNDS * (NB_HELD + 1) / 2 ? "ok" : "lost",
+           stats->outstanding,
+           stats->misses <= stats->peak_outstanding &&
+           stats->peak_outstanding <= NB_THREADS * NB_HELD ? "ok" : "too many");
+    av_free(stats);
+    av_buffer_pool_uninit(&pool);
+
+    return errors != 0;
+}
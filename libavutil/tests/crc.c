@@ -18,10 +18,90 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
+#include "libavutil/common.h"
 #include "libavutil/crc.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
 
-int main(void)
+static const struct {
+    AVCRCId id;
+    int le, bits;
+    uint32_t poly;
+} params[] = {
+    { AV_CRC_8_ATM,      0,  8,       0x07 },
+    { AV_CRC_16_ANSI,    0, 16,     0x8005 },
+    { AV_CRC_16_CCITT,   0, 16,     0x1021 },
+    { AV_CRC_24_IEEE,    0, 24,   0x864CFB },
+    { AV_CRC_32_IEEE,    0, 32, 0x04C11DB7 },
+    { AV_CRC_32_IEEE_LE, 1, 32, 0xEDB88320 },
+    { AV_CRC_16_ANSI_LE, 1, 16,     0xA001 },
+};
+
+/* Check the accelerated code used for the standard tables against tables
+ * created by the caller, at all offsets and for various lengths. */
+static int check(const uint8_t *buf, int size)
+{
+    AVCRC table[1024];
+    int i, offset, len;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(params); i++) {
+        const AVCRC *ctx = av_crc_get_table(params[i].id);
+
+        av_crc_init(table, params[i].le, params[i].bits, params[i].poly,
+                    sizeof(table));
+        for (offset = 0; offset < 16; offset++) {
+            for (len = 0; len + offset <= size; len += len < 256 ? 1 : 97) {
+                uint32_t ref = av_crc(table, offset, buf + offset, len);
+                uint32_t new = av_crc(ctx,   offset, buf + offset, len);
+                if (ref != new) {
+                    printf("crc %08X offset %d len %d: %08X != %08X\n",
+                           params[i].poly, offset, len, new, ref);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static void bench(void)
+{
+    const int size = 1 << 20, runs = 256;
+    uint8_t *buf = av_malloc(size);
+    AVCRC table[1024];
+    int i, j;
+
+    if (!buf)
+        return;
+    for (i = 0; i < size; i++)
+        buf[i] = i * 7 + (i >> 9);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(params); i++) {
+        const AVCRC *ctx = av_crc_get_table(params[i].id);
+        uint32_t crc0 = 0, crc1 = 0;
+        int64_t t0, t1, t2;
+
+        av_crc_init(table, params[i].le, params[i].bits, params[i].poly,
+                    sizeof(table));
+        t0 = av_gettime_relative();
+        for (j = 0; j < runs; j++)
+            crc0 = av_crc(table, crc0, buf, size);
+        t1 = av_gettime_relative();
+        for (j = 0; j < runs; j++)
+            crc1 = av_crc(ctx, crc1, buf, size);
+        t2 = av_gettime_relative();
+        printf("crc %08X: table %7.1f MB/s, default %7.1f MB/s%s\n",
+               params[i].poly,
+               (double)size * runs / FFMAX(t1 - t0, 1),
+               (double)size * runs / FFMAX(t2 - t1, 1),
+               crc0 != crc1 ? " (mismatch)" : "");
+    }
+    av_free(buf);
+}
+
+int main(int argc, char **argv)
 {
     uint8_t buf[1999];
     int i;
@@ -42,5 +122,12 @@ int main(void)
         ctx = av_crc_get_table(p[i][0]);
         printf("crc %08X = %X\n", p[i][1], av_crc(ctx, 0, buf, sizeof(buf)));
     }
+
+    if (check(buf, sizeof(buf)))
+        return 1;
+
+    if (argc > 1 && !strcmp(argv[1], "-b"))
+        bench();
+
     return 0;
 }
@@ -128,6 +128,8 @@ int ff_get_cpu_flags_x86(void)
             rval |= AV_CPU_FLAG_SSE42;
         if (ecx & 0x01000000 )
             rval |= AV_CPU_FLAG_AESNI;
+        if (ecx & 0x00000002 )
+            rval |= AV_CPU_FLAG_CLMUL;
 #if HAVE_AVX
         /* Check OXSAVE and AVX bits */
         if ((ecx & 0x18000000) == 0x18000000) {
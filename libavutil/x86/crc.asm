@@ -0,0 +1,147 @@
+;*****************************************************************************
+;* x86-optimized CRC functions
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "x86util.asm"
+
+SECTION_RODATA
+
+pb_reverse: db 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+
+SECTION .text
+
+; The CRC is computed by folding the message 64 bytes at a time into four
+; 128 bit accumulators, which are folded into one, then reduced to 32 bits
+; with Barrett reduction. The constants are computed in ff_crc_init_x86():
+; [cq+ 0]: fold by 512 bits
+; [cq+16]: fold by 128 bits
+; [cq+32]: 128 to 64 bits reduction
+; [cq+48]: Barrett constant and polynomial
+
+; %1 = %1 * k (m4) ^ %2, clobbers m5
+%macro FOLD 2
+    pclmulqdq       m5, %1, m4, 0x00
+    pclmulqdq       %1, m4, 0x11
+    pxor            %1, m5
+    pxor            %1, %2
+%endmacro
+
+; load 16 bytes into %1, most significant byte first in BE mode
+%macro LOAD 2
+    movu            %1, %2
+%if be
+    pshufb          %1, m7
+%endif
+%endmacro
+
+;-----------------------------------------------------------------------------
+; uint32_t ff_crc_(le|be)(const FFCRCContext *c, uint32_t crc,
+;                         const uint8_t *buf, size_t len);
+; len is a multiple of 16, at least 64
+;-----------------------------------------------------------------------------
+%macro CRC 2 ; big-endian, suffix
+%assign be %1
+cglobal crc_ %+ %2, 4, 4, 7 + be, c, crc, buf, len
+%if be
+    mova            m7, [pb_reverse]
+%endif
+    movu            m0, [bufq]
+    movd            m5, crcd
+    pxor            m0, m5
+%if be
+    pshufb          m0, m7
+%endif
+    LOAD            m1, [bufq+16]
+    LOAD            m2, [bufq+32]
+    LOAD            m3, [bufq+48]
+    add           bufq, 64
+    sub           lenq, 64
+    mova            m4, [cq]
+    cmp           lenq, 64
+    jb .fold4
+.loop64:
+    LOAD            m6, [bufq]
+    FOLD            m0, m6
+    LOAD            m6, [bufq+16]
+    FOLD            m1, m6
+    LOAD            m6, [bufq+32]
+    FOLD            m2, m6
+    LOAD            m6, [bufq+48]
+    FOLD            m3, m6
+    add           bufq, 64
+    sub           lenq, 64
+    cmp           lenq, 64
+    jae .loop64
+.fold4:
+    mova            m4, [cq+16]
+    FOLD            m0, m1
+    FOLD            m0, m2
+    FOLD            m0, m3
+    test          lenq, lenq
+    jz .reduce
+.loop16:
+    LOAD            m6, [bufq]
+    FOLD            m0, m6
+    add           bufq, 16
+    sub           lenq, 16
+    jnz .loop16
+.reduce:
+    mova            m4, [cq+32]
+%if be
+    pclmulqdq       m5, m0, m4, 0x11
+    pslldq          m0, 8
+    psrldq          m0, 4
+    pxor            m0, m5
+    pclmulqdq       m5, m0, m4, 0x01
+    movq            m0, m0
+    pxor            m0, m5
+    mova            m4, [cq+48]
+    mova            m5, m0
+    psrlq           m5, 32
+    pclmulqdq       m5, m4, 0x00
+    psrlq           m5, 32
+    pclmulqdq       m5, m4, 0x10
+    pxor            m0, m5
+    movd           eax, m0
+    bswap          eax
+%else
+    pclmulqdq       m5, m0, m4, 0x00
+    psrldq          m0, 8
+    pslldq          m0, 4
+    pxor            m0, m5
+    pclmulqdq       m5, m0, m4, 0x10
+    pxor            m0, m5
+    psrldq          m0, 8
+    mova            m4, [cq+48]
+    movd          crcd, m0
+    movd            m5, crcd
+    pclmulqdq       m5, m4, 0x00
+    movd          crcd, m5
+    movd            m5, crcd
+    pclmulqdq       m5, m4, 0x10
+    pxor            m0, m5
+    psrlq           m0, 32
+    movd           eax, m0
+%endif
+    RET
+%endmacro
+
+INIT_XMM clmul
+CRC 0, le
+CRC 1, be
@@ -0,0 +1,101 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/crc_internal.h"
+#include "cpu.h"
+
+uint32_t ff_crc_le_clmul(const FFCRCContext *c, uint32_t crc,
+                         const uint8_t *buf, size_t len);
+uint32_t ff_crc_be_clmul(const FFCRCContext *c, uint32_t crc,
+                         const uint8_t *buf, size_t len);
+
+static uint64_t bitrev64(uint64_t v)
+{
+    uint64_t r = 0;
+    int i;
+
+    for (i = 0; i < 64; i++)
+        r |= ((v >> i) & 1) << (63 - i);
+    return r;
+}
+
+/* x^n mod (x^32 + p) */
+static uint32_t xpow_mod(int n, uint32_t p)
+{
+    uint32_t r = 1;
+
+    while (n--)
+        r = (r << 1) ^ (p & -(r >> 31));
+    return r;
+}
+
+/* x^64 / (x^32 + p), the Barrett reduction constant */
+static uint64_t xdiv(uint32_t p)
+{
+    uint64_t q = 1ULL << 32, r = (uint64_t)p << 32;
+    uint64_t poly = (1ULL << 32) | p;
+    int i;
+
+    for (i = 31; i >= 0; i--) {
+        if (r >> (32 + i) & 1) {
+            q |= 1ULL << i;
+            r ^= poly << i;
+        }
+    }
+    return q;
+}
+
+av_cold void ff_crc_init_x86(FFCRCContext *c, int le, int bits, uint32_t poly)
+{
+    int cpu_flags = av_get_cpu_flags();
+    uint32_t p;
+
+    if (bits < 8 || bits > 32)
+        return;
+
+    /* Every CRC is handled as a 32 bit one: the polynomials with less bits
+     * are multiplied by x^(32 - bits), which av_crc() tables do as well. */
+    if (le) {
+        p = bitrev64(poly) >> 32;
+        c->consts[0] = bitrev64(xpow_mod(512 + 64 - 1, p));
+        c->consts[1] = bitrev64(xpow_mod(512 - 1, p));
+        c->consts[2] = bitrev64(xpow_mod(128 + 64 - 1, p));
+        c->consts[3] = bitrev64(xpow_mod(128 - 1, p));
+        c->consts[4] = bitrev64(xpow_mod(96 - 1, p));
+        c->consts[5] = bitrev64(xpow_mod(64 - 1, p));
+        c->consts[6] = bitrev64(xdiv(p)) >> 31;
+        c->consts[7] = bitrev64((1ULL << 32) | p) >> 31;
+    } else {
+        p = poly << (32 - bits);
+        c->consts[0] = xpow_mod(512, p);
+        c->consts[1] = xpow_mod(512 + 64, p);
+        c->consts[2] = xpow_mod(128, p);
+        c->consts[3] = xpow_mod(128 + 64, p);
+        c->consts[4] = xpow_mod(64, p);
+        c->consts[5] = xpow_mod(96, p);
+        c->consts[6] = xdiv(p);
+        c->consts[7] = (1ULL << 32) | p;
+    }
+
+    if (EXTERNAL_CLMUL(cpu_flags))
+        c->update = le ? ff_crc_le_clmul : ff_crc_be_clmul;
+}
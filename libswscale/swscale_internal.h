@@ -31,6 +31,7 @@
 #include "libavutil/log.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/slicethread.h"
 #include "libavutil/ppc/util_altivec.h"
 
 #define STR(s) AV_TOSTRING(s) // AV_STRINGIFY is too long
@@ -321,6 +322,20 @@ typedef struct SwsContext {
     uint8_t *cascaded1_tmp[4];
     int cascaded_mainindex;
 
+    /* Slice threading: the destination picture is split into horizontal
+     * bands, each scaled by its own slice context from the whole source.
+     */
+    int nb_threads;               ///< Number of threads requested by the user, 0 for automatic.
+    AVSliceThread *slicethread;
+    struct SwsContext **slice_ctx;
+    int nb_slice_ctx;
+    const uint8_t *slice_src[4];  ///< Arguments of the threaded call, read by the workers.
+    int slice_src_stride[4];
+    uint8_t *slice_dst[4];
+    int slice_dst_stride[4];
+    int dst_slice_start;          ///< First destination line output by a slice context.
+    int dst_slice_end;            ///< Line after the last one output by a slice context, 0 for dstH.
+
     double gamma_value;
     int gamma_flag;
     int is_internal_gamma;
@@ -830,6 +845,9 @@ void ff_get_unscaled_swscale_aarch64(SwsContext *c);
  */
 SwsFunc ff_getSwsFunc(SwsContext *c);
 
+void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
+                         int nb_jobs, int nb_threads);
+
 void ff_sws_init_input_funcs(SwsContext *c);
 void ff_sws_init_output_funcs(SwsContext *c,
                               yuv2planar1_fn *yuv2plane1,
@@ -845,6 +845,25 @@ static void fill_xyztables(struct SwsContext *c)
     }
 }
 
+/* conversions done through cascaded contexts are not threaded, drop the
+ * slice contexts if sws_setColorspaceDetails() switches to a cascade */
+static void cascaded_threads_unsupported(SwsContext *c)
+{
+    int i;
+
+    if (c->nb_threads != 1)
+        av_log(c, AV_LOG_WARNING,
+               "Threading is not supported for conversions done in several "
+               "passes, using a single thread\n");
+    c->nb_threads = 1;
+
+    avpriv_slicethread_free(&c->slicethread);
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_freeContext(c->slice_ctx[i]);
+    av_freep(&c->slice_ctx);
+    c->nb_slice_ctx = 0;
+}
+
 int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
                              int srcRange, const int table[4], int dstRange,
                              int brightness, int contrast, int saturation)
@@ -852,6 +871,8 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     const AVPixFmtDescriptor *desc_dst;
     const AVPixFmtDescriptor *desc_src;
     int need_reinit = 0;
+    int yuv2yuv, cascade;
+    int i;
 
     handle_formats(c);
     desc_dst = av_pix_fmt_desc_get(c->dstFormat);
@@ -897,10 +918,21 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     if (!need_reinit)
         return 0;
 
-    if ((isYUV(c->dstFormat) || isGray(c->dstFormat)) && (isYUV(c->srcFormat) || isGray(c->srcFormat))) {
-        if (!c->cascaded_context[0] &&
-            memcmp(c->dstColorspaceTable, c->srcColorspaceTable, sizeof(int) * 4) &&
-            c->srcW && c->srcH && c->dstW && c->dstH) {
+    yuv2yuv = (isYUV(c->dstFormat) || isGray(c->dstFormat)) &&
+              (isYUV(c->srcFormat) || isGray(c->srcFormat));
+    cascade = yuv2yuv && !c->cascaded_context[0] &&
+              memcmp(c->dstColorspaceTable, c->srcColorspaceTable, sizeof(int) * 4) &&
+              c->srcW && c->srcH && c->dstW && c->dstH;
+
+    if (cascade)
+        cascaded_threads_unsupported(c);
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_setColorspaceDetails(c->slice_ctx[i], inv_table, srcRange,
+                                 table, dstRange,
+                                 brightness, contrast, saturation);
+
+    if (yuv2yuv) {
+        if (cascade) {
             enum AVPixelFormat tmp_format;
             int tmp_width, tmp_height;
             int srcW = c->srcW;
@@ -1150,6 +1182,57 @@ static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
     }
 }
 
+static av_cold int context_init_threaded(SwsContext *c,
+                                        SwsFilter *srcFilter, SwsFilter *dstFilter)
+{
+    int i, ret;
+
+    /* error diffusion carries state from one line to the next */
+    if (c->dither == SWS_DITHER_ED) {
+        c->nb_threads = 1;
+        return 0;
+    }
+
+    ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
+                                    ff_sws_slice_worker, NULL, c->nb_threads);
+    if (ret <= 1) {
+        avpriv_slicethread_free(&c->slicethread);
+        c->nb_threads = 1;
+        return ret == AVERROR(ENOSYS) ? 0 : FFMIN(ret, 0);
+    }
+    c->nb_threads = ret;
+
+    c->slice_ctx = av_mallocz_array(c->nb_threads, sizeof(*c->slice_ctx));
+    if (!c->slice_ctx)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < c->nb_threads; i++) {
+        SwsContext *slice = sws_alloc_context();
+        if (!slice)
+            return AVERROR(ENOMEM);
+        c->slice_ctx[c->nb_slice_ctx++] = slice;
+
+        /* the options were already normalized by handle_formats(), which
+         * is idempotent apart from the 0alpha flags */
+        ret = av_opt_copy(slice, c);
+        if (ret < 0)
+            return ret;
+        slice->src0Alpha  = c->src0Alpha;
+        slice->dst0Alpha  = c->dst0Alpha;
+        slice->nb_threads = 1;
+
+        ret = sws_init_context(slice, srcFilter, dstFilter);
+        if (ret < 0)
+            return ret;
+
+        sws_setColorspaceDetails(slice, c->srcColorspaceTable, c->srcRange,
+                                 c->dstColorspaceTable, c->dstRange,
+                                 c->brightness, c->contrast, c->saturation);
+    }
+
+    return 0;
+}
+
 av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                              SwsFilter *dstFilter)
 {
@@ -1505,6 +1588,7 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
             if (!c->cascaded_context[2])
                 return -1;
         }
+        cascaded_threads_unsupported(c);
         return 0;
     }
 
@@ -1529,6 +1613,7 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                                                     flags, NULL, dstFilter, c->param);
             if (!c->cascaded_context[1])
                 return -1;
+            cascaded_threads_unsupported(c);
             return 0;
         }
     }
@@ -1570,6 +1655,7 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
             if (ret < 0)
                 return ret;
 
+            cascaded_threads_unsupported(c);
             return 0;
         }
     }
@@ -1802,7 +1888,13 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     }
 
     c->swscale = ff_getSwsFunc(c);
-    return ff_init_filters(c);
+    ret = ff_init_filters(c);
+    if (ret < 0)
+        return ret;
+
+    if (c->nb_threads != 1)
+        return context_init_threaded(c, srcFilter, dstFilter);
+    return 0;
 fail: // FIXME replace things by appropriate error codes
     if (ret == RETCODE_USE_CASCADE)  {
         int tmpW = sqrt(srcW * (int64_t)dstW);
@@ -2287,6 +2379,11 @@ void sws_freeContext(SwsContext *c)
     if (!c)
         return;
 
+    avpriv_slicethread_free(&c->slicethread);
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_freeContext(c->slice_ctx[i]);
+    av_freep(&c->slice_ctx);
+
     for (i = 0; i < 4; i++)
         av_freep(&c->dither_error[i]);
 
@@ -0,0 +1,127 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavcodec/aacenc.h"
+
+#include "checkasm.h"
+
+#define BUF_SIZE 1024
+
+#define randomize(buf, len) do {                                \
+    int i;                                                      \
+    for (i = 0; i < len; i++) {                                 \
+        const float f = (float)rnd() / UINT_MAX;                \
+        (buf)[i] = (f - 0.5f) * 8192.0f;                        \
+    }                                                           \
+} while (0)
+
+static void test_abs_pow34(AACEncContext *s)
+{
+    LOCAL_ALIGNED_16(float, in,   [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float, out0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float, out1, [BUF_SIZE]);
+
+    declare_func(void, float *out, const float *in, const int size);
+
+    if (check_func(s->abs_pow34, "abs_pow34")) {
+        randomize(in, BUF_SIZE);
+        call_ref(out0, in, BUF_SIZE);
+        call_new(out1, in, BUF_SIZE);
+        if (!float_near_ulp_array(out0, out1, 1, BUF_SIZE))
+            fail();
+        bench_new(out1, in, BUF_SIZE);
+    }
+}
+
+static void test_quant_bands(AACEncContext *s)
+{
+    LOCAL_ALIGNED_16(float, in,     [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float, scaled, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(int,   out0,   [BUF_SIZE]);
+    LOCAL_ALIGNED_16(int,   out1,   [BUF_SIZE]);
+    int is_signed;
+
+    declare_func(void, int *out, const float *in, const float *scaled,
+                 int size, int is_signed, int maxval, const float Q34,
+                 const float rounding);
+
+    randomize(in, BUF_SIZE);
+    s->abs_pow34(scaled, in, BUF_SIZE);
+
+    for (is_signed = 0; is_signed <= 1; is_signed++) {
+        if (check_func(s->quant_bands, "quant_bands_%s", is_signed ? "signed" : "unsigned")) {
+            const float Q34 = (float)rnd() / UINT_MAX;
+            const int maxval = 1 + rnd() % 8191;
+            call_ref(out0, in, scaled, BUF_SIZE, is_signed, maxval, Q34, 0.4054f);
+            call_new(out1, in, scaled, BUF_SIZE, is_signed, maxval, Q34, 0.4054f);
+            if (memcmp(out0, out1, BUF_SIZE * sizeof(*out0)))
+                fail();
+            bench_new(out1, in, scaled, BUF_SIZE, is_signed, maxval, Q34, 0.4054f);
+        }
+    }
+}
+
+static void test_find_max_val(AACEncContext *s)
+{
+    LOCAL_ALIGNED_16(float, in,     [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float, scaled, [BUF_SIZE]);
+
+    declare_func_float(float, int group_len, int swb_size, const float *scaled);
+
+    randomize(in, BUF_SIZE);
+    s->abs_pow34(scaled, in, BUF_SIZE);
+
+    if (check_func(s->find_max_val, "find_max_val")) {
+        int i;
+        for (i = 0; i < 16; i++) {
+            /* swb sizes are always a multiple of 4, grouped windows are 128 apart */
+            const int group_len = 1 + rnd() % 8;
+            const int swb_size  = 4 * (1 + rnd() % 32);
+            const int start     = 4 * (rnd() % ((128 - swb_size) / 4 + 1));
+            float ref, new;
+            ref = call_ref(group_len, swb_size, scaled + start);
+            new = call_new(group_len, swb_size, scaled + start);
+            if (ref != new)
+                fail();
+        }
+        bench_new(8, 32, scaled);
+    }
+}
+
+void checkasm_check_aacencdsp(void)
+{
+    AACEncContext *s = av_mallocz(sizeof(*s));
+
+    if (!s)
+        return;
+
+    ff_aac_dsp_init(s);
+
+    test_abs_pow34(s);
+    report("abs_pow34");
+    test_quant_bands(s);
+    report("quant_bands");
+    test_find_max_val(s);
+    report("find_max_val");
+
+    av_free(s);
+}
@@ -0,0 +1,129 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/af_biquads.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define MAX_CHANNELS 8
+#define LEN 256
+
+/* second order lowpass with a random cutoff, as designed by the filter */
+static void init_coeffs(double *coeffs)
+{
+    double w0    = 2 * M_PI * (0.01 + 0.4 * (rnd() % 1000) / 1000.0);
+    double alpha = sin(w0) / (2 * M_SQRT1_2);
+    double a0    = 1 + alpha;
+
+    coeffs[0] = (1 - cos(w0)) / 2 / a0;
+    coeffs[1] = (1 - cos(w0))     / a0;
+    coeffs[2] = (1 - cos(w0)) / 2 / a0;
+    coeffs[3] = -2 * cos(w0)      / a0;
+    coeffs[4] = (1 - alpha)       / a0;
+}
+
+#define randomize_buffers(type)                                     \
+    do {                                                            \
+        int i;                                                      \
+        for (i = 0; i < MAX_CHANNELS * LEN; i++)                    \
+            src[i] = (type)(rnd() % 2001 - 1000) / 1000;            \
+        for (i = 0; i < MAX_CHANNELS * 4; i++)                      \
+            state0[i] = state1[i] = orig[i] =                       \
+                (double)(rnd() % 2001 - 1000) / 1000;               \
+        memset(dst0, 0, MAX_CHANNELS * LEN * sizeof(*dst0));        \
+        memset(dst1, 0, MAX_CHANNELS * LEN * sizeof(*dst1));        \
+    } while (0)
+
+/* the optimized version may leave some channels to the caller, whose
+ * output and state must then be left untouched */
+#define check_result(near)                                          \
+    do {                                                            \
+        int ch, i;                                                  \
+        if (n0 != nb_channels || n1 < 0 || n1 > nb_channels)        \
+            fail();                                                 \
+        for (ch = 0; ch < nb_channels; ch++) {                      \
+            for (i = 0; i < len; i++)                               \
+                if (ch < n1 ? !near(dst0[ch * LEN + i],             \
+                                    dst1[ch * LEN + i], 1e-6)       \
+                            : dst1[ch * LEN + i] != 0)              \
+                    fail();                                         \
+            for (i = 0; i < 4; i++) {                               \
+                const double *s = ch < n1 ? state0 : orig;          \
+                int j = i * nb_channels + ch;                       \
+                if (!double_near_abs_eps(s[j], state1[j], 1e-6))    \
+                    fail();                                         \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+#define CHECK_BIQUAD(name, type, near)                                      \
+static void check_biquad_ ## name(void)                                     \
+{                                                                           \
+    LOCAL_ALIGNED_32(type, src,    [MAX_CHANNELS * LEN]);                   \
+    LOCAL_ALIGNED_32(type, dst0,   [MAX_CHANNELS * LEN]);                   \
+    LOCAL_ALIGNED_32(type, dst1,   [MAX_CHANNELS * LEN]);                   \
+    LOCAL_ALIGNED_32(double, state0, [MAX_CHANNELS * 4]);                   \
+    LOCAL_ALIGNED_32(double, state1, [MAX_CHANNELS * 4]);                   \
+    LOCAL_ALIGNED_32(double, orig,   [MAX_CHANNELS * 4]);                   \
+    const type *srcp[MAX_CHANNELS];                                         \
+    type *dstp0[MAX_CHANNELS], *dstp1[MAX_CHANNELS];                        \
+    double coeffs[5];                                                       \
+    int nb_channels, len, ch, n0, n1;                                       \
+                                                                            \
+    declare_func(int, type **dst, const type **src, int nb_channels,        \
+                 int len, double *state, const double *coeffs);             \
+                                                                            \
+    for (ch = 0; ch < MAX_CHANNELS; ch++) {                                 \
+        srcp[ch]  = src  + ch * LEN;                                        \
+        dstp0[ch] = dst0 + ch * LEN;                                        \
+        dstp1[ch] = dst1 + ch * LEN;                                        \
+    }                                                                       \
+                                                                            \
+    for (nb_channels = 1; nb_channels <= MAX_CHANNELS; nb_channels++) {     \
+        for (len = 1; len <= LEN; len += len < 8 ? 1 : 31) {                \
+            init_coeffs(coeffs);                                            \
+            randomize_buffers(type);                                        \
+            n0 = call_ref(dstp0, srcp, nb_channels, len, state0, coeffs);   \
+            n1 = call_new(dstp1, srcp, nb_channels, len, state1, coeffs);   \
+            check_result(near);                                             \
+        }                                                                   \
+    }                                                                       \
+    bench_new(dstp1, srcp, MAX_CHANNELS, LEN, state1, coeffs);              \
+}
+
+CHECK_BIQUAD(flt, float,  float_near_abs_eps)
+CHECK_BIQUAD(dbl, double, double_near_abs_eps)
+
+void checkasm_check_biquads(void)
+{
+    BiquadDSPContext dsp;
+
+    ff_biquad_dsp_init(&dsp);
+
+    if (check_func(dsp.filter_flt, "biquad_flt"))
+        check_biquad_flt();
+    report("biquad_flt");
+
+    if (check_func(dsp.filter_dbl, "biquad_dbl"))
+        check_biquad_dbl();
+    report("biquad_dbl");
+}
@@ -69,6 +69,9 @@ static const struct {
         { "aacpsdsp", checkasm_check_aacpsdsp },
         { "sbrdsp",   checkasm_check_sbrdsp },
     #endif
+    #if CONFIG_AAC_ENCODER
+        { "aacencdsp", checkasm_check_aacencdsp },
+    #endif
     #if CONFIG_ALAC_DECODER
         { "alacdsp", checkasm_check_alacdsp },
     #endif
@@ -129,14 +132,24 @@ static const struct {
     #endif
 #endif
 #if CONFIG_AVFILTER
+    #if CONFIG_BIQUAD_FILTER
+        { "af_biquads", checkasm_check_biquads },
+    #endif
     #if CONFIG_BLEND_FILTER
         { "vf_blend", checkasm_check_blend },
     #endif
     #if CONFIG_COLORSPACE_FILTER
         { "vf_colorspace", checkasm_check_colorspace },
     #endif
+    #if CONFIG_LUT3D_FILTER
+        { "vf_lut3d", checkasm_check_lut3d },
+    #endif
+    #if CONFIG_OVERLAY_FILTER
+        { "vf_overlay", checkasm_check_overlay },
+    #endif
 #endif
 #if CONFIG_AVUTIL
+        { "crc", checkasm_check_crc },
         { "fixed_dsp", checkasm_check_fixed_dsp },
         { "float_dsp", checkasm_check_float_dsp },
 #endif
@@ -176,6 +189,7 @@ static const struct {
     { "SSE4.1",   "sse4",     AV_CPU_FLAG_SSE4 },
     { "SSE4.2",   "sse42",    AV_CPU_FLAG_SSE42 },
     { "AES-NI",   "aesni",    AV_CPU_FLAG_AESNI },
+    { "CLMUL",    "clmul",    AV_CPU_FLAG_CLMUL },
     { "AVX",      "avx",      AV_CPU_FLAG_AVX },
     { "XOP",      "xop",      AV_CPU_FLAG_XOP },
     { "FMA3",     "fma3",     AV_CPU_FLAG_FMA3 },
@@ -0,0 +1,83 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "checkasm.h"
+#include "libavutil/bswap.h"
+#include "libavutil/common.h"
+#include "libavutil/crc.h"
+#include "libavutil/crc_internal.h"
+#include "libavutil/mem.h"
+
+#define BUF_SIZE 4096
+
+static const struct {
+    const char *name;
+    AVCRCId id;
+    int le, bits;
+    uint32_t poly;
+} crcs[] = {
+    { "8_atm",      AV_CRC_8_ATM,      0,  8,       0x07 },
+    { "16_ansi",    AV_CRC_16_ANSI,    0, 16,     0x8005 },
+    { "16_ccitt",   AV_CRC_16_CCITT,   0, 16,     0x1021 },
+    { "24_ieee",    AV_CRC_24_IEEE,    0, 24,   0x864CFB },
+    { "32_ieee",    AV_CRC_32_IEEE,    0, 32, 0x04C11DB7 },
+    { "32_ieee_le", AV_CRC_32_IEEE_LE, 1, 32, 0xEDB88320 },
+    { "16_ansi_le", AV_CRC_16_ANSI_LE, 1, 16,     0xA001 },
+};
+
+static uint32_t random_crc(int le, int bits)
+{
+    uint32_t crc = rnd();
+
+    if (bits == 32)
+        return crc;
+    /* the non-reflected CRCs are stored shifted and byte swapped */
+    return le ? crc & ((1U << bits) - 1) : av_bswap32(crc << (32 - bits));
+}
+
+void checkasm_check_crc(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, buf, [BUF_SIZE + 1]);
+    int i, j;
+
+    declare_func(uint32_t, const FFCRCContext *c, uint32_t crc,
+                 const uint8_t *buf, size_t len);
+
+    for (i = 0; i < BUF_SIZE + 1; i++)
+        buf[i] = rnd();
+
+    for (i = 0; i < FF_ARRAY_ELEMS(crcs); i++) {
+        FFCRCContext c;
+
+        ff_crc_init(&c, av_crc_get_table(crcs[i].id),
+                    crcs[i].le, crcs[i].bits, crcs[i].poly);
+        if (check_func(c.update, "crc_%s", crcs[i].name)) {
+            for (j = 0; j < 16; j++) {
+                uint32_t crc = random_crc(crcs[i].le, crcs[i].bits);
+                size_t len = 64 + 16 * (rnd() % ((BUF_SIZE - 64) / 16 + 1));
+                int offset = rnd() & 1;
+
+                if (call_ref(&c, crc, buf + offset, len) !=
+                    call_new(&c, crc, buf + offset, len))
+                    fail();
+            }
+            bench_new(&c, 0, buf, BUF_SIZE);
+        }
+    }
+    report("crc");
+}
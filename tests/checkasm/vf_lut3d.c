@@ -0,0 +1,99 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_lut3d.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define LUT_SIZE 33
+#define WIDTH 64
+
+static float lut[LUT3D_MAX_LEVEL * LUT3D_MAX_LEVEL * LUT3D_MAX_LEVEL * 3];
+
+static void init_lut(void)
+{
+    int i, j, k, c;
+
+    for (i = 0; i < LUT_SIZE; i++)
+        for (j = 0; j < LUT_SIZE; j++)
+            for (k = 0; k < LUT_SIZE; k++)
+                for (c = 0; c < 3; c++)
+                    lut[((i * LUT3D_MAX_LEVEL + j) * LUT3D_MAX_LEVEL + k) * 3 + c] =
+                        (int)(rnd() % 1201 - 100) / 1000.f;
+}
+
+/* random coordinates, including points of the grid, the last point and
+ * points with equal components, the edge cases of the interpolation */
+static float rnd_coord(float other)
+{
+    switch (rnd() % 8) {
+    case 0:  return LUT_SIZE - 1;
+    case 1:  return rnd() % LUT_SIZE;
+    case 2:  return other;
+    default: return (rnd() % 100000) * (LUT_SIZE - 1) / 100000.f;
+    }
+}
+
+static void check_interp(void (*func)(float *r, float *g, float *b, int w,
+                                      const float *lut, int lutsize),
+                         const char *name)
+{
+    LOCAL_ALIGNED_32(float, src, [3 * WIDTH]);
+    LOCAL_ALIGNED_32(float, dst0, [3 * WIDTH]);
+    LOCAL_ALIGNED_32(float, dst1, [3 * WIDTH]);
+    int i, w;
+
+    declare_func(void, float *r, float *g, float *b, int w,
+                 const float *lut, int lutsize);
+
+    if (check_func(func, "%s", name)) {
+        for (i = 0; i < 3 * WIDTH; i++)
+            src[i] = rnd_coord(i >= WIDTH ? src[i - WIDTH] : 0);
+
+        for (w = 1; w <= WIDTH; w += w < 8 ? 1 : 7) {
+            const int padded = FFALIGN(w, 8);
+
+            memcpy(dst0, src, sizeof(*src) * 3 * WIDTH);
+            memcpy(dst1, src, sizeof(*src) * 3 * WIDTH);
+            call_ref(dst0, dst0 + WIDTH, dst0 + 2 * WIDTH, w, lut, LUT_SIZE);
+            call_new(dst1, dst1 + WIDTH, dst1 + 2 * WIDTH, w, lut, LUT_SIZE);
+            /* the padding may be overwritten */
+            for (i = 0; i < 3 * WIDTH; i++)
+                if (i % WIDTH < w ? dst0[i] != dst1[i] :
+                    i % WIDTH >= padded && dst1[i] != src[i])
+                    fail();
+        }
+        bench_new(dst1, dst1 + WIDTH, dst1 + 2 * WIDTH, WIDTH, lut, LUT_SIZE);
+    }
+}
+
+void checkasm_check_lut3d(void)
+{
+    LUT3DDSPContext dsp;
+
+    init_lut();
+    ff_lut3d_dsp_init(&dsp);
+
+    check_interp(dsp.interp_trilinear, "interp_trilinear");
+    report("interp_trilinear");
+
+    check_interp(dsp.interp_tetrahedral, "interp_tetrahedral");
+    report("interp_tetrahedral");
+}
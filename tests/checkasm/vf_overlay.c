@@ -0,0 +1,96 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_overlay.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 256
+
+/* alpha holds two rows of 2 * WIDTH samples for the subsampled case */
+#define randomize_buffers()                                 \
+    do {                                                    \
+        int i;                                              \
+        for (i = 0; i < WIDTH * 4; i++) {                   \
+            unsigned r = rnd();                             \
+            /* favour fully transparent/opaque */           \
+            switch (r & 3) {                                \
+            case 0:  alpha[i] = 0;      break;              \
+            case 1:  alpha[i] = 255;    break;              \
+            default: alpha[i] = r >> 8; break;              \
+            }                                               \
+        }                                                   \
+        for (i = 0; i < WIDTH; i++) {                       \
+            src[i] = rnd();                                 \
+            dst0[i] = dst1[i] = orig[i] = rnd();            \
+        }                                                   \
+    } while (0)
+
+/* the reference processes every pixel, the optimized version may leave a
+ * tail to the caller, which must be left untouched */
+#define check_result()                                      \
+    do {                                                    \
+        if (n0 != w || n1 < 0 || n1 > w ||                  \
+            memcmp(dst0, dst1, n1) ||                       \
+            memcmp(dst1 + n1, orig + n1, WIDTH - n1))       \
+            fail();                                         \
+    } while (0)
+
+void checkasm_check_overlay(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, src,   [WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t, dst0,  [WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t, dst1,  [WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t, orig,  [WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t, alpha, [WIDTH * 4]);
+    OverlayDSPContext dsp;
+    int w, n0, n1;
+
+    ff_overlay_dsp_init(&dsp);
+
+    if (check_func(dsp.blend_row_444, "blend_row_444")) {
+        declare_func(int, uint8_t *dst, const uint8_t *src,
+                     const uint8_t *alpha, int w);
+
+        for (w = 1; w <= WIDTH; w += w < 24 ? 1 : 29) {
+            randomize_buffers();
+            n0 = call_ref(dst0, src, alpha, w);
+            n1 = call_new(dst1, src, alpha, w);
+            check_result();
+        }
+        bench_new(dst1, src, alpha, WIDTH);
+    }
+    report("blend_row_444");
+
+    if (check_func(dsp.blend_row_420, "blend_row_420")) {
+        declare_func(int, uint8_t *dst, const uint8_t *src,
+                     const uint8_t *alpha, int w, ptrdiff_t alpha_linesize);
+
+        for (w = 1; w <= WIDTH; w += w < 24 ? 1 : 29) {
+            randomize_buffers();
+            n0 = call_ref(dst0, src, alpha, w, WIDTH * 2);
+            n1 = call_new(dst1, src, alpha, w, WIDTH * 2);
+            check_result();
+        }
+        bench_new(dst1, src, alpha, WIDTH, WIDTH * 2);
+    }
+    report("blend_row_420");
+}
@@ -241,6 +241,18 @@ fate-aac-pred-encode: CMP_TARGET = 841
 fate-aac-pred-encode: FUZZ = 12
 fate-aac-pred-encode: SIZE_TOLERANCE = 3560
 
+# 5.0 has three channel elements, which are searched in parallel with slice
+# threads; the stream must be the same for any number of threads, with PNS,
+# intensity stereo and TNS, which all change the output at this bitrate
+FATE_AAC_ENCODE_50 += fate-aac-encode-5.0
+fate-aac-encode-5.0: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-5.wav -c:a aac -b:a 128k -threads 1 -f adts -flags +bitexact
+
+FATE_AAC_ENCODE_50 += fate-aac-encode-5.0-threads
+fate-aac-encode-5.0-threads: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-5.wav -c:a aac -b:a 128k -threads 3 -thread_type slice -f adts -flags +bitexact
+fate-aac-encode-5.0-threads: REF = $(SRC_PATH)/tests/ref/fate/aac-encode-5.0
+
+$(FATE_AAC_ENCODE_50): tests/data/asynth-44100-5.wav
+
 FATE_AAC_LATM += fate-aac-latm_000000001180bc60
 fate-aac-latm_000000001180bc60: CMD = pcm -i $(TARGET_SAMPLES)/aac/latm_000000001180bc60.mpg
 fate-aac-latm_000000001180bc60: REF = $(SAMPLES)/aac/latm_000000001180bc60.s16
@@ -263,10 +275,12 @@ $(FATE_AAC_ALL): CMP  = oneoff
 $(FATE_AAC_ALL): FUZZ = 2
 
 FATE_AAC_ENCODE-$(call ENCMUX, AAC, ADTS) += $(FATE_AAC_ENCODE)
+FATE_AAC_ENCODE_50-$(call ALLYES, WAV_DEMUXER PCM_S16LE_DECODER AAC_ENCODER ADTS_MUXER) += $(FATE_AAC_ENCODE_50)
 
 FATE_AAC_BSF-$(call ALLYES, AAC_DEMUXER AAC_ADTSTOASC_BSF MATROSKA_MUXER) += fate-aac-autobsf-adtstoasc
 
 FATE_SAMPLES_FFMPEG += $(FATE_AAC_ALL) $(FATE_AAC_ENCODE-yes) $(FATE_AAC_BSF-yes)
+FATE_FFMPEG += $(FATE_AAC_ENCODE_50-yes)
 
-fate-aac: $(FATE_AAC_ALL) $(FATE_AAC_ENCODE) $(FATE_AAC_BSF-yes)
+fate-aac: $(FATE_AAC_ALL) $(FATE_AAC_ENCODE) $(FATE_AAC_ENCODE_50-yes) $(FATE_AAC_BSF-yes)
 fate-aac-latm: $(FATE_AAC_LATM-yes)
@@ -139,3 +139,83 @@ FATE_SEGMENT-$(call ALLYES, AAC_DEMUXER AAC_ADTSTOASC_BSF MATROSKA_MUXER MATROSK
 FATE_SAMPLES_FFMPEG += $(FATE_SEGMENT-yes)
 
 fate-segment: $(FATE_SEGMENT-yes)
+
+# packets referencing a file mapping must match the ones read normally; the
+# frames start with black rows, so that each one is followed by zeroes and
+# can be referenced without a copy, with or without non-zero padding allowed
+tests/data/mmap.mov: TAG = GEN
+tests/data/mmap.mov: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin \
+        -f lavfi -i "testsrc=size=32x24:rate=25:duration=2,pad=32:32:0:8:black" \
+        -flags +bitexact -codec:v rawvideo -pix_fmt rgb24 -y $(TARGET_PATH)/$@ 2>/dev/null
+
+FATE_MMAP-$(call ALLYES, FILE_PROTOCOL LAVFI_INDEV TESTSRC_FILTER PAD_FILTER RAWVIDEO_ENCODER MOV_MUXER MOV_DEMUXER) += fate-mmap-mov fate-mmap-mov-nonzero-padding fate-mmap-mov-off
+$(FATE_MMAP-yes): tests/data/mmap.mov
+fate-mmap-mov: CMD = framemd5 -mmap 1 -i $(TARGET_PATH)/tests/data/mmap.mov -c copy
+fate-mmap-mov-nonzero-padding: CMD = framemd5 -mmap 1 -mmap_nonzero_padding 1 -i $(TARGET_PATH)/tests/data/mmap.mov -c copy
+fate-mmap-mov-nonzero-padding: REF = $(SRC_PATH)/tests/ref/fate/mmap-mov
+fate-mmap-mov-off: CMD = framemd5 -mmap 0 -i $(TARGET_PATH)/tests/data/mmap.mov -c copy
+fate-mmap-mov-off: REF = $(SRC_PATH)/tests/ref/fate/mmap-mov
+
+FATE_FFMPEG += $(FATE_MMAP-yes)
+fate-mmap: $(FATE_MMAP-yes)
+
+# the slaves written in parallel must be identical to the ones written
+# one after the other
+tests/data/tee-%.nut: TAG = GEN
+tests/data/tee-%.nut: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin \
+        -f lavfi -i "testsrc=size=32x24:rate=25:duration=2" \
+        -f lavfi -i "sine=frequency=440:sample_rate=8000:duration=2" \
+        -map 0 -map 1 -flags +bitexact -fflags +bitexact -codec:v rawvideo -codec:a pcm_s16le \
+        -f tee -parallel $(if $(filter parallel,$*),1,0) -queue_size 4 \
+        "[f=nut]$(TARGET_PATH)/$@|[f=nut:select=a]$(TARGET_PATH)/tests/data/tee-$*-audio.nut" \
+        -y 2>/dev/null
+
+FATE_TEE-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER SINE_FILTER RAWVIDEO_ENCODER PCM_S16LE_ENCODER TEE_MUXER NUT_MUXER NUT_DEMUXER) += fate-tee-parallel fate-tee-serial
+fate-tee-parallel: tests/data/tee-parallel.nut
+fate-tee-parallel: CMD = framecrc -i $(TARGET_PATH)/tests/data/tee-parallel.nut -i $(TARGET_PATH)/tests/data/tee-parallel-audio.nut -map 0 -map 1 -c copy
+fate-tee-serial: tests/data/tee-serial.nut
+fate-tee-serial: CMD = framecrc -i $(TARGET_PATH)/tests/data/tee-serial.nut -i $(TARGET_PATH)/tests/data/tee-serial-audio.nut -map 0 -map 1 -c copy
+fate-tee-serial: REF = $(SRC_PATH)/tests/ref/fate/tee-parallel
+
+FATE_FFMPEG += $(FATE_TEE-yes)
+fate-tee: $(FATE_TEE-yes)
+
+tests/data/dash-resume.mpd: TAG = GEN
+tests/data/dash-resume.mpd: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)rm -f $(TARGET_PATH)/$@.idx; \
+        for i in 1 2; do \
+        $(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin \
+        -f lavfi -i "testsrc=size=64x48:rate=25:duration=5" -map 0 -flags +bitexact -codec:v mpeg4 -g 25 \
+        -f dash -min_seg_duration 2000000 -use_timeline 1 -use_template 1 -resume_index 1 \
+        -init_seg_name 'dash-resume-init-$$RepresentationID$$.m4s' \
+        -media_seg_name 'dash-resume-$$RepresentationID$$-$$Number%05d$$.m4s' \
+        $(TARGET_PATH)/$@ 2>/dev/null || exit 1; \
+        done
+
+# The fourth segment is the first one written after resuming, its decode
+# times must continue the timeline of the first run.
+FATE_DASH-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER MPEG4_ENCODER DASH_MUXER MOV_DEMUXER CONCAT_PROTOCOL) += fate-dash-resume
+fate-dash-resume: tests/data/dash-resume.mpd
+fate-dash-resume: CMD = framecrc -i "concat:$(TARGET_PATH)/tests/data/dash-resume-init-0.m4s|$(TARGET_PATH)/tests/data/dash-resume-0-00004.m4s" -c copy -copyts
+
+tests/data/dash-streaming.mpd: TAG = GEN
+tests/data/dash-streaming.mpd: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin \
+        -f lavfi -i "testsrc=size=64x48:rate=25:duration=2" -map 0 -flags +bitexact -codec:v mpeg4 -g 25 \
+        -f dash -streaming 1 -min_seg_duration 1000000 -use_timeline 1 -use_template 1 \
+        -init_seg_name 'dash-streaming-init-$$RepresentationID$$.m4s' \
+        -media_seg_name 'dash-streaming-$$RepresentationID$$-$$Number%05d$$.m4s' \
+        -y $(TARGET_PATH)/$@ 2>/dev/null
+
+# Every frame of the second segment is a chunk of its own, the segment must
+# still demux with continuous timestamps, and the manifest must announce the
+# early availability of the segments without marking them as incomplete.
+FATE_DASH-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER MPEG4_ENCODER DASH_MUXER MOV_DEMUXER CONCAT_PROTOCOL) += fate-dash-streaming fate-dash-streaming-mpd
+fate-dash-streaming: CMD = framecrc -i "concat:$(TARGET_PATH)/tests/data/dash-streaming-init-0.m4s|$(TARGET_PATH)/tests/data/dash-streaming-0-00002.m4s" -c copy -copyts
+fate-dash-streaming-mpd: CMD = cat $(TARGET_PATH)/tests/data/dash-streaming.mpd
+fate-dash-streaming fate-dash-streaming-mpd: tests/data/dash-streaming.mpd
+
+FATE_FFMPEG += $(FATE_DASH-yes)
+fate-dash: $(FATE_DASH-yes)
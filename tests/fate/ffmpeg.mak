@@ -59,6 +59,13 @@ fate-unknown_layout-ac3: CMD = md5 \
   -guess_layout_max 0 -f s16le -ac 1 -ar 44100 -i $(TARGET_PATH)/$(AREF) \
   -f ac3 -flags +bitexact -c ac3_fixed
 
+# the mov muxer seeks back and reopens the file for faststart, which must see
+# all the data queued for writing
+FATE_FFMPEG-$(call ALLYES, RAWVIDEO_DEMUXER FFV1_ENCODER MOV_MUXER MOV_DEMUXER FRAMECRC_MUXER) += fate-async-write
+fate-async-write: tests/data/vsynth1.yuv
+fate-async-write: CMD = transcode "rawvideo -s 352x288 -pix_fmt yuv420p" tests/data/vsynth1.yuv \
+  mov "-c:v ffv1 -frames:v 20 -async_write_depth 4 -movflags +faststart" "-c copy"
+
 
 FATE_STREAMCOPY-$(call ALLYES, EAC3_DEMUXER MOV_MUXER) += fate-copy-trac3074
 fate-copy-trac3074: $(TARGET_SAMPLES)/eac3/csi_miami_stereo_128_spx.eac3
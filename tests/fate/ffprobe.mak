@@ -25,6 +25,11 @@ FATE_FFPROBE-$(CONFIG_AVDEVICE) += fate-ffprobe_json
 fate-ffprobe_json: $(FFPROBE_TEST_FILE)
 fate-ffprobe_json: CMD = run $(FFPROBE_COMMAND) -of json
 
+FATE_FFPROBE-$(CONFIG_AVDEVICE) += fate-ffprobe_probe_threads
+fate-ffprobe_probe_threads: $(FFPROBE_TEST_FILE)
+fate-ffprobe_probe_threads: CMD = run $(FFPROBE_COMMAND) -of default -probe_threads 4
+fate-ffprobe_probe_threads: REF = $(SRC_PATH)/tests/ref/fate/ffprobe_default
+
 FATE_FFPROBE-$(CONFIG_AVDEVICE) += fate-ffprobe_xml
 fate-ffprobe_xml: $(FFPROBE_TEST_FILE)
 fate-ffprobe_xml: CMD = run $(FFPROBE_COMMAND) -of xml
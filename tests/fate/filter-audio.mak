@@ -142,6 +142,13 @@ fate-filter-compand: tests/data/filtergraphs/compand
 fate-filter-compand: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
 fate-filter-compand: CMD = framecrc -i $(SRC) -frames:a 20 -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/compand
 
+FATE_AFILTER-$(call FILTERDEMDECENCMUX, COMPAND, WAV, PCM_S16LE, PCM_S16LE, WAV) += fate-filter-compand-threads
+fate-filter-compand-threads: tests/data/asynth-44100-2.wav
+fate-filter-compand-threads: tests/data/filtergraphs/compand
+fate-filter-compand-threads: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
+fate-filter-compand-threads: CMD = framecrc -i $(SRC) -frames:a 20 -filter_complex_threads 2 -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/compand
+fate-filter-compand-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-compand
+
 tests/data/hls-list.m3u8: TAG = GEN
 tests/data/hls-list.m3u8: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
 	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< \
@@ -166,6 +173,40 @@ FATE_AFILTER-$(call ALLYES, HLS_DEMUXER MPEGTS_MUXER MPEGTS_DEMUXER AEVALSRC_FIL
 fate-filter-hls-append: tests/data/hls-list-append.m3u8
 fate-filter-hls-append: CMD = framecrc -flags +bitexact -i $(TARGET_PATH)/tests/data/hls-list-append.m3u8 -af asetpts=RTCTIME
 
+tests/data/hls-list-resume.m3u8: TAG = GEN
+tests/data/hls-list-resume.m3u8: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)rm -f $(TARGET_PATH)/$@.idx; \
+        for i in 1 2; do \
+        $(TARGET_EXEC) $(TARGET_PATH)/$< \
+        -f lavfi -i "aevalsrc=cos(2*PI*t)*sin(2*PI*(440+4*t)*t):d=20" -f hls -hls_time 10 -map 0 -flags +bitexact \
+        -hls_flags resume_index -codec:a mp2fixed -hls_segment_filename $(TARGET_PATH)/tests/data/hls-resume-out-%03d.ts \
+        $(TARGET_PATH)/$@ 2>/dev/null || exit 1; \
+        done
+
+FATE_AFILTER-$(call ALLYES, HLS_DEMUXER MPEGTS_MUXER MPEGTS_DEMUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += fate-filter-hls-resume
+fate-filter-hls-resume: tests/data/hls-list-resume.m3u8
+fate-filter-hls-resume: CMD = framecrc -flags +bitexact -i $(TARGET_PATH)/tests/data/hls-list-resume.m3u8 -af asetpts=RTCTIME
+fate-filter-hls-resume: REF = $(SRC_PATH)/tests/ref/fate/filter-hls-append
+
+# the same segments muxed one after the other, then concurrently by several segment muxers
+tests/data/hls-writers-%/list.m3u8: TAG = GEN
+tests/data/hls-writers-%/list.m3u8: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)mkdir -p $(TARGET_PATH)/tests/data/hls-writers-$*; \
+        $(TARGET_EXEC) $(TARGET_PATH)/$< \
+        -f lavfi -i "aevalsrc=cos(2*PI*t)*sin(2*PI*(440+4*t)*t):d=20" -f hls -hls_time 2 -hls_list_size 0 -map 0 -flags +bitexact \
+        -hls_segment_writers $* -codec:a mp2fixed -hls_segment_filename $(TARGET_PATH)/tests/data/hls-writers-$*/out-%03d.ts \
+        $(TARGET_PATH)/$@ 2>/dev/null
+
+FATE_HLS_WRITERS = fate-filter-hls-writers-0 fate-filter-hls-writers-3
+FATE_HLS_WRITERS_LIST = fate-filter-hls-writers-0-list fate-filter-hls-writers-3-list
+FATE_AFILTER-$(call ALLYES, HLS_DEMUXER MPEGTS_MUXER MPEGTS_DEMUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += $(FATE_HLS_WRITERS) $(FATE_HLS_WRITERS_LIST)
+fate-filter-hls-writers-0 fate-filter-hls-writers-0-list: tests/data/hls-writers-0/list.m3u8
+fate-filter-hls-writers-3 fate-filter-hls-writers-3-list: tests/data/hls-writers-3/list.m3u8
+$(FATE_HLS_WRITERS): CMD = framecrc -flags +bitexact -i $(TARGET_PATH)/tests/data/hls-writers-$(@:fate-filter-hls-writers-%=%)/list.m3u8
+$(FATE_HLS_WRITERS): REF = $(SRC_PATH)/tests/ref/fate/filter-hls-writers
+$(FATE_HLS_WRITERS_LIST): CMD = cat $(TARGET_PATH)/tests/data/hls-writers-$(@:fate-filter-hls-writers-%-list=%)/list.m3u8
+$(FATE_HLS_WRITERS_LIST): REF = $(SRC_PATH)/tests/ref/fate/filter-hls-writers-list
+
 FATE_AMIX += fate-filter-amix-simple
 fate-filter-amix-simple: CMD = ffmpeg -filter_complex amix -i $(SRC) -ss 3 -i $(SRC1) -f f32le -
 fate-filter-amix-simple: REF = $(SAMPLES)/filter/amix_simple.pcm
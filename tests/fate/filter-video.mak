@@ -14,6 +14,10 @@ fate-filter-yadif-mode0: CMD = framecrc -flags bitexact -idct simple -i $(TARGET
 FATE_YADIF += fate-filter-yadif-mode1
 fate-filter-yadif-mode1: CMD = framecrc -flags bitexact -idct simple -i $(TARGET_SAMPLES)/mpeg2/mpeg2_field_encoding.ts -frames:v 59 -vf yadif=1
 
+FATE_YADIF += fate-filter-yadif-mode1-batch
+fate-filter-yadif-mode1-batch: CMD = framecrc -flags bitexact -idct simple -i $(TARGET_SAMPLES)/mpeg2/mpeg2_field_encoding.ts -frames:v 59 -vf yadif=1:batch=8
+fate-filter-yadif-mode1-batch: REF = $(SRC_PATH)/tests/ref/fate/filter-yadif-mode1
+
 FATE_YADIF += fate-filter-yadif10
 fate-filter-yadif10: CMD = framecrc -flags bitexact -idct simple -i $(TARGET_SAMPLES)/mpeg2/mpeg2_field_encoding.ts -flags bitexact -pix_fmt yuv420p10le -frames:v 30 -vf yadif=0
 
@@ -113,6 +117,13 @@ FATE_FILTER-$(call ALLYES, FRAMERATE_FILTER TESTSRC2_FILTER) += fate-filter-fram
 fate-filter-framerate-up: CMD = framecrc -lavfi testsrc2=r=2:d=10,framerate=fps=10 -t 1
 fate-filter-framerate-down: CMD = framecrc -lavfi testsrc2=r=2:d=10,framerate=fps=1 -t 1
 
+FATE_FILTER_VSYNTH-$(call ALLYES, SETFIELD_FILTER BWDIF_FILTER) += fate-filter-bwdif-mode1
+fate-filter-bwdif-mode1: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf setfield=tff,bwdif=1
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SETFIELD_FILTER BWDIF_FILTER) += fate-filter-bwdif-mode1-batch
+fate-filter-bwdif-mode1-batch: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf setfield=tff,bwdif=1:batch=8
+fate-filter-bwdif-mode1-batch: REF = $(SRC_PATH)/tests/ref/fate/filter-bwdif-mode1
+
 FATE_FILTER_VSYNTH-$(CONFIG_BOXBLUR_FILTER) += fate-filter-boxblur
 fate-filter-boxblur: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf boxblur=2:1
 
@@ -464,6 +475,18 @@ FATE_FILTER_VSYNTH-$(CONFIG_SCALE_FILTER) += fate-filter-scalechroma
 fate-filter-scalechroma: tests/data/vsynth1.yuv
 fate-filter-scalechroma: CMD = framecrc -flags bitexact -s 352x288 -pix_fmt yuv444p -i tests/data/vsynth1.yuv -pix_fmt yuv420p -sws_flags +bitexact -vf scale=out_v_chr_pos=33:out_h_chr_pos=151
 
+# slice threaded scaling must give the same output as a single thread, also
+# when a YUV to YUV matrix change makes the scaler run in two passes
+FATE_FILTER_VSYNTH-$(CONFIG_SCALE_FILTER) += fate-filter-scale-bicubic fate-filter-scale-bicubic-threads
+fate-filter-scale-bicubic: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_threads 1 -vf scale=w=500:h=400:flags=bicubic,format=yuv444p
+fate-filter-scale-bicubic-threads: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_threads 4 -vf scale=w=500:h=400:flags=bicubic,format=yuv444p
+fate-filter-scale-bicubic-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-scale-bicubic
+
+FATE_FILTER_VSYNTH-$(CONFIG_SCALE_FILTER) += fate-filter-scale-matrix fate-filter-scale-matrix-threads
+fate-filter-scale-matrix: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_threads 1 -vf scale=w=200:h=200:in_color_matrix=bt601:out_color_matrix=bt709
+fate-filter-scale-matrix-threads: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_threads 4 -vf scale=w=200:h=200:in_color_matrix=bt601:out_color_matrix=bt709
+fate-filter-scale-matrix-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-scale-matrix
+
 FATE_FILTER_VSYNTH-$(CONFIG_VFLIP_FILTER) += fate-filter-vflip
 fate-filter-vflip: CMD = video_filter "vflip"
 
@@ -741,6 +764,51 @@ FATE_FILTER_SAMPLES-$(call ALLYES, MOV_DEMUXER H264_DECODER AAC_FIXED_DECODER PC
 fate-filter-meta-4560-rotate0: tests/data/file4560-override2rotate0.mov
 fate-filter-meta-4560-rotate0: CMD = framecrc -flags +bitexact -c:a aac_fixed -i $(TARGET_PATH)/tests/data/file4560-override2rotate0.mov
 
+tests/data/lut3d.cube: TAG = GEN
+tests/data/lut3d.cube: | tests/data
+	$(M)awk 'BEGIN { print "LUT_3D_SIZE 3"; \
+        for (b = 0; b < 3; b++) for (g = 0; g < 3; g++) for (r = 0; r < 3; r++) \
+            printf "%f %f %f\n", (g / 2) ^ 2, b / 2, sqrt(r / 2) }' > $@
+
+tests/data/lut3d-shaper.cube: TAG = GEN
+tests/data/lut3d-shaper.cube: | tests/data
+	$(M)awk 'BEGIN { print "LUT_1D_SIZE 5"; print "LUT_1D_INPUT_RANGE 0.0 1.0"; \
+        print "LUT_3D_SIZE 3"; print "LUT_3D_INPUT_RANGE 0.0 1.0"; \
+        for (i = 0; i < 5; i++) printf "%f %f %f\n", (i / 4) ^ 2, sqrt(i / 4), i / 4; \
+        for (b = 0; b < 3; b++) for (g = 0; g < 3; g++) for (r = 0; r < 3; r++) \
+            printf "%f %f %f\n", (g / 2) ^ 2, b / 2, sqrt(r / 2) }' > $@
+
+# DOMAIN_ keywords are also accepted between the values
+tests/data/lut3d-domain.cube: TAG = GEN
+tests/data/lut3d-domain.cube: | tests/data
+	$(M)awk 'BEGIN { print "LUT_3D_SIZE 3"; \
+        for (b = 0; b < 3; b++) for (g = 0; g < 3; g++) for (r = 0; r < 3; r++) { \
+            printf "%f %f %f\n", (g / 2) ^ 2, b / 2, sqrt(r / 2); \
+            if (!r && !g && !b) print "DOMAIN_MIN 0.0 0.0 0.0"; \
+            if (r == 2 && g == 2 && !b) print "DOMAIN_MAX 1.0 1.0 1.0" } }' > $@
+
+FATE_LUT3D-$(call ALLYES, LAVFI_INDEV TESTSRC2_FILTER FORMAT_FILTER LUT3D_FILTER) += fate-filter-lut3d-gbrp fate-filter-lut3d-gbrap12
+fate-filter-lut3d-gbrp: CMD = framecrc -lavfi testsrc2=r=5:d=1,format=gbrp,lut3d=file=$(TARGET_PATH)/tests/data/lut3d.cube:interp=trilinear
+fate-filter-lut3d-gbrap12: CMD = framecrc -lavfi testsrc2=r=5:d=1,format=gbrap12,lut3d=file=$(TARGET_PATH)/tests/data/lut3d.cube:interp=tetrahedral
+
+FATE_LUT3D_SHAPER-$(call ALLYES, LAVFI_INDEV TESTSRC2_FILTER FORMAT_FILTER LUT3D_FILTER) += fate-filter-lut3d-shaper-rgb24 fate-filter-lut3d-shaper-gbrp10
+fate-filter-lut3d-shaper-rgb24: CMD = framecrc -lavfi testsrc2=r=5:d=1,format=rgb24,lut3d=file=$(TARGET_PATH)/tests/data/lut3d-shaper.cube:interp=tetrahedral
+fate-filter-lut3d-shaper-gbrp10: CMD = framecrc -lavfi testsrc2=r=5:d=1,format=gbrp10,lut3d=file=$(TARGET_PATH)/tests/data/lut3d-shaper.cube:interp=trilinear
+
+FATE_LUT3D_DOMAIN-$(call ALLYES, LAVFI_INDEV TESTSRC2_FILTER FORMAT_FILTER LUT3D_FILTER) += fate-filter-lut3d-domain
+fate-filter-lut3d-domain: CMD = framecrc -lavfi testsrc2=r=5:d=1,format=gbrp,lut3d=file=$(TARGET_PATH)/tests/data/lut3d-domain.cube:interp=trilinear
+fate-filter-lut3d-domain: REF = $(SRC_PATH)/tests/ref/fate/filter-lut3d-gbrp
+
+$(FATE_LUT3D-yes): tests/data/lut3d.cube
+$(FATE_LUT3D_DOMAIN-yes): tests/data/lut3d-domain.cube
+$(FATE_LUT3D_SHAPER-yes): tests/data/lut3d-shaper.cube
+FATE_FILTER-yes += $(FATE_LUT3D-yes) $(FATE_LUT3D_DOMAIN-yes) $(FATE_LUT3D_SHAPER-yes)
+fate-filter-lut3d: $(FATE_LUT3D-yes) $(FATE_LUT3D_DOMAIN-yes) $(FATE_LUT3D_SHAPER-yes)
+
+FATE_FILTER-$(call ALLYES, TESTSRC_FILTER FORMAT_FILTER SPLIT_FILTER NULLSINK_FILTER) += fate-filter-graph-stats
+fate-filter-graph-stats: libavfilter/tests/graphstats$(EXESUF)
+fate-filter-graph-stats: CMD = run libavfilter/tests/graphstats
+
 FATE_SAMPLES_FFPROBE += $(FATE_METADATA_FILTER-yes)
 FATE_SAMPLES_FFMPEG += $(FATE_FILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_FILTER-yes)
@@ -28,5 +28,23 @@ fate-flac-%: FUZZ = 0
 
 FATE_FLAC-$(call ENCMUX, FLAC, FLAC) += $(FATE_FLAC)
 
+# frames encoded in parallel must give the same file as the single threaded
+# encoder, including the MD5 sum and frame sizes of the STREAMINFO block;
+# the short input is less than one batch of frames
+FATE_FLAC_THREADS = fate-flac-encode fate-flac-encode-threads \
+                    fate-flac-encode-short fate-flac-encode-short-threads
+
+fate-flac-encode: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-2.wav -c:a flac -compression_level 2 -threads 1 -f flac -flags +bitexact -fflags +bitexact
+fate-flac-encode-threads: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-2.wav -c:a flac -compression_level 2 -threads 4 -thread_type slice -f flac -flags +bitexact -fflags +bitexact
+fate-flac-encode-threads: REF = $(SRC_PATH)/tests/ref/fate/flac-encode
+fate-flac-encode-short: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-2.wav -t 0.1 -c:a flac -compression_level 2 -threads 1 -f flac -flags +bitexact -fflags +bitexact
+fate-flac-encode-short-threads: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-2.wav -t 0.1 -c:a flac -compression_level 2 -threads 4 -thread_type slice -f flac -flags +bitexact -fflags +bitexact
+fate-flac-encode-short-threads: REF = $(SRC_PATH)/tests/ref/fate/flac-encode-short
+$(FATE_FLAC_THREADS): CMP = diff
+$(FATE_FLAC_THREADS): tests/data/asynth-44100-2.wav
+
+FATE_FLAC_THREADS-$(call ALLYES, WAV_DEMUXER FLAC_ENCODER FLAC_MUXER) += $(FATE_FLAC_THREADS)
+FATE_FFMPEG += $(FATE_FLAC_THREADS-yes)
+
 FATE_SAMPLES_AVCONV += $(FATE_FLAC-yes)
-fate-flac: $(FATE_FLAC)
+fate-flac: $(FATE_FLAC) $(FATE_FLAC_THREADS-yes)
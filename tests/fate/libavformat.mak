@@ -2,6 +2,13 @@
 #fate-async: libavformat/tests/async$(EXESUF)
 #fate-async: CMD = run libavformat/tests/async
 
+# segments served by a local HTTP server, which must all be requested over
+# one persistent connection
+FATE_HLS_PREFETCH-$(call ALLYES, NETWORK HLS_DEMUXER HTTP_PROTOCOL TCP_PROTOCOL NUT_MUXER NUT_DEMUXER) += fate-hls-prefetch
+FATE_LIBAVFORMAT-$(HAVE_THREADS) += $(FATE_HLS_PREFETCH-yes)
+fate-hls-prefetch: libavformat/tests/hls_prefetch$(EXESUF)
+fate-hls-prefetch: CMD = run libavformat/tests/hls_prefetch
+
 FATE_LIBAVFORMAT-$(CONFIG_NETWORK) += fate-noproxy
 fate-noproxy: libavformat/tests/noproxy$(EXESUF)
 fate-noproxy: CMD = run libavformat/tests/noproxy
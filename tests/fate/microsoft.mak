@@ -74,6 +74,15 @@ fate-vc1_ilaced_twomv: CMD = framecrc -flags +bitexact -i $(TARGET_SAMPLES)/vc1/
 FATE_VC1-$(CONFIG_MOV_DEMUXER) += fate-vc1-ism
 fate-vc1-ism: CMD = framecrc -i $(TARGET_SAMPLES)/isom/vc1-wmapro.ism -an
 
+# the same samples with frame threading, against the same references
+FATE_VC1_FRAME_THREADS = sa00040 sa10091 sa20021 ilaced_twomv
+FATE_VC1-$(CONFIG_VC1_DEMUXER) += $(FATE_VC1_FRAME_THREADS:%=fate-vc1_%-frame-threads)
+fate-vc1_sa00040-frame-threads: CMD = framecrc -threads 4 -thread_type frame -i $(TARGET_SAMPLES)/vc1/SA00040.vc1
+fate-vc1_sa10091-frame-threads: CMD = framecrc -threads 4 -thread_type frame -i $(TARGET_SAMPLES)/vc1/SA10091.vc1
+fate-vc1_sa20021-frame-threads: CMD = framecrc -threads 4 -thread_type frame -i $(TARGET_SAMPLES)/vc1/SA20021.vc1
+fate-vc1_ilaced_twomv-frame-threads: CMD = framecrc -flags +bitexact -threads 4 -thread_type frame -i $(TARGET_SAMPLES)/vc1/ilaced_twomv.vc1
+fate-vc1_%-frame-threads: REF = $(SRC_PATH)/tests/ref/fate/vc1_$(@:fate-vc1_%-frame-threads=%)
+
 FATE_MICROSOFT-$(CONFIG_VC1_DECODER) += $(FATE_VC1-yes)
 fate-vc1: $(FATE_VC1-yes)
 
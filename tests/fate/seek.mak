@@ -243,6 +243,17 @@ fate-seek-lavf-yuv4mpeg: SRC = lavf/lavf.y4m
 
 FATE_SEEK += $(FATE_SEEK_LAVF-yes:%=fate-seek-lavf-%)
 
+# packets referencing a file mapping must match the ones read normally
+FATE_SEEK_MMAP-$(call ALLYES, FILE_PROTOCOL MPEG4_ENCODER PCM_ALAW_ENCODER MOV_MUXER MOV_DEMUXER) += mov
+FATE_SEEK_MMAP-$(call ALLYES, FILE_PROTOCOL MPEG2VIDEO_ENCODER PCM_S16LE_ENCODER MXF_MUXER MXF_DEMUXER) += mxf
+FATE_SEEK_MMAP-$(call ALLYES, FILE_PROTOCOL DNXHD_ENCODER MXF_OPATOM_MUXER MXF_DEMUXER) += mxf_opatom
+
+FATE_SEEK_MMAP = $(FATE_SEEK_MMAP-yes:%=fate-seek-mmap-%)
+$(FATE_SEEK_MMAP): libavformat/tests/seek$(EXESUF)
+$(FATE_SEEK_MMAP): fate-seek-mmap-%: fate-lavf-%
+$(FATE_SEEK_MMAP): CMD = run libavformat/tests/seek$(EXESUF) $(TARGET_PATH)/tests/data/lavf/lavf.$(@:fate-seek-mmap-%=%) -mmap 1
+$(FATE_SEEK_MMAP): REF = $(SRC_PATH)/tests/ref/seek/lavf-$(@:fate-seek-mmap-%=%)
+
 # extra files
 
 FATE_SEEK_EXTRA-$(CONFIG_MP3_DEMUXER)   += fate-seek-extra-mp3
@@ -263,6 +274,6 @@ $(FATE_SEEK) $(FATE_SAMPLES_SEEK): CMD = run libavformat/tests/seek$(EXESUF) $(T
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK): fate-seek-%: fate-%
 fate-seek-%: REF = $(SRC_PATH)/tests/ref/seek/$(@:fate-seek-%=%)
 
-FATE_AVCONV += $(FATE_SEEK)
+FATE_AVCONV += $(FATE_SEEK) $(FATE_SEEK_MMAP)
 FATE_SAMPLES_AVCONV += $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
-fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
+fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA) $(FATE_SEEK_MMAP)
@@ -456,3 +456,12 @@ fate-vsynth2: $(FATE_VSYNTH2)
 fate-vsynth_lena: $(FATE_VSYNTH_LENA)
 fate-vsynth3: $(FATE_VSYNTH3)
 fate-vcodec:  fate-vsynth1 fate-vsynth_lena fate-vsynth2 fate-vsynth3
+
+# frame threaded encoding must give the same output as a single thread
+FATE_VCODEC_THREAD-$(call ALLYES, FFV1_ENCODER FRAME_THREAD_ENCODER RAWVIDEO_DEMUXER FRAMEMD5_MUXER) += fate-ffv1-frame-thread-1 fate-ffv1-frame-thread-4
+fate-ffv1-frame-thread-%: tests/data/vsynth1.yuv
+fate-ffv1-frame-thread-%: REF = $(SRC_PATH)/tests/ref/fate/ffv1-frame-thread
+fate-ffv1-frame-thread-%: CMD = framemd5 -f rawvideo -s 352x288 -pix_fmt yuv420p -i $(TARGET_PATH)/tests/data/vsynth1.yuv -c:v ffv1 -level 3 -g 1 -slices 4 -threads $(@:fate-ffv1-frame-thread-%=%)
+
+FATE_AVCONV += $(FATE_VCODEC_THREAD-yes)
+fate-vcodec: $(FATE_VCODEC_THREAD-yes)
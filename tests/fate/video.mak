@@ -365,3 +365,22 @@ FATE_VIDEO += $(FATE_VIDEO-yes)
 
 FATE_SAMPLES_FFMPEG += $(FATE_VIDEO)
 fate-video: $(FATE_VIDEO)
+
+# slice threaded MJPEG encoding puts a restart marker after every row of
+# macroblocks, which lets the decoder split the scans across its threads
+tests/data/mjpeg-rst.avi: TAG = GEN
+tests/data/mjpeg-rst.avi: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
+	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< -nostdin \
+        -f lavfi -i "testsrc=size=176x144:rate=25:duration=1" -flags +bitexact \
+        -threads 4 -thread_type slice -c:v mjpeg -qscale:v 5 -pix_fmt yuvj420p \
+        -y $(TARGET_PATH)/$@ 2>/dev/null
+
+FATE_MJPEG_THREADS = fate-mjpeg-rst fate-mjpeg-rst-slice-threads fate-mjpeg-rst-frame-threads
+fate-mjpeg-rst: CMD = framecrc -idct simple -i $(TARGET_PATH)/tests/data/mjpeg-rst.avi
+fate-mjpeg-rst-slice-threads: CMD = framecrc -idct simple -threads 4 -thread_type slice -i $(TARGET_PATH)/tests/data/mjpeg-rst.avi
+fate-mjpeg-rst-frame-threads: CMD = framecrc -idct simple -threads 4 -thread_type frame -i $(TARGET_PATH)/tests/data/mjpeg-rst.avi
+fate-mjpeg-rst-%-threads: REF = $(SRC_PATH)/tests/ref/fate/mjpeg-rst
+$(FATE_MJPEG_THREADS): tests/data/mjpeg-rst.avi
+
+FATE_FFMPEG-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER MJPEG_ENCODER AVI_MUXER AVI_DEMUXER MJPEG_DECODER) += $(FATE_MJPEG_THREADS)
+fate-mjpeg-threads: $(FATE_MJPEG_THREADS)
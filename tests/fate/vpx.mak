@@ -156,6 +156,11 @@ $(eval $(call FATE_VP9_SUITE,trac4359))
 endef
 
 $(eval $(call FATE_VP9_FULL))
+
+# tile threading, checked against the single threaded output; the pedestrian
+# sample is the one coded with several tile columns
+VP9_SLICE_THREADS = 2 3 4
+$(foreach N,$(VP9_SLICE_THREADS),$(eval $(call FATE_VP9_SUITE,tiling-pedestrian,-slice-threads$(N),-thread_type slice -threads $(N))))
 FATE_VP9-$(CONFIG_IVF_DEMUXER) += fate-vp9-05-resize
 fate-vp9-05-resize: CMD = framemd5 -i $(TARGET_SAMPLES)/vp9-test-vectors/vp90-2-05-resize.ivf -s 352x288 -sws_flags bitexact+bilinear
 fate-vp9-05-resize: REF = $(SRC_PATH)/tests/ref/fate/vp9-05-resize